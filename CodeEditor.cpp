@@ -1,4 +1,6 @@
 #include "CodeEditor.h"
+#include <sstream>
+#include "diagnostics.h"
 
 Wt::WBrush BackgroundNormal(Wt::WColor(255, 255, 255, 0));
 Wt::WPen BackgroundBorderNormal(Wt::WColor(255, 255, 255, 0));
@@ -477,8 +479,13 @@ bool Scroll::handleMouseDrag(CodeEditor& parent, const Wt::WMouseEvent& e) {
 
             scroll_ = (chars < 0 and last_down_scroll < -chars) ? 0 : last_down_scroll + chars;
 
-            std::cout << "factor=" << factor << ", mouse_x=" << e.widget().x << ", thumb_last_left_down.col=" << thumb_last_left_down.col << std::endl;
-            std::cout << "x_delta=" << x_delta << ", chars=" << chars << ", scroll_=" << scroll_ << std::endl;
+            if (Diagnostics::isEnabled(EDiagnosticLevel::LEVEL_TRACE)) {
+                std::ostringstream s;
+
+                s << "factor=" << factor << ", mouse_x=" << e.widget().x << ", thumb_last_left_down.col=" << thumb_last_left_down.col << "\n";
+                s << "x_delta=" << x_delta << ", chars=" << chars << ", scroll_=" << scroll_;
+                Diagnostics::write(EDiagnosticLevel::LEVEL_TRACE, s.str());
+            }
         }
         else { // VERTICAL
             int y_delta = e.widget().y - thumb_last_left_down.row;
@@ -487,8 +494,13 @@ bool Scroll::handleMouseDrag(CodeEditor& parent, const Wt::WMouseEvent& e) {
 
             scroll_ = (chars < 0 and last_down_scroll < -chars) ? 0 : last_down_scroll + chars;
 
-            std::cout << "factor=" << factor << ", mouse_x=" << e.widget().x << ", thumb_last_left_down.col=" << thumb_last_left_down.col << std::endl;
-            std::cout << "x_delta=" << y_delta << ", chars=" << chars << ", scroll_=" << scroll_ << std::endl;
+            if (Diagnostics::isEnabled(EDiagnosticLevel::LEVEL_TRACE)) {
+                std::ostringstream s;
+
+                s << "factor=" << factor << ", mouse_y=" << e.widget().y << ", thumb_last_left_down.row=" << thumb_last_left_down.row << "\n";
+                s << "y_delta=" << y_delta << ", chars=" << chars << ", scroll_=" << scroll_;
+                Diagnostics::write(EDiagnosticLevel::LEVEL_TRACE, s.str());
+            }
         }
 
         scrollArea->update();
@@ -522,7 +534,7 @@ TextArea::TextArea() {
 }
 
 void TextArea::draw(Wt::WPainter& painter,
-    const TTextEditor& txt_editor,
+    const TextBuffer& txt_editor,
     std::size_t current_row,
     std::size_t current_col,
     Scroll& v_scroll,
@@ -545,17 +557,14 @@ void TextArea::draw(Wt::WPainter& painter,
 
     font_size = painter.font().sizeLength().value();
     std::size_t row_ = 0;
+    std::vector<TextRun> runs;
 
-    for (row_ = 0 + v_scroll.scroll_; row_ < txt_editor.size(); row_++) {
+    for (row_ = 0 + v_scroll.scroll_; row_ < txt_editor.rowCount(); row_++) {
         std::size_t row_vscroll = row_ - v_scroll.scroll_;
         if (get_y1() + (row_vscroll + 1.) * font_size + padding_ > get_y2() - padding_) {
             break;
         }
 
-        std::string s{ "" };
-        std::string complete_s{ "" };
-        Character prev_char;
-        int prev_char_idx = -1;
         double text_offset = 0.;
 
         // Draw the current line selector
@@ -565,72 +574,32 @@ void TextArea::draw(Wt::WPainter& painter,
             painter.drawRect(get_x1(), get_y1() + row_vscroll * font_size + padding_, width(), font_size);
         }
 
-        for (std::size_t i = h_scroll.scroll_; i < txt_editor[row_].size(); i++) {
-            const Character& current_char = txt_editor[row_][i];
+        // The characters of the same style are drawn at once
+        txt_editor.getRowRuns(row_, h_scroll.scroll_, runs);
 
-            if (prev_char_idx == -1) {
-                prev_char = current_char;
-                s += current_char.UTF8;
-                prev_char_idx = i;
-            }
-            else {
-                if (prev_char.isSameStyle(current_char)) {
-                    s += current_char.UTF8;
-                }
-                else {
-                    complete_s += s;
-                    double text_len = painter.device()->measureText(s).width() / 1.02;
-
-                    // Draw background
-                    painter.setBrush(prev_char.getBackground());
-                    painter.setPen(prev_char.getBackgroundBorder());
-                    painter.drawRect(get_x1() + padding_ + text_offset, get_y1() + row_vscroll * font_size + padding_,
-                        text_len, font_size);
-
-                    // Draw text
-                    painter.setPen(prev_char.getForeground());
-                    painter.drawText(get_x1() + padding_ + text_offset, get_y1() + row_vscroll * font_size + padding_,
-                        width() - 2 * padding_ - text_offset, font_size,
-                        Wt::AlignmentFlag::Left | Wt::AlignmentFlag::Top, s);
-
-                    text_offset += text_len;
-                    s = current_char.UTF8;
-                    prev_char_idx = i;
-                    prev_char = current_char;
-                }
-            }
-
-        }
+        for (const TextRun& run : runs) {
+            Character style("", run.foreground, run.background);
+            double text_len = painter.device()->measureText(run.utf8).width() / 1.02;
 
-        // Draw background
-        double text_len = painter.device()->measureText(s).width() / 1.02;
-        painter.setBrush(prev_char.getBackground());
-        painter.setPen(prev_char.getBackgroundBorder());
+            // Draw background
+            painter.setBrush(style.getBackground());
+            painter.setPen(style.getBackgroundBorder());
+            painter.drawRect(get_x1() + padding_ + text_offset, get_y1() + row_vscroll * font_size + padding_,
+                text_len, font_size);
 
-        painter.drawRect(get_x1() + padding_ + text_offset, get_y1() + row_vscroll * font_size + padding_,
-            text_len, font_size);
+            // Draw text
+            painter.setPen(style.getForeground());
+            painter.drawText(get_x1() + padding_ + text_offset, get_y1() + row_vscroll * font_size + padding_,
+                width() - 2 * padding_ - text_offset, font_size,
+                Wt::AlignmentFlag::Left | Wt::AlignmentFlag::Top, run.utf8);
 
-        // Draw text
-        painter.setPen(prev_char.getForeground());
-        complete_s += s;
-        painter.drawText(get_x1() + padding_ + text_offset, get_y1() + row_vscroll * font_size + padding_,
-            width() - 2 * padding_ - text_offset, font_size,
-            Wt::AlignmentFlag::Left | Wt::AlignmentFlag::Top, s);
+            text_offset += text_len;
+        }
 
         // Draw Cursor
         if (row_ == current_row) {
-            std::string left_s{ "" };
-            int str_len = txt_editor[row_].size();
-
-            if (str_len == current_col)
-                left_s = complete_s;
-            else {
-                for (std::size_t c_pos_ = h_scroll.scroll_; c_pos_ < current_col; c_pos_++) {
-                    left_s += txt_editor[row_][c_pos_].UTF8;
-                }
-            }
-
             if (current_col >= h_scroll.scroll_) { // If cusror is not beyond the left border
+                std::string left_s = txt_editor.getText(row_, h_scroll.scroll_, row_, current_col);
                 double x = painter.device()->measureText(left_s).width() / 1.02;
                 painter.setPen(cursor_pen);
                 painter.drawLine(get_x1() + x + padding_, get_y1() + row_vscroll * font_size + padding_,
@@ -701,7 +670,9 @@ bool TextArea::handleClick(CodeEditor& parent, const Wt::WMouseEvent& e)
         CursorPos pos = mouseToRowCol(parent, e.widget().x, e.widget().y);
         CursorPos txt_pos = parent.mouseTextPosToTextPos(pos);
 
-        std::cout << "r=" << pos.row << ", c=" << pos.col << std::endl;
+        if (Diagnostics::isEnabled(EDiagnosticLevel::LEVEL_TRACE)) {
+            Diagnostics::write(EDiagnosticLevel::LEVEL_TRACE, "r=" + std::to_string(pos.row) + ", c=" + std::to_string(pos.col));
+        }
 
         parent.setCurrentPos(txt_pos.row, txt_pos.col);
         parent.update();
@@ -715,10 +686,11 @@ bool TextArea::handleClick(CodeEditor& parent, const Wt::WMouseEvent& e)
 bool TextArea::isMouseOverSelected(CodeEditor& parent, int mouse_x, int mouse_y) {
     CursorPos pos = mouseToRowCol(parent, mouse_x, mouse_y);
 
-    if ((pos.row < parent.getTxt_editor().size())
-        and pos.col < parent.getTxt_editor()[pos.row].size()
+    if ((pos.row < parent.getTxt_editor().rowCount())
+        and pos.col < parent.getTxt_editor().rowLength(pos.row)
         ) {
-        return parent.getTxt_editor()[pos.row][pos.col].testBackgroundFlag(EBackgroundStyle::SELECTED);
+        Character style("", EForegroundStyle::NORMAL, parent.getTxt_editor().backgroundAt(pos.row, pos.col));
+        return style.testBackgroundFlag(EBackgroundStyle::SELECTED);
     }
     else {
         return false;
@@ -907,7 +879,11 @@ CodeEditor::CodeEditor()
     this->mouseWentDown().connect(this, &CodeEditor::handleMouseDown);
     this->mouseWentUp().connect(this, &CodeEditor::handleMouseUp);
 
-    this->focussed().connect(this, []() {std::cout << "Got focus" << std::endl; });
+    this->focussed().connect(this, []() {
+        if (Diagnostics::isEnabled(EDiagnosticLevel::LEVEL_TRACE)) {
+            Diagnostics::write(EDiagnosticLevel::LEVEL_TRACE, "Got focus");
+        }
+    });
 
     //this->keyEventSignal();
 
@@ -933,7 +909,7 @@ CodeEditor::CodeEditor()
     update_from_clipboard_.connect(this, &CodeEditor::setTextFromClipboard);
 }
 
-const TTextEditor& CodeEditor::getTxt_editor() const {
+const TextBuffer& CodeEditor::getTxt_editor() const {
     return txt_editor;
 }
 
@@ -945,7 +921,12 @@ void CodeEditor::layoutSizeChanged(int width, int height) {
     height_ = height;
 
     setLayout();
-    std::cout << "layoutSizeChanged((" << width << "," << height << ")" << ":" << this->width().value() << "," << this->height().value() << std::endl;
+    if (Diagnostics::isEnabled(EDiagnosticLevel::LEVEL_TRACE)) {
+        std::ostringstream s;
+
+        s << "layoutSizeChanged((" << width << "," << height << ")" << ":" << this->width().value() << "," << this->height().value();
+        Diagnostics::write(EDiagnosticLevel::LEVEL_TRACE, s.str());
+    }
 }
 
 Scroll& CodeEditor::getHorizScroll() {
@@ -963,8 +944,8 @@ CursorPos& CodeEditor::getCurrentPos() {
 CursorPos CodeEditor::mouseTextPosToTextPos(const CursorPos& pos) {
     CursorPos ret;
 
-    ret.row = std::min(pos.row, txt_editor.size() - 1);
-    ret.col = std::min(pos.col, txt_editor[ret.row].size());
+    ret.row = std::min(pos.row, txt_editor.rowCount() - 1);
+    ret.col = std::min(pos.col, txt_editor.rowLength(ret.row));
 
     return ret;
 }
@@ -982,49 +963,30 @@ Wt::JSignal<std::string>& CodeEditor::update_from_clipboard() {
     return update_from_clipboard_;
 }
 
-void CodeEditor::setTextFromClipboard(const Wt::WString& text) {
-    std::string str_utf8 = text.toUTF8();
-    const char* utf8_buf = str_utf8.c_str();
-    std::size_t len = 0;
+// Drops the '\r' and replaces the tabs by two spaces
+static std::string normalizeText(const std::string& text) {
+    std::string s;
 
-    while (*utf8_buf) {
-        if (((*utf8_buf) & 0b10000000) != 0b10000000) { // One byte
-            len = 1;
-        }
-        else if (((*utf8_buf) & 0b11000000) == 0b11000000) { // 2 bytes
-            len = 2;
-        }
-        else if (((*utf8_buf) & 0b11100000) == 0b11100000) { // 3 bytes
-            len = 3;
+    s.reserve(text.size());
+
+    for (char c : text) {
+        if (c == '\r') {
+            // Ignore it
         }
-        else if (((*utf8_buf) & 0b11110000) == 0b11110000) { // 4 bytes
-            len = 4;
+        else if (c == '\t') {
+            s += "  ";
         }
         else {
-            len = 0;
-            std::cout << "Error: UFT-8 code point longer than 4 bytes." << std::endl;
+            s += c;
         }
+    }
 
-        if (len > 0) {
-            if (*utf8_buf == '\r') {
-                // Ignore it
-            }
-            else if (*utf8_buf == '\n') {
-                insertNewLine();
-            }
-            else if (*utf8_buf == '\t') {
-                insertNewChar(" ");
-                insertNewChar(" ");
-            }
-            else {
-                insertNewChar(std::string(utf8_buf, len));
-            }
-
-            utf8_buf += len;
-        }
-    } // ~while
+    return s;
+}
 
-//    horiz_scroll.maximize_range(txt_editor[current_pos.row].size());
+void CodeEditor::setTextFromClipboard(const Wt::WString& text) {
+    // The whole text is inserted at once, the text buffer doesn't grow with its size
+    insertText(normalizeText(text.toUTF8()));
 
     maximize_range(horiz_scroll);
     maximize_range(vert_scroll);
@@ -1039,7 +1001,7 @@ void CodeEditor::paintEvent(Wt::WPaintDevice* paintDevice) {
     bool repaint;
 
     do {
-        row_numbers.draw(painter, txt_editor.size(), vert_scroll.scroll_, current_pos.row);
+        row_numbers.draw(painter, txt_editor.rowCount(), vert_scroll.scroll_, current_pos.row);
         text_area.draw(painter, txt_editor, current_pos.row, current_pos.col, vert_scroll, horiz_scroll, reallocate_cursor, repaint);
         horiz_scroll.draw(painter);
         vert_scroll.draw(painter);
@@ -1081,7 +1043,10 @@ std::string CodeEditor::compose_status_string() {
 }
 
 void CodeEditor::handleClick(const Wt::WMouseEvent& e) {
-    std::cout << "Clicked: x=" << e.widget().x << ", y=" << e.widget().y << std::endl;
+    if (Diagnostics::isEnabled(EDiagnosticLevel::LEVEL_TRACE)) {
+        Diagnostics::write(EDiagnosticLevel::LEVEL_TRACE, "Clicked: x=" + std::to_string(e.widget().x) + ", y=" + std::to_string(e.widget().y));
+    }
+
     row_numbers.handleClick(*this, e)
         or text_area.handleClick(*this, e)
         or horiz_scroll.handleClick(e)
@@ -1120,7 +1085,12 @@ void CodeEditor::handleMouseUp(const Wt::WMouseEvent& e) {
 }
 
 void CodeEditor::handleMouseDrag(const Wt::WMouseEvent& e) {
-    std::cout << "Mouse drag: x=" << e.widget().x << ", y=" << e.widget().y << ", delta x=" << e.dragDelta().x << ", y=" << e.dragDelta().y << std::endl;
+    if (Diagnostics::isEnabled(EDiagnosticLevel::LEVEL_TRACE)) {
+        std::ostringstream s;
+
+        s << "Mouse drag: x=" << e.widget().x << ", y=" << e.widget().y << ", delta x=" << e.dragDelta().x << ", y=" << e.dragDelta().y;
+        Diagnostics::write(EDiagnosticLevel::LEVEL_TRACE, s.str());
+    }
 
     if (isDragMode and dragComponent) {
         dragComponent->handleMouseDrag(*this, e);
@@ -1128,15 +1098,30 @@ void CodeEditor::handleMouseDrag(const Wt::WMouseEvent& e) {
 }
 
 void CodeEditor::handleMouseWheel(const Wt::WMouseEvent& e) {
-    std::cout << "Mouse wheel: x=" << e.widget().x << ", y=" << e.widget().y << ", wheelDelta=" << e.wheelDelta() << std::endl;
+    if (Diagnostics::isEnabled(EDiagnosticLevel::LEVEL_TRACE)) {
+        std::ostringstream s;
+
+        s << "Mouse wheel: x=" << e.widget().x << ", y=" << e.widget().y << ", wheelDelta=" << e.wheelDelta();
+        Diagnostics::write(EDiagnosticLevel::LEVEL_TRACE, s.str());
+    }
 
     text_area.handleMouseWheel(*this, e)
         or horiz_scroll.handleMouseWheel(e)
         or vert_scroll.handleMouseWheel(e);
 }
 
+// Key events are traced by every handler, the message is built only if the session traces
+void CodeEditor::traceKey(const char* event, const Wt::WKeyEvent& e) {
+    if (Diagnostics::isEnabled(EDiagnosticLevel::LEVEL_TRACE)) {
+        std::ostringstream s;
+
+        s << event << ":" << e.key() << ":" << modifiersToString(e.modifiers()) << ":" << e.charCode() << ":" << e.text();
+        Diagnostics::write(EDiagnosticLevel::LEVEL_TRACE, s.str());
+    }
+}
+
 void CodeEditor::handleKeyPressed(const Wt::WKeyEvent& e) {
-    std::cout << "Pressed:" << e.key() << ":" << modifiersToString(e.modifiers()) << ":" << e.charCode() << ":" << e.text() << std::endl;
+    traceKey("Pressed", e);
 
     if (selection.is_selected) {
         deleteSelected();
@@ -1157,21 +1142,65 @@ void CodeEditor::handleKeyPressed(const Wt::WKeyEvent& e) {
     update();
 }
 
+// Rows 'first_row'..'old_last_row' have been replaced by rows 'first_row'..'new_last_row'
+void CodeEditor::markChanged(std::size_t first_row, std::size_t old_last_row, std::size_t new_last_row) {
+    int delta = (int)new_last_row - (int)old_last_row;
+
+    if (!has_changes) {
+        has_changes = true;
+        changed_first_row = first_row;
+        changed_last_row = new_last_row;
+        changed_row_delta = delta;
+        return;
+    }
+
+    // Move the end of the range changed so far to the current rows
+    if (changed_last_row > old_last_row) {
+        changed_last_row += delta;
+    }
+    else if (changed_last_row >= first_row) {
+        changed_last_row = new_last_row;
+    }
+
+    changed_first_row = std::min(changed_first_row, first_row);
+    changed_last_row = std::max(changed_last_row, new_last_row);
+    changed_row_delta += delta;
+}
+
+bool CodeEditor::getChangedRows(std::size_t& first_row, std::size_t& last_row, int& row_delta) const {
+    first_row = changed_first_row;
+    last_row = changed_last_row;
+    row_delta = changed_row_delta;
+
+    return has_changes;
+}
+
+void CodeEditor::clearChangedRows() {
+    has_changes = false;
+    changed_first_row = 0;
+    changed_last_row = 0;
+    changed_row_delta = 0;
+}
+
 void CodeEditor::insertNewLine() {
-    TTextLine new_line(txt_editor[current_pos.row].begin() + current_pos.col, txt_editor[current_pos.row].end());
-    txt_editor.insert(txt_editor.begin() + current_pos.row + 1, new_line);
-    txt_editor[current_pos.row].erase(txt_editor[current_pos.row].begin() + current_pos.col, txt_editor[current_pos.row].end());
-    current_pos.row++;
-    current_pos.col = 0;
+    insertText("\n");
 }
 
 void CodeEditor::insertNewChar(const std::string& s) {
-    txt_editor[current_pos.row].insert(txt_editor[current_pos.row].begin() + current_pos.col, Character(s, EForegroundStyle::NORMAL, EBackgroundStyle::NORMAL));
-    current_pos.col++;
+    insertText(s);
+}
+
+// Inserts the text at the cursor and moves the cursor after it
+void CodeEditor::insertText(const std::string& s) {
+    std::size_t end_row, end_col;
+
+    txt_editor.insert(current_pos.row, current_pos.col, s, end_row, end_col);
+    markChanged(current_pos.row, current_pos.row, end_row);
+    setCurrentPos(end_row, end_col);
 }
 
 void CodeEditor::handleKeyDown(const Wt::WKeyEvent& e) {
-    std::cout << "Down:" << e.key() << ":" << modifiersToString(e.modifiers()) << ":" << e.charCode() << ":" << e.text() << std::endl;
+    traceKey("Down", e);
 
     switch (e.key()) {
     case Wt::Key::Left: {
@@ -1192,7 +1221,7 @@ void CodeEditor::handleKeyDown(const Wt::WKeyEvent& e) {
     case Wt::Key::Right: {
         CursorPos old_pos = current_pos;
 
-        current_pos.col = current_pos.col == txt_editor[current_pos.row].size() ? current_pos.col : current_pos.col + 1;
+        current_pos.col = current_pos.col == txt_editor.rowLength(current_pos.row) ? current_pos.col : current_pos.col + 1;
 
         if (e.modifiers().test(Wt::KeyboardModifier::Shift)) {
             updateSelection(old_pos, current_pos);
@@ -1228,11 +1257,11 @@ void CodeEditor::handleKeyDown(const Wt::WKeyEvent& e) {
         CursorPos old_pos = current_pos;
 
         if (e.modifiers().test(Wt::KeyboardModifier::Control)) {
-            current_pos.row = txt_editor.size() - 1;
-            current_pos.col = txt_editor[current_pos.row].size();
+            current_pos.row = txt_editor.rowCount() - 1;
+            current_pos.col = txt_editor.rowLength(current_pos.row);
         }
         else {
-            current_pos.col = txt_editor[current_pos.row].size();
+            current_pos.col = txt_editor.rowLength(current_pos.row);
         }
 
         if (e.modifiers().test(Wt::KeyboardModifier::Shift)) {
@@ -1249,7 +1278,7 @@ void CodeEditor::handleKeyDown(const Wt::WKeyEvent& e) {
         CursorPos old_pos = current_pos;
 
         current_pos.row = current_pos.row == 0 ? 0 : current_pos.row - 1;
-        current_pos.col = current_pos.col > txt_editor[current_pos.row].size() ? txt_editor[current_pos.row].size() : current_pos.col;
+        current_pos.col = std::min(current_pos.col, txt_editor.rowLength(current_pos.row));
 
         if (e.modifiers().test(Wt::KeyboardModifier::Shift)) {
             updateSelection(old_pos, current_pos);
@@ -1264,8 +1293,8 @@ void CodeEditor::handleKeyDown(const Wt::WKeyEvent& e) {
     case Wt::Key::Down: {
         CursorPos old_pos = current_pos;
 
-        current_pos.row = current_pos.row == txt_editor.size() - 1 ? current_pos.row : current_pos.row + 1;
-        current_pos.col = current_pos.col > txt_editor[current_pos.row].size() ? txt_editor[current_pos.row].size() : current_pos.col;
+        current_pos.row = current_pos.row == txt_editor.rowCount() - 1 ? current_pos.row : current_pos.row + 1;
+        current_pos.col = std::min(current_pos.col, txt_editor.rowLength(current_pos.row));
 
         if (e.modifiers().test(Wt::KeyboardModifier::Shift)) {
             updateSelection(old_pos, current_pos);
@@ -1282,15 +1311,18 @@ void CodeEditor::handleKeyDown(const Wt::WKeyEvent& e) {
             deleteSelected();
         }
         else {
-            if (current_pos.col < txt_editor[current_pos.row].size()) {
+            std::size_t row_length = txt_editor.rowLength(current_pos.row);
+
+            if (current_pos.col < row_length) {
                 // Delete the character inside the line
-                txt_editor[current_pos.row].erase(txt_editor[current_pos.row].begin() + current_pos.col);
+                markChanged(current_pos.row, current_pos.row, current_pos.row);
+                txt_editor.erase(current_pos.row, current_pos.col, current_pos.row, current_pos.col + 1);
 //                maximize_range(horiz_scroll);
             }
-            else if (current_pos.col == txt_editor[current_pos.row].size() and current_pos.row < txt_editor.size() - 1) {
+            else if (current_pos.col == row_length and current_pos.row < txt_editor.rowCount() - 1) {
                 // If the cursor is at the end of the line and there is one more following line, then merge the lines
-                txt_editor[current_pos.row].insert(txt_editor[current_pos.row].end(), txt_editor[current_pos.row + 1].begin(), txt_editor[current_pos.row + 1].end());
-                txt_editor.erase(txt_editor.begin() + current_pos.row + 1);
+                markChanged(current_pos.row, current_pos.row + 1, current_pos.row);
+                txt_editor.erase(current_pos.row, current_pos.col, current_pos.row + 1, 0);
 //                maximize_range(horiz_scroll);
 //                vert_scroll.range_--;
             }
@@ -1309,9 +1341,9 @@ void CodeEditor::handleKeyDown(const Wt::WKeyEvent& e) {
         else {
             if (current_pos.col == 0 and current_pos.row > 0) {
                 // Merge the line with its preceding line
-                std::size_t new_current_col = txt_editor[current_pos.row - 1].size();
-                txt_editor[current_pos.row - 1].insert(txt_editor[current_pos.row - 1].end(), txt_editor[current_pos.row].begin(), txt_editor[current_pos.row].end());
-                txt_editor.erase(txt_editor.begin() + current_pos.row);
+                markChanged(current_pos.row - 1, current_pos.row, current_pos.row - 1);
+                std::size_t new_current_col = txt_editor.rowLength(current_pos.row - 1);
+                txt_editor.erase(current_pos.row - 1, new_current_col, current_pos.row, 0);
                 current_pos.col = new_current_col;
                 current_pos.row--;
 //                maximize_range(horiz_scroll);
@@ -1319,7 +1351,8 @@ void CodeEditor::handleKeyDown(const Wt::WKeyEvent& e) {
             }
             else if (current_pos.col > 0) {
                 // Delete the character inside the line
-                txt_editor[current_pos.row].erase(txt_editor[current_pos.row].begin() + current_pos.col - 1);
+                markChanged(current_pos.row, current_pos.row, current_pos.row);
+                txt_editor.erase(current_pos.row, current_pos.col - 1, current_pos.row, current_pos.col);
                 current_pos.col--;
 //                maximize_range(horiz_scroll);
             }
@@ -1352,9 +1385,9 @@ void CodeEditor::handleKeyDown(const Wt::WKeyEvent& e) {
     case Wt::Key::PageDown: {
         CursorPos old_pos = current_pos;
 
-        current_pos.row = current_pos.row + text_area.visibleRows() > txt_editor.size() - 1
-            ? txt_editor.size() - 1 : current_pos.row + text_area.visibleRows();
-        current_pos.col = current_pos.col > txt_editor[current_pos.row].size() ? txt_editor[current_pos.row].size() : current_pos.col;
+        current_pos.row = current_pos.row + text_area.visibleRows() > txt_editor.rowCount() - 1
+            ? txt_editor.rowCount() - 1 : current_pos.row + text_area.visibleRows();
+        current_pos.col = std::min(current_pos.col, txt_editor.rowLength(current_pos.row));
 
         if (e.modifiers().test(Wt::KeyboardModifier::Shift)) {
             updateSelection(old_pos, current_pos);
@@ -1371,7 +1404,7 @@ void CodeEditor::handleKeyDown(const Wt::WKeyEvent& e) {
 
         current_pos.row = current_pos.row < text_area.visibleRows()
             ? 0 : current_pos.row - text_area.visibleRows();
-        current_pos.col = current_pos.col > txt_editor[current_pos.row].size() ? txt_editor[current_pos.row].size() : current_pos.col;
+        current_pos.col = std::min(current_pos.col, txt_editor.rowLength(current_pos.row));
 
         if (e.modifiers().test(Wt::KeyboardModifier::Shift)) {
             updateSelection(old_pos, current_pos);
@@ -1393,58 +1426,44 @@ void CodeEditor::handleKeyDown(const Wt::WKeyEvent& e) {
 }
 
 void CodeEditor::handleKeyUp(const Wt::WKeyEvent& e) {
-    std::cout << "Up:" << e.key() << ":" << modifiersToString(e.modifiers()) << ":" << e.charCode() << ":" << e.text() << std::endl;
+    traceKey("Up", e);
 }
 
 void CodeEditor::maximize_range(Scroll& scroll) {
     scroll.range_ = 0;
 
     if (scroll.direction == ScrollDirection::HORIZONTAL) {
-        for (const TTextLine& el : txt_editor) {
-            scroll.maximize_range(el.size());
-        }
+        scroll.maximize_range(txt_editor.maxRowLength());
     }
     else { // VERTICAL
-        scroll.maximize_range(txt_editor.size());
+        scroll.maximize_range(txt_editor.rowCount());
     }
 }
 
 std::string CodeEditor::getTextInRange(std::size_t row_start, std::size_t col_start, std::size_t row_end, std::size_t col_end) {
-    Wt::WStringStream text;
-
-    if (row_start == row_end) { // One row selected
-        for (std::size_t col = col_start; col < col_end; col++) {
-            text << txt_editor[row_start][col].UTF8;
-        }
-    }
-    else { // More than one row selected
-        for (std::size_t r = row_start; r <= row_end; r++) {
-            if (r == row_start) { // We are in the first row
-                for (std::size_t col = col_start; col < txt_editor[r].size(); col++) {
-                    text << txt_editor[r][col].UTF8;
-                }
-            }
-            else if (r == row_end) { // We are in the last row
-                text << '\n';
-                for (std::size_t col = 0; col < col_end; col++) {
-                    text << txt_editor[r][col].UTF8;
-                }
-            }
-            else { // We are between start and end rows
-                text << '\n';
-                for (std::size_t col = 0; col < txt_editor[r].size(); col++) {
-                    text << txt_editor[r][col].UTF8;
-                }
-            }
-        }
-    }
-
-    return text.str();
+    return txt_editor.getText(row_start, col_start, row_end, col_end);
 }
 
 std::string CodeEditor::text() {
-    return getTextInRange(0, 0,
-        txt_editor.size()-1, txt_editor[txt_editor.size()-1].size());
+    return txt_editor.text();
+}
+
+void CodeEditor::setText(const std::string& text) {
+    std::size_t old_last_row = txt_editor.rowCount() - 1;
+
+    resetSelection();
+    txt_editor = TextBuffer(normalizeText(text));
+    markChanged(0, old_last_row, txt_editor.rowCount() - 1);
+    setCurrentPos(0, 0);
+
+    horiz_scroll.scroll_ = 0;
+    vert_scroll.scroll_ = 0;
+    maximize_range(horiz_scroll);
+    maximize_range(vert_scroll);
+
+    reallocate_cursor = true;
+
+    update();
 }
 
 std::string CodeEditor::selectedText() {
@@ -1483,20 +1502,8 @@ EBackgroundStyle CodeEditor::removeFlag(EBackgroundStyle base, EBackgroundStyle
 
 void CodeEditor::setSelection(EBackgroundStyle style, EBackgroundStyle oper(EBackgroundStyle, EBackgroundStyle)) {
     if (selection.is_selected) {
-        CursorPos cur_pos = selection.selection_start;
-        while (cur_pos != selection.selection_end) {
-            if (cur_pos.row < txt_editor.size() and cur_pos.col < txt_editor[cur_pos.row].size()) {
-                txt_editor[cur_pos.row][cur_pos.col].backgroundStyle = oper(txt_editor[cur_pos.row][cur_pos.col].backgroundStyle, style);
-            }
-
-            if (cur_pos.col == txt_editor[cur_pos.row].size()) {
-                cur_pos.row++;
-                cur_pos.col = 0;
-            }
-            else {
-                cur_pos.col++;
-            }
-        }
+        txt_editor.applyBackground(selection.selection_start.row, selection.selection_start.col,
+            selection.selection_end.row, selection.selection_end.col, style, oper);
     }
 }
 
@@ -1515,36 +1522,9 @@ void CodeEditor::deleteSelected() {
     CursorPos sel_start = selection.selection_start;
     CursorPos sel_end = selection.selection_end;
     resetSelection();
+    markChanged(sel_start.row, sel_end.row, sel_start.row);
 
-    if (sel_start.row == sel_end.row) { // One row selected
-        txt_editor[sel_start.row].erase(txt_editor[sel_start.row].begin() + sel_start.col, txt_editor[sel_start.row].begin() + sel_end.col);
-    }
-    else { // More than one row selected
-        std::size_t r = sel_end.row;
-        bool done = false;
-        do {
-            if (r == sel_start.row) { // We are in the first row
-                txt_editor[r].erase(txt_editor[r].begin() + sel_start.col, txt_editor[r].end());
-            }
-            else if (r == sel_end.row) { // We are in the last row
-                txt_editor[r].erase(txt_editor[r].begin(), txt_editor[r].begin() + sel_end.col);
-            }
-            else { // We are between start and end rows
-                txt_editor.erase(txt_editor.begin() + r); // Erase the entire line
-            }
-
-            if (r == sel_start.row) { // We're done
-                // Merge the first and the last line
-                txt_editor[r].insert(txt_editor[r].end(), txt_editor[r + 1].begin(), txt_editor[r + 1].end());
-                txt_editor.erase(txt_editor.begin() + r + 1);
-
-                done = true;
-            }
-            else {
-                r--;
-            }
-        } while (!done);
-    }
+    txt_editor.erase(sel_start.row, sel_start.col, sel_end.row, sel_end.col);
 
     // Adjust cursor position if needed
     if (current_pos > sel_start) {
@@ -8,16 +8,7 @@
 #include <Wt/WApplication.h>
 #include <Wt/WEnvironment.h>
 #include <algorithm>
-
-enum class EBackgroundStyle : int {
-    NORMAL   = 1 << 0, 
-    KEYWORD  = 1 << 1,
-    SELECTED = 1 << 2
-};
-enum class EForegroundStyle : int {
-    NORMAL  = 1 << 0,
-    KEYWORD = 1 << 1
-};
+#include "textbuffer.h"
 
 extern Wt::WPen ForegroundNormal;
 extern Wt::WBrush BackgroundNormal;
@@ -61,9 +52,6 @@ public:
     EBackgroundStyle backgroundStyle;
 };
 
-typedef std::vector<Character> TTextLine;
-typedef std::vector<TTextLine> TTextEditor;
-
 class Rect {
 public:
     Rect();
@@ -181,7 +169,7 @@ public:
     TextArea();
 
     void draw(Wt::WPainter& painter,
-        const TTextEditor& txt_editor,
+        const TextBuffer& txt_editor,
         std::size_t current_row,
         std::size_t current_col,
         Scroll& v_scroll,
@@ -245,7 +233,7 @@ public:
     CursorPos& getCurrentPos();
     void setCurrentPos(std::size_t row, std::size_t col);
     void setCurrentPos(CursorPos& pos);
-    const TTextEditor& getTxt_editor() const;
+    const TextBuffer& getTxt_editor() const;
     void resetSelection();
     void updateSelection(const CursorPos& old_pos, const CursorPos& new_pos);
     CursorPos mouseTextPosToTextPos(const CursorPos& pos);
@@ -253,6 +241,13 @@ public:
     bool reallocate_cursor{ false };
 
     std::string text();
+    // Replaces the whole text, e.g. by a loaded file. '\r' are dropped and tabs become two spaces like on a paste.
+    void setText(const std::string& text);
+
+    // The rows changed since the last 'clearChangedRows'. Rows 'first_row'..'last_row' replace
+    // the rows 'first_row'..'last_row - row_delta' of the text at that time. Returns false if nothing has changed.
+    bool getChangedRows(std::size_t& first_row, std::size_t& last_row, int& row_delta) const;
+    void clearChangedRows();
 
 protected:
     void paintEvent(Wt::WPaintDevice* paintDevice);
@@ -272,9 +267,12 @@ private:
 
     void insertNewLine();
     void insertNewChar(const std::string& s);
+    void insertText(const std::string& s);
+    void markChanged(std::size_t first_row, std::size_t old_last_row, std::size_t new_last_row);
 
     void handleKeyDown(const Wt::WKeyEvent& e);
     void handleKeyUp(const Wt::WKeyEvent& e);
+    void traceKey(const char* event, const Wt::WKeyEvent& e);
 
     void maximize_range(Scroll& scroll);
 
@@ -290,7 +288,7 @@ private:
     std::string getTextInRange(std::size_t row_start, std::size_t col_start, std::size_t row_end, std::size_t col_end);
     std::string selectedText();
 
-    TTextEditor txt_editor{ {} };
+    TextBuffer txt_editor;
     CursorPos current_pos;
 
     Selection selection;
@@ -310,6 +308,11 @@ private:
     double status_panel_height = 20;
     int width_{ 0 }, height_{ 0 };
 
+    bool has_changes{ false };
+    std::size_t changed_first_row{ 0 };
+    std::size_t changed_last_row{ 0 };
+    int changed_row_delta{ 0 };
+
     bool isDragMode{ false };
     Rect* dragComponent{ NULL };
 };
@@ -17,42 +17,21 @@
 #include <Wt/WBorderLayout.h>
 #include <Wt/WHBoxLayout.h>
 #include <Wt/WVBoxLayout.h>
+#include <Wt/WServer.h>
+#include <chrono>
 
+#include "HelloApplication.h"
 #include "CodeEditor.h"
+#include "compiler.h"
+#include "executionservice.h"
+#include "loadtest.h"
+#include "benchmark.h"
+#include "metrics.h"
+#include "metricsresource.h"
 #include "DebugInspector.h"
 #include "parser.h"
 #include "vm.h"
 
- /*
-  * A simple hello world application class which demonstrates how to react
-  * to events, read input, and give feed-back.
-  */
-class HelloApplication : public Wt::WApplication
-{
-public:
-    HelloApplication(const Wt::WEnvironment& env);
-
-private:
-    Wt::WLineEdit* nameEdit_;
-    Wt::WText* greeting_;
-
-    Wt::WToolBar* toolbar_;
-//    Wt::WTextArea* codeTextArea_;
-    Wt::WTextArea* compileOutputTextArea_;
-    DebugInspector* debugInspector_;
-    CodeEditor* codeEditor_;
-
-    Parser parser;
-    ParseTrace parse_trace;
-    Bytecode bytecode;
-    VM vm;
-
-    void compile();
-    void execute();
-    void greet();
-    Wt::JSlot scrolldown;
-};
-
 /*
  * The env argument contains information about the new session, and
  * the initial request. It must be passed to the WApplication
@@ -60,7 +39,9 @@ private:
  * application constructor.
 */
 HelloApplication::HelloApplication(const Wt::WEnvironment& env)
-    : WApplication(env)
+    : WApplication(env),
+      diagnostics_sink(std::make_shared<MemorySink>(DIAGNOSTICS_CAPACITY)),
+      diagnostics(std::make_shared<Diagnostics>(EDiagnosticLevel::LEVEL_OFF, diagnostics_sink))
 {
     
 //    WApplication::instance()->require("/apputils.js");
@@ -69,11 +50,23 @@ HelloApplication::HelloApplication(const Wt::WEnvironment& env)
     setCssTheme("polished");
     useStyleSheet("ants.css");
 
+    // Programs run on the ExecutionService workers, which push their progress to the session
+    enableUpdates(true);
+
+    const std::string* diagnostics_level = env.getParameter("diagnostics");
+    if (diagnostics_level) {
+        diagnostics->setLevel(Diagnostics::parseLevel(*diagnostics_level));
+    }
+
     std::unique_ptr<Wt::WToolBar> up_toolbar_ = std::make_unique<Wt::WToolBar>();
     std::unique_ptr<Wt::WPushButton> up_compileBtn_ = std::make_unique<Wt::WPushButton>("Compile");
     up_compileBtn_->clicked().connect(this, &HelloApplication::compile);
     std::unique_ptr<Wt::WPushButton> up_executeBtn_ = std::make_unique<Wt::WPushButton>("Execute");
     up_executeBtn_->clicked().connect(this, &HelloApplication::execute);
+    std::unique_ptr<Wt::WPushButton> up_cancelBtn_ = std::make_unique<Wt::WPushButton>("Cancel");
+    up_cancelBtn_->clicked().connect(this, &HelloApplication::cancel);
+    up_cancelBtn_->disable();
+    std::unique_ptr<Wt::WText> up_progress_ = std::make_unique<Wt::WText>();
 //    std::unique_ptr<Wt::WTextArea> up_codeTextArea_ = std::make_unique<Wt::WTextArea>();
 //    up_codeTextArea_->setFocus();
     std::unique_ptr<Wt::WTextArea> up_compileOutputTextArea_ = std::make_unique<Wt::WTextArea>();
@@ -107,7 +100,12 @@ HelloApplication::HelloApplication(const Wt::WEnvironment& env)
  //!!!!!!   compileOutputTextArea_ = left_layout->addWidget(std::move(up_compileOutputTextArea_));
     
     toolbar_->addButton(std::move(up_compileBtn_));
+    executeBtn_ = up_executeBtn_.get();
     toolbar_->addButton(std::move(up_executeBtn_));
+    cancelBtn_ = up_cancelBtn_.get();
+    toolbar_->addButton(std::move(up_cancelBtn_));
+    progress_ = up_progress_.get();
+    toolbar_->addWidget(std::move(up_progress_));
 
     center_layout->setResizable(0);
 //!!!!!!!    left_layout->setResizable(0);
@@ -156,6 +154,72 @@ HelloApplication::HelloApplication(const Wt::WEnvironment& env)
 //    });
 }
 
+void HelloApplication::notify(const Wt::WEvent& event)
+{
+    Diagnostics::Scope diagnostics_scope(diagnostics.get());
+
+    Wt::WApplication::notify(event);
+}
+
+// Only the compiled program stays in the session, the tokens and the symbol table are released afterwards.
+// A failed compilation leaves no program.
+EParseStatus HelloApplication::compileSource(const std::string& source, const SourceEdit& edit, ParseTrace& parse_trace)
+{
+    Diagnostics::Scope diagnostics_scope(diagnostics.get());
+
+    if (!parser) {
+        parser = std::make_unique<Parser>();
+    }
+
+    Bytecode bytecode;
+    auto start = std::chrono::steady_clock::now();
+
+    EParseStatus ret = parser->parse(source, edit, parse_trace, bytecode);
+
+    long long compile_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    Metrics::instance().recordCompile(compile_us, source.size(), bytecode.size(), ret == EParseStatus::PARSE_OK);
+
+    parser->release();
+
+    if (ret == EParseStatus::PARSE_OK) {
+        bytecode.compact();
+
+        if (Diagnostics::isEnabled(EDiagnosticLevel::LEVEL_DEBUG)) {
+            Diagnostics::write(EDiagnosticLevel::LEVEL_DEBUG, bytecode.listing());
+        }
+
+        program = std::make_shared<const Bytecode>(std::move(bytecode));
+    } else {
+        program.reset();
+    }
+
+    return ret;
+}
+
+// Queues the compiled program. The progress and the result are posted to this session.
+std::shared_ptr<ExecutionJob> HelloApplication::submitExecution()
+{
+    if (!program) {
+        return NULL;
+    }
+
+    return ExecutionService::instance().submit(program, sessionId(), diagnostics,
+        std::bind(&HelloApplication::executionProgress, this, std::placeholders::_1),
+        std::bind(&HelloApplication::executionOutput, this, std::placeholders::_1, std::placeholders::_2),
+        std::bind(&HelloApplication::executionFinished, this, std::placeholders::_1, std::placeholders::_2));
+}
+
+SessionMemoryReport HelloApplication::memoryReport() const
+{
+    SessionMemoryReport report;
+
+    report.parser = parser ? parser->getMemoryEstimate() : 0;
+    report.program = program ? program->getMemoryEstimate() : 0;
+    report.execution = execution_ ? execution_->getMemoryUsed() : 0;
+
+    return report;
+}
+
 void HelloApplication::compile()
 {
     Wt::WString txt = compileOutputTextArea_->text();
@@ -165,10 +229,18 @@ void HelloApplication::compile()
 
     compileOutputTextArea_->setText("");
 
-    parser.clear();
-    parse_trace.clear();
+    // Only the edited top-level functions are compiled again
+    SourceEdit edit;
+    std::size_t first_row, last_row;
 
-    EParseStatus ret = parser.parse(codeEditor_->text(), parse_trace, bytecode);
+    if (codeEditor_->getChangedRows(first_row, last_row, edit.row_delta)) {
+        edit.first_row = first_row;
+        edit.last_row = last_row;
+    }
+    codeEditor_->clearChangedRows();
+
+    ParseTrace parse_trace;
+    EParseStatus ret = compileSource(codeEditor_->text(), edit, parse_trace);
 
     if (ret == EParseStatus::PARSE_OK) {
         compileOutputTextArea_->setText("Compiled successfully\n");
@@ -177,20 +249,100 @@ void HelloApplication::compile()
         Wt::WString txt = Wt::WString("Compilation errors:\n") + parse_trace.getString();
         compileOutputTextArea_->setText(txt);
     }
+
+    showDiagnostics();
+}
+
+HelloApplication::~HelloApplication()
+{
+    // Free the worker for other sessions
+    if (execution_) {
+        execution_->cancel();
+    }
 }
 
 void HelloApplication::execute() {
-    EExecStatus status = EExecStatus::OK_RUN;
+    if (execution_) {
+        return;
+    }
 
-    compileOutputTextArea_->setText("");
+    execution_ = submitExecution();
+
+    if (!execution_) {
+        compileOutputTextArea_->setText("No compiled program to execute\n");
+        return;
+    }
+
+    compileOutputTextArea_->setText("Executing ...\n");
+    progress_->setText("");
+    executeBtn_->disable();
+    cancelBtn_->enable();
+}
 
-    vm.init();
-    vm.execute(bytecode, status);
-    debugInspector_->update(bytecode);
+void HelloApplication::cancel() {
+    if (execution_) {
+        execution_->cancel();
+    }
+}
 
-    Wt::WString txt = Wt::WString("Program execution finished: ") + exec_status_descriptions[static_cast<int>(status)] + "\n";
+// Posted by the ExecutionService to this session
+void HelloApplication::executionProgress(unsigned long long executed_instructions) {
+    std::string memory = execution_ ? ", " + std::to_string(execution_->getMemoryUsed() / 1024) + " KB used" : "";
 
-    compileOutputTextArea_->setText(txt);
+    progress_->setText(std::to_string(executed_instructions) + " instructions executed" + memory);
+    triggerUpdate();
+}
+
+// Posted by the ExecutionService to this session, a batch of what the program has printed
+void HelloApplication::executionOutput(const std::string& text, unsigned long long dropped) {
+    if (dropped > 0) {
+        appendOutput("[" + std::to_string(dropped) + " bytes of output dropped]\n");
+    }
+
+    appendOutput(text);
+    triggerUpdate();
+}
+
+void HelloApplication::appendOutput(const std::string& text) {
+    std::string output = compileOutputTextArea_->text().toUTF8() + text;
+
+    if (output.size() > OUTPUT_WIDGET_CAPACITY) {
+        size_t cut = output.size() - OUTPUT_WIDGET_CAPACITY;
+
+        // Don't split a UTF-8 character
+        while (cut < output.size() && (output[cut] & 0xC0) == 0x80) {
+            cut++;
+        }
+        output.erase(0, cut);
+    }
+
+    compileOutputTextArea_->setText(Wt::WString::fromUTF8(output));
+}
+
+void HelloApplication::showDiagnostics() {
+    std::string text = takeDiagnostics();
+
+    if (!text.empty()) {
+        appendOutput("Diagnostics:\n" + text);
+    }
+}
+
+// Posted by the ExecutionService to this session
+void HelloApplication::executionFinished(EExecStatus status, Bytecode& executed_bytecode) {
+    size_t memory_peak = execution_ ? execution_->getMemoryPeak() : 0;
+
+    execution_.reset();
+    executeBtn_->enable();
+    cancelBtn_->disable();
+    progress_->setText("");
+
+    debugInspector_->update(executed_bytecode);
+
+    // After the program output, which has been flushed just before
+    appendOutput(std::string("Program execution finished: ") + exec_status_descriptions[static_cast<int>(status)] + "\n"
+        + "Peak memory: " + std::to_string(memory_peak / 1024) + " KB\n");
+    showDiagnostics();
+    triggerUpdate();
 }
 
 void HelloApplication::greet()
@@ -203,22 +355,88 @@ void HelloApplication::greet()
 
 int main(int argc, char** argv)
 {
+    // Batch compilation: ConsoleApplication1 --compile <directory>
+    if (argc == 3 && std::string(argv[1]) == "--compile") {
+        std::vector<CompileResult> results = Compiler::compileDirectory(argv[2], CompileOptions());
+
+        for (const CompileResult& result: results) {
+            if (result.status != EParseStatus::PARSE_OK) {
+                std::cerr << result.name << ":" << std::endl << result.errors << std::endl;
+            }
+        }
+        std::cout << Compiler::timingReport(results);
+
+        return 0;
+    }
+
+    // Load test: ConsoleApplication1 --loadtest <directory> [sessions] [cycles]
+    if (argc >= 3 && argc <= 5 && std::string(argv[1]) == "--loadtest") {
+        LoadTestOptions options;
+
+        if (argc >= 4) options.sessions = std::stoi(argv[3]);
+        if (argc >= 5) options.cycles = std::stoi(argv[4]);
+
+        std::vector<std::string> scripts = LoadTest::readScripts(argv[2]);
+        if (scripts.empty()) {
+            std::cerr << "No scripts in " << argv[2] << std::endl;
+            return 1;
+        }
+
+        std::cout << LoadTest::run(scripts, options).toString();
+
+        return 0;
+    }
+
+    // Keyword classification benchmark: ConsoleApplication1 --bench <directory> [rounds]
+    if (argc >= 3 && argc <= 4 && std::string(argv[1]) == "--bench") {
+        unsigned int rounds = argc >= 4 ? std::stoi(argv[3]) : 50;
+
+        std::vector<std::string> scripts = LoadTest::readScripts(argv[2]);
+        if (scripts.empty()) {
+            std::cerr << "No scripts in " << argv[2] << std::endl;
+            return 1;
+        }
+
+        KeywordBenchmarkReport report = Benchmark::keywords(scripts, rounds);
+        std::cout << report.toString();
+
+        return report.mismatches == 0 ? 0 : 1;
+    }
+
     /*
      * Your main method may set up some shared resources, but should then
      * start the server application (FastCGI or httpd) that starts listening
      * for requests, and handles all of the application life cycles.
      *
-     * The last argument to WRun specifies the function that will instantiate
-     * new application objects. That function is executed when a new user surfs
-     * to the Wt application, and after the library has negotiated browser
-     * support. The function should return a newly instantiated application
-     * object.
+     * The entry point function will instantiate new application objects.
+     * That function is executed when a new user surfs to the Wt application,
+     * and after the library has negotiated browser support. The function
+     * should return a newly instantiated application object.
      */
-    return Wt::WRun(argc, argv, [](const Wt::WEnvironment& env) {
-        /*
-         * You could read information from the environment to decide whether
-         * the user has permission to start a new application
-         */
-        return Wt::cpp14::make_unique<HelloApplication>(env);
-    });
+    try {
+        Wt::WServer server(argc, argv, WTHTTP_CONFIGURATION);
+        MetricsResource metrics;
+
+        // The metrics are exported from the start, also before anything has been recorded
+        Metrics::instance();
+        server.addResource(&metrics, "/metrics");
+
+        server.addEntryPoint(Wt::EntryPointType::Application, [](const Wt::WEnvironment& env) {
+            /*
+             * You could read information from the environment to decide whether
+             * the user has permission to start a new application
+             */
+            return Wt::cpp14::make_unique<HelloApplication>(env);
+        });
+
+        server.run();
+    } catch (Wt::WServer::Exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    } catch (std::exception& e) {
+        std::cerr << "exception: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
 }
\ No newline at end of file
@@ -118,26 +118,26 @@ void DebugInspector::getArrayElements(Wt::WTreeTableNode* parent, const Array* a
 		ValuePointer& v = el->getValue();
 		std::string val_str;
 
-		if (   (v.datatype[0] == 'i') 
-			|| (v.datatype[0] == 'f')
-			|| (v.datatype[0] == 's')
-			|| (v.datatype[0] == 'b')
+		if (   (v.kind() == 'i') 
+			|| (v.kind() == 'f')
+			|| (v.kind() == 's')
+			|| (v.kind() == 'b')
 			)
 		{
 			val_str = el->valueToString();
 		}
-		else if (v.datatype[0] == 'a') {
+		else if (v.kind() == 'a') {
 			val_str = "Array";
 		}
 
 		Wt::WTreeTableNode* new_node = addNode(
 			parent,
 			Wt::WString(el->indexesToString()),
-			Wt::WString(el->getValue().datatype),
+			Wt::WString(TypeTable::instance().getSignature(el->getValue().datatype)),
 			Wt::WString(val_str)
 		);
 
-		if (v.datatype[0] == 'a') {
+		if (v.kind() == 'a') {
 			getArrayElements(new_node, static_cast<const Array*>(el->getValue().pvalue));
 		}
 	}
@@ -0,0 +1,92 @@
+#ifndef HELLOAPPLICATION_H
+#define HELLOAPPLICATION_H
+
+#include <Wt/WApplication.h>
+#include <Wt/WJavaScript.h>
+#include <Wt/WLineEdit.h>
+#include <Wt/WPushButton.h>
+#include <Wt/WText.h>
+#include <Wt/WTextArea.h>
+#include <Wt/WToolBar.h>
+
+#include <memory>
+#include <string>
+
+#include "CodeEditor.h"
+#include "DebugInspector.h"
+#include "diagnostics.h"
+#include "executionservice.h"
+#include "parser.h"
+#include "vm.h"
+
+// What a session holds between its requests (bytes), see HelloApplication::memoryReport
+struct SessionMemoryReport
+{
+    size_t parser{ 0 };         // Estimated. The state kept for the incremental compilation.
+    size_t program{ 0 };        // The compiled program, shared with the executions of it
+    size_t execution{ 0 };      // Owned by the running program, 0 if none runs
+
+    size_t total() const { return parser + program + execution; }
+};
+
+ /*
+  * A simple hello world application class which demonstrates how to react
+  * to events, read input, and give feed-back.
+  */
+class HelloApplication : public Wt::WApplication
+{
+public:
+    HelloApplication(const Wt::WEnvironment& env);
+    ~HelloApplication();
+
+    // The work behind the Compile and Execute buttons without the widgets. The load test drives sessions with them.
+    // 'submitExecution' returns NULL if there is no compiled program.
+    EParseStatus compileSource(const std::string& source, const SourceEdit& edit, ParseTrace& parse_trace);
+    std::shared_ptr<ExecutionJob> submitExecution();
+
+    SessionMemoryReport memoryReport() const;
+
+    // The diagnostics of the compilations and executions of this session are kept in memory.
+    // Off unless the session is opened with the URL parameter diagnostics=<level>.
+    void setDiagnosticsLevel(EDiagnosticLevel level) { diagnostics->setLevel(level); }
+    std::string takeDiagnostics() { return diagnostics_sink->take(); }
+
+protected:
+    // Every event of the session is handled with its diagnostics bound, so the widgets trace to the session
+    void notify(const Wt::WEvent& event) override;
+
+private:
+    static constexpr size_t OUTPUT_WIDGET_CAPACITY = 64 * 1024;   // The program output shown. Older output is cut off.
+    static constexpr size_t DIAGNOSTICS_CAPACITY = 256 * 1024;    // The diagnostics kept until they're shown
+
+    Wt::WLineEdit* nameEdit_;
+    Wt::WText* greeting_;
+
+    Wt::WToolBar* toolbar_;
+    Wt::WPushButton* executeBtn_;
+    Wt::WPushButton* cancelBtn_;
+    Wt::WText* progress_;
+//    Wt::WTextArea* codeTextArea_;
+    Wt::WTextArea* compileOutputTextArea_;
+    DebugInspector* debugInspector_;
+    CodeEditor* codeEditor_;
+
+    std::unique_ptr<Parser> parser;             // Created by the first compilation
+    std::shared_ptr<const Bytecode> program;    // The last successfully compiled program
+    std::shared_ptr<ExecutionJob> execution_;   // The running program
+    std::shared_ptr<MemorySink> diagnostics_sink;
+    std::shared_ptr<Diagnostics> diagnostics;   // Shared with the executions, which may outlive the session
+
+    void compile();
+    void execute();
+    void cancel();
+    void executionProgress(unsigned long long executed_instructions);
+    void executionOutput(const std::string& text, unsigned long long dropped);
+    void appendOutput(const std::string& text);
+    void showDiagnostics();
+    void executionFinished(EExecStatus status, Bytecode& executed_bytecode);
+    void greet();
+    Wt::JSlot scrolldown;
+};
+
+#endif // HELLOAPPLICATION_H
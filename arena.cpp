@@ -0,0 +1,78 @@
+#include "arena.h"
+#include "memoryaccount.h"
+
+/*******************************************
+ * class Arena
+ *******************************************/
+
+Arena::Arena() : current(0), used(0)
+{
+}
+
+Arena::~Arena()
+{
+    release();
+}
+
+// Moves to the next block which can hold 'size' bytes. Blocks left by 'reset' are reused first.
+void* Arena::allocateBlock(size_t size, size_t alignment)
+{
+    size_t needed = size + alignment;
+
+    if (current < blocks.size()) {
+        current++;
+    }
+
+    if (current < blocks.size() && blocks[current].size >= needed) {
+        used = 0;
+        return allocate(size, alignment);
+    }
+
+    size_t block_size = blocks.empty() ? MIN_BLOCK_SIZE : blocks.back().size * 2;
+
+    if (block_size > MAX_BLOCK_SIZE) {
+        block_size = MAX_BLOCK_SIZE;
+    }
+    if (block_size < needed) {
+        block_size = needed;
+    }
+
+    Block block;
+    block.data = static_cast<char*>(::operator new(block_size));
+    MemoryAccount::charge(block_size);
+    block.size = block_size;
+
+    blocks.insert(blocks.begin() + current, block);
+    used = 0;
+
+    return allocate(size, alignment);
+}
+
+void Arena::reset()
+{
+    current = 0;
+    used = 0;
+}
+
+void Arena::release()
+{
+    for (Block& block : blocks) {
+        ::operator delete(block.data);
+        MemoryAccount::credit(block.size);
+    }
+
+    blocks.clear();
+    current = 0;
+    used = 0;
+}
+
+size_t Arena::capacity() const
+{
+    size_t ret = 0;
+
+    for (const Block& block : blocks) {
+        ret += block.size;
+    }
+
+    return ret;
+}
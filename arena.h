@@ -0,0 +1,63 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <vector>
+
+// The bump allocator for small objects with a common lifetime.
+// Memory is taken from blocks which grow geometrically. Single objects are never freed:
+// 'reset' rewinds the arena keeping its blocks for reuse, 'release' frees everything.
+// Objects created in the arena must be destroyed by the owner before 'reset'/'release'.
+// The blocks are charged to the MemoryAccount bound to the thread.
+class Arena
+{
+private:
+    static const size_t MIN_BLOCK_SIZE = 256;
+    static const size_t MAX_BLOCK_SIZE = 64 * 1024;
+
+    struct Block
+    {
+        char* data;
+        size_t size;
+    };
+
+    std::vector<Block> blocks;
+    size_t current;     // the block being filled
+    size_t used;        // bytes used in the current block
+
+    void* allocateBlock(size_t size, size_t alignment);
+
+public:
+    Arena();
+    ~Arena();
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void* allocate(size_t size, size_t alignment = alignof(std::max_align_t)) {
+        if (current < blocks.size()) {
+            size_t offset = (used + alignment - 1) & ~(alignment - 1);
+
+            if (offset + size <= blocks[current].size) {
+                used = offset + size;
+                return blocks[current].data + offset;
+            }
+        }
+
+        return allocateBlock(size, alignment);
+    }
+
+    template<class T, class... Args>
+    T* create(Args&&... args) {
+        return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    void reset();
+    void release();
+
+    // The total size of the blocks owned by the arena
+    size_t capacity() const;
+};
+
+#endif // ARENA_H
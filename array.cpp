@@ -1,4 +1,7 @@
 #include "array.h"
+#include "stringtable.h"
+#include "memoryaccount.h"
+#include "diagnostics.h"
 #include <iostream>
 #include <locale>
 #include <codecvt>
@@ -7,19 +10,26 @@
  * ValuePointer
  ********************************************************/
 
-ValuePointer::ValuePointer() : pvalue(NULL) {}
-ValuePointer::ValuePointer(const std::string& datatype, void* pvalue) : datatype(datatype), pvalue(pvalue) {
+ValuePointer::ValuePointer() : datatype(TYPE_UNDEFINED), pvalue(NULL) {}
+ValuePointer::ValuePointer(TypeId datatype, void* pvalue) : datatype(datatype), pvalue(pvalue) {
 }
 ValuePointer::ValuePointer(const ValuePointer& other) {
     datatype = other.datatype;
     pvalue = other.pvalue;
 }
 
+ValuePointer& ValuePointer::operator=(const ValuePointer& other) {
+    datatype = other.datatype;
+    pvalue = other.pvalue;
+
+    return *this;
+}
+
 std::string ValuePointer::toString() const {
     std::string ret;
 
-    ret = datatype + std::string(" : ");
-    switch(datatype[0]) {
+    ret = TypeTable::instance().getSignature(datatype) + std::string(" : ");
+    switch(kind()) {
         case 'i':
             ret += std::to_string( *(long long int*)pvalue );
             break;
@@ -41,8 +51,8 @@ std::string ValuePointer::toString() const {
 }
 
 bool ValuePointer::operator==(const ValuePointer& other) {
-    char this_datatype_1 = datatype[0];
-    char other_datatype_1 = other.datatype[0];
+    char this_datatype_1 = kind();
+    char other_datatype_1 = other.kind();
 
     if (this_datatype_1 == 'i' && other_datatype_1 == 'i') {
         return (*(long long int*)pvalue == *(long long int*)other.pvalue);
@@ -60,8 +70,8 @@ bool ValuePointer::operator==(const ValuePointer& other) {
 }
 
 bool ValuePointer::operator!=(const ValuePointer& other) {
-    char this_datatype_1 = datatype[0];
-    char other_datatype_1 = other.datatype[0];
+    char this_datatype_1 = kind();
+    char other_datatype_1 = other.kind();
 
     if (this_datatype_1 == 'i' && other_datatype_1 == 'i') {
         return (*(long long int*)pvalue != *(long long int*)other.pvalue);
@@ -79,8 +89,8 @@ bool ValuePointer::operator!=(const ValuePointer& other) {
 }
 
 ValuePointer& ValuePointer::operator+=(const ValuePointer& other) {
-    char this_datatype_1 = datatype[0];
-    char other_datatype_1 = other.datatype[0];
+    char this_datatype_1 = kind();
+    char other_datatype_1 = other.kind();
 
     if (this_datatype_1 == 'i' && other_datatype_1 == 'i') {
         (*(long long int*)pvalue += *(long long int*)other.pvalue);
@@ -100,19 +110,20 @@ ValuePointer& ValuePointer::operator+=(const ValuePointer& other) {
 /********************************************************
  * ArrayElement
  ********************************************************/
-ArrayElement::ArrayElement() {
-}
-
-// ArrayElement::ArrayElement(const ValuePointer& pval): datatype(pval.datatype), value(pval.pvalue) {
-// }
+ArrayElement::ArrayElement(Arena* arena, unsigned int indexes_size) : arena(arena), indexes(NULL), indexes_count(0), indexes_size(indexes_size) {
+    if (indexes_size > 0) {
+        indexes = static_cast<ValuePointer*>(arena->allocate(sizeof(ValuePointer) * indexes_size, alignof(ValuePointer)));
 
-ArrayElement::ArrayElement(const ArrayElement& other) {
-    // index_datatypes = other.index_datatypes; 'index-datatypes' will be filled in below in 'addIndex'
-    value.datatype = other.value.datatype;
+        for (unsigned int i=0; i<indexes_size; i++) {
+            new (&indexes[i]) ValuePointer();
+        }
+    }
+}
 
+ArrayElement::ArrayElement(Arena* arena, const ArrayElement& other) : ArrayElement(arena, other.indexes_count) {
     // Copy indexes
-    for (int i=0; i<other.indexes.size(); i++) {
-        switch(other.indexes[i].datatype[0]) {
+    for (int i=0; i<other.indexes_count; i++) {
+        switch(other.indexes[i].kind()) {
             case 'i':
                 addIndex(*static_cast<long long int*>(other.indexes[i].pvalue));
                 break;
@@ -129,7 +140,7 @@ ArrayElement::ArrayElement(const ArrayElement& other) {
     }
 
     // Copy value
-    switch(other.value.datatype[0]) {
+    switch(other.value.kind()) {
         case 'i':
             setValue(*static_cast<long long int*>(other.value.pvalue));
             break;
@@ -150,7 +161,9 @@ ArrayElement::ArrayElement(const ArrayElement& other) {
 
 ArrayElement::~ArrayElement() {
     // Delete the element's value
-    std::cout << "Delete ArrayElement: " << value.datatype.c_str() << std::endl;
+    if (Diagnostics::isEnabled(EDiagnosticLevel::LEVEL_TRACE)) {
+        Diagnostics::write(EDiagnosticLevel::LEVEL_TRACE, "Delete ArrayElement: " + TypeTable::instance().getSignature(value.datatype));
+    }
 
     clear();
 }
@@ -166,98 +179,38 @@ bool ArrayElement::operator!=(const ArrayElement& other) {
 void ArrayElement::clear_value() {
     // Delete the element's value
 
-    if (!value.datatype.empty()) {
+    if (value.datatype != TYPE_UNDEFINED) {
+        // The cell memory belongs to the arena. Only values owning resources have to be destroyed.
         if (value.pvalue != NULL) {
-            switch(value.datatype[0]) {
-                case 'i':
-                    delete static_cast<long long int*>(value.pvalue);
-                    break;
-                case 'f':
-                    delete static_cast<long double*>(value.pvalue);
-                    break;
-                case 'b':
-                    delete static_cast<bool*>(value.pvalue);
-                    break;
+            switch(value.kind()) {
                 case 's':
-                    delete static_cast<std::string*>(value.pvalue);
+                    MemoryAccount::credit(MemoryAccount::stringSize(*static_cast<std::string*>(value.pvalue)));
+                    static_cast<std::string*>(value.pvalue)->~basic_string();
                     break;
                 case 'a':
-                    delete static_cast<Array*>(value.pvalue);
+                    static_cast<Array*>(value.pvalue)->~Array();
                     break;
             }
         }
     }
 
     value.pvalue = NULL;
-    value.datatype = "";
+    value.datatype = TYPE_UNDEFINED;
 }
 
 void ArrayElement::clear() {
     clear_value();
 
-    // Release indexes
-    for (int i=0; i<indexes.size(); i++) {
-        switch(indexes[i].datatype[0]) {
-            case 'i':
-                delete static_cast<long long int*>(indexes[i].pvalue);
-                break;
-            case 'f':
-                delete static_cast<long double*>(indexes[i].pvalue);
-                break;
-            case 'b':
-                delete static_cast<bool*>(indexes[i].pvalue);
-                break;
-            case 's':
-                delete static_cast<std::string*>(indexes[i].pvalue);
-                break;
+    // Release string keys. Other index cells belong to the arena.
+    for (int i=0; i<indexes_count; i++) {
+        if (indexes[i].kind() == 's') {
+            StringTable::instance().release(static_cast<const std::string*>(indexes[i].pvalue));
         }
 
         indexes[i].pvalue = NULL;
     }
-}
-
-void ArrayElement::operator= (const ArrayElement& other) {
-    // index_datatypes = other.index_datatypes; 'index-datatypes' will be filled in below in 'addIndex'
-    value.datatype = other.value.datatype;
-
-    clear();
-
-    // Copy indexes
-    for (int i=0; i<other.indexes.size(); i++) {
-        switch(other.indexes[i].datatype[0]) {
-            case 'i':
-                addIndex(*static_cast<long long int*>(other.indexes[i].pvalue));
-                break;
-            case 'f':
-                addIndex(*static_cast<long double*>(other.indexes[i].pvalue));
-                break;
-            case 'b':
-                addIndex(*static_cast<bool*>(other.indexes[i].pvalue));
-                break;
-            case 's':
-                addIndex(*static_cast<std::string*>(other.indexes[i].pvalue));
-                break;
-        }
-    }
 
-    // Copy value
-    switch(other.value.datatype[0]) {
-        case 'i':
-            setValue(*static_cast<long long int*>(other.value.pvalue));
-            break;
-        case 'f':
-            setValue(*static_cast<long double*>(other.value.pvalue));
-            break;
-        case 'b':
-            setValue(*static_cast<bool*>(other.value.pvalue));
-            break;
-        case 's':
-            setValue(*static_cast<std::string*>(other.value.pvalue));
-            break;
-        case 'a':
-            setValue(other.value.datatype, *static_cast<Array*>(other.value.pvalue));
-            break;
-    }
+    indexes_count = 0;
 }
 
 ArrayElement& ArrayElement::operator+=(const ArrayElement& other) {
@@ -266,60 +219,60 @@ ArrayElement& ArrayElement::operator+=(const ArrayElement& other) {
     return *this;
 }
 
+// Indexes can be added only up to the number of slots given to the constructor
 void ArrayElement::addIndex(long long int idx) {
-    long long int* p = new long long int;
-    *p = idx;
-    indexes.push_back(ValuePointer("i", p));
+    if (indexes_count < indexes_size) {
+        indexes[indexes_count++] = ValuePointer(TYPE_INT, arena->create<long long int>(idx));
+    }
 }
 void ArrayElement::addIndex(long double idx) {
-    long double* p = new long double;
-    *p = idx;
-    indexes.push_back(ValuePointer("f", p));
+    if (indexes_count < indexes_size) {
+        indexes[indexes_count++] = ValuePointer(TYPE_FLOAT, arena->create<long double>(idx));
+    }
 }
 void ArrayElement::addIndex(bool idx) {
-    bool* p = new bool;
-    *p = idx;
-    indexes.push_back(ValuePointer("b", p));
+    if (indexes_count < indexes_size) {
+        indexes[indexes_count++] = ValuePointer(TYPE_BOOLEAN, arena->create<bool>(idx));
+    }
 }
+// String keys are interned - equal keys share one copy and compare by pointer
 void ArrayElement::addIndex(const std::string& idx) {
-    std::string* p = new std::string;
-    *p = idx;
-    indexes.push_back(ValuePointer("s", p));
+    if (indexes_count < indexes_size) {
+        const std::string* p = StringTable::instance().intern(idx);
+        indexes[indexes_count++] = ValuePointer(TYPE_STRING, (void*)p);
+    }
 }
 
 void* ArrayElement::setValue(long long int v) {
     clear_value();
-    value.datatype = "i";
-    value.pvalue = new long long int;
-    *(long long int*)value.pvalue = v;
+    value.datatype = TYPE_INT;
+    value.pvalue = arena->create<long long int>(v);
     return value.pvalue;
 }
 void* ArrayElement::setValue(long double v) {
     clear_value();
-    value.datatype = "f";
-    value.pvalue = new long double;
-    *(long double*)value.pvalue = v;
+    value.datatype = TYPE_FLOAT;
+    value.pvalue = arena->create<long double>(v);
     return value.pvalue;
 }
 void* ArrayElement::setValue(bool v) {
     clear_value();
-    value.datatype = "b";
-    value.pvalue = new bool;
-    *(bool*)value.pvalue = v;
+    value.datatype = TYPE_BOOLEAN;
+    value.pvalue = arena->create<bool>(v);
     return value.pvalue;
 }
 void* ArrayElement::setValue(const std::string& v) {
     clear_value();
-    value.datatype = "s";
-    value.pvalue = new std::string;
-    *(std::string*)value.pvalue = v;
+    value.datatype = TYPE_STRING;
+    value.pvalue = arena->create<std::string>(v);
+    MemoryAccount::charge(MemoryAccount::stringSize(*static_cast<std::string*>(value.pvalue)));   // The cell is in the arena, the buffer isn't
     return value.pvalue;
 }
-void* ArrayElement::setValue(const std::string& datatype, const Array& v) {
+// The nested array has its own arena for its elements
+void* ArrayElement::setValue(TypeId datatype, const Array& v) {
     clear_value();
     value.datatype = datatype;
-    value.pvalue = new Array;
-    *(Array*)value.pvalue = v;
+    value.pvalue = arena->create<Array>(v);
     return value.pvalue;
 }
 
@@ -327,10 +280,10 @@ ValuePointer& ArrayElement::getValue() {
     return value;
 }
 
-bool ArrayElement::checkIndexes(const std::vector<ValuePointer>& search_indexes) {
-    for (int i=0; i<indexes.size(); i++) {
-        char datatype_code = indexes[i].datatype[0];
-        char search_datatype_code = search_indexes[i].datatype[0];
+bool ArrayElement::checkIndexes(const ValuePointer* search_indexes) {
+    for (int i=0; i<indexes_count; i++) {
+        char datatype_code = indexes[i].kind();
+        char search_datatype_code = search_indexes[i].kind();
 
         if (datatype_code == 'i' && search_datatype_code == 'i') {
             if (*(long long int*)(indexes[i].pvalue) != *(long long int*)(search_indexes[i].pvalue)) {
@@ -349,7 +302,8 @@ bool ArrayElement::checkIndexes(const std::vector<ValuePointer>& search_indexes)
                 return false;
             }
         } else if (datatype_code == 's' && search_datatype_code == 's') {
-            if (*(std::string*)(indexes[i].pvalue) != *(std::string*)(search_indexes[i].pvalue)) {
+            // Both keys are interned (see Array::getElement)
+            if (indexes[i].pvalue != search_indexes[i].pvalue) {
                 return false;
             }
         } else {
@@ -360,16 +314,20 @@ bool ArrayElement::checkIndexes(const std::vector<ValuePointer>& search_indexes)
     return true;
 }
 
-const std::vector<ValuePointer>& ArrayElement::getIndexes() {
+const ValuePointer* ArrayElement::getIndexes() const {
     return indexes;
 }
 
+unsigned int ArrayElement::getIndexesCount() const {
+    return indexes_count;
+}
+
 std::string ArrayElement::indexesToString() const {
     std::string ret;
     bool is_first = true;
 
     ret = "[";
-    for (int i = 0; i < indexes.size(); i++) {
+    for (int i = 0; i < indexes_count; i++) {
         ret += (is_first ? "" : ",") + indexes[i].toString();
         is_first = false;
     }
@@ -381,7 +339,7 @@ std::string ArrayElement::indexesToString() const {
 std::string ArrayElement::valueToString() const {
     std::string ret;
 
-    switch (value.datatype[0]) {
+    switch (value.kind()) {
     case 'i':
         ret = std::to_string(*(long long int*)value.pvalue);
         break;
@@ -406,7 +364,7 @@ std::string ArrayElement::toString() const {
     std::string ret;
     
     ret = indexesToString();
-    ret += "[" + value.datatype + "] ";
+    ret += "[" + TypeTable::instance().getSignature(value.datatype) + "] ";
     ret += valueToString();
 
     return ret;
@@ -416,54 +374,57 @@ std::string ArrayElement::toString() const {
  * Array
  *************************************************/
 
-Array::Array() {}
-Array::Array(const std::vector<char>& index_datatypes, const std::string& element_datatype) {
-    setIndexDatatypes(index_datatypes);
-    setElementDatatype(element_datatype);
+Array::Array() : datatype(TYPE_UNDEFINED), is_indexed(false) {}
+Array::Array(TypeId datatype) : datatype(datatype), is_indexed(false) {
 }
-Array::Array(const Array& other) {
-    index_datatypes = other.index_datatypes;
-    element_datatype = other.element_datatype;
+Array::Array(const Array& other) : is_indexed(false) {
+    datatype = other.datatype;
+
+    elements.reserve(other.elements.size());
 
     for (int i=0; i<other.elements.size(); i++) {
-        ArrayElement* el = new ArrayElement(*other.elements[i]);
-        addElement(el);
+        elements.push_back(arena.create<ArrayElement>(&arena, *other.elements[i]));
     }
 }
 Array::~Array() {
-    std::cout << "Delete Array: " << element_datatype << std::endl;
+    if (Diagnostics::isEnabled(EDiagnosticLevel::LEVEL_TRACE)) {
+        Diagnostics::write(EDiagnosticLevel::LEVEL_TRACE, "Delete Array: " + getDatatypeString());
+    }
 
     clear();
 }
-void Array::addElement(ArrayElement* element) {
-    elements.push_back(element);
-}
-
 void Array::clear() {
-    index_datatypes.clear();
-    element_datatype = "";
+    datatype = TYPE_UNDEFINED;
 
     clearElements();
+    arena.release();
 }
 
 void Array::clearElements() {
     for (int i=0; i<elements.size(); i++) {
-        delete elements[i];
+        elements[i]->~ArrayElement();
         elements[i] = NULL;
     }
 
     elements.clear();
+    element_index.clear();
+    is_indexed = false;
+    arena.reset();
 }
 
 void Array::operator=(const Array& other) {
-    clear();
+    if (this == &other) {
+        return;
+    }
 
-    index_datatypes = other.index_datatypes;
-    element_datatype = other.element_datatype;
+    clearElements();
+
+    datatype = other.datatype;
+
+    elements.reserve(other.elements.size());
 
     for (int i=0; i<other.elements.size(); i++) {
-        ArrayElement* el = new ArrayElement(*other.elements[i]);
-        addElement(el);
+        elements.push_back(arena.create<ArrayElement>(&arena, *other.elements[i]));
     }
 }
 
@@ -472,8 +433,9 @@ bool Array::operator==(Array& other) {
         return false;
     }
 
+    // Element keys are already interned, so they are looked up in the other array's hash index directly
     for (int i=0; i<elements.size(); i++) {
-        ArrayElement* el = other.getElement(elements[i]->getIndexes(), false);
+        ArrayElement* el = other.findElement(elements[i]->getIndexes());
 
         if (el == NULL) {
             return false;
@@ -488,72 +450,187 @@ bool Array::operator==(Array& other) {
 }
 
 bool Array::operator!=(Array& other) {
-    if (elements.size() != other.elements.size()) {
-        return true;
-    }
+    return !(*this == other);
+}
 
-    for (int i=0; i<elements.size(); i++) {
-        ArrayElement* el = other.getElement(elements[i]->getIndexes(), false);
+Array Array::operator+(const Array& other) {
+    Array ret = *this;
 
-        if (el == NULL) {
-            return true;
-        }
+    if (areArraysCompatible(ret.datatype, other.datatype) ) {
+        ret.merge(other);
+    }
 
-        if (*(elements[i]) != *el) {
-            return true;
-        }
+    return ret;
+}
+
+Array& Array::operator+=(const Array& other) {
+    if (areArraysCompatible(datatype, other.datatype) ) {
+        merge(other);
     }
 
-    return false;
+    return *this;
 }
 
-Array Array::operator+(const Array& other) {
-    Array ret = *this;
+// Adds values of the other array's elements to the elements with the same indexes, creating missing ones
+void Array::merge(const Array& other) {
+    if (!is_indexed) {
+        buildIndex();
+    }
 
-    if (areArraysCompatible(ret.getDatatypeString(), other.getDatatypeString()) ) {
-        for(ArrayElement* el: other.elements) {
-            ArrayElement* new_el = ret.getElement(el->getIndexes(), true);
-            *new_el += *el;
+    element_index.reserve(elements.size() + other.elements.size());
+
+    for(ArrayElement* el: other.elements) {
+        ArrayElement* new_el = findElement(el->getIndexes());
+
+        if (new_el == NULL) {
+            new_el = createElement(el->getIndexes());
         }
-    }
 
-    return ret;
+        *new_el += *el;
+    }
 }
 
-Array& Array::operator+=(const Array& other) {
-    if (areArraysCompatible(getDatatypeString(), other.getDatatypeString()) ) {
-        for(ArrayElement* el: other.elements) {
-            ArrayElement* new_el = getElement(el->getIndexes(), true);
-            *new_el += *el;
+size_t Array::memorySize() const {
+    size_t ret = arena.capacity();
+
+    // String keys are interned, they aren't charged to the array
+    for (ArrayElement* el: elements) {
+        const ValuePointer& value = el->getValue();
+
+        if (value.pvalue == NULL) {
+            continue;
+        }
+
+        switch(value.kind()) {
+            case 's':
+                ret += MemoryAccount::stringSize(*static_cast<const std::string*>(value.pvalue));
+                break;
+            case 'a':
+                ret += static_cast<const Array*>(value.pvalue)->memorySize();
+                break;
         }
     }
 
-    return *this;
+    return ret;
+}
+
+TypeId Array::getDatatype() const {
+    return datatype;
 }
 
 const std::vector<char>& Array::getIndexDatatypes() const {
-    return index_datatypes;
+    return TypeTable::instance().get(datatype).index_datatypes;
 }
 
-const std::string& Array::getElementDatatype() const {
-    return element_datatype;
+TypeId Array::getElementDatatype() const {
+    return TypeTable::instance().get(datatype).element_type;
 }
 
-void Array::setIndexDatatypes(const std::vector<char>& datatypes) {
-    index_datatypes = datatypes;
+void Array::setDatatype(TypeId datatype) {
+    this->datatype = datatype;
 }
-void Array::setElementDatatype(const std::string& datatype) {
-    element_datatype = datatype;
+
+// Hashes index values as the array's index datatypes, so an int key of a float index
+// gets the same hash as the equal float key
+size_t Array::hashIndexes(const ValuePointer* indexes) const {
+    const std::vector<char>& index_datatypes = getIndexDatatypes();
+    size_t ret = 0;
+
+    for (int i=0; i<index_datatypes.size(); i++) {
+        size_t h = 0;
+
+        switch(index_datatypes[i]) {
+            case 'i':
+                h = std::hash<long long int>()(*(long long int*)(indexes[i].pvalue));
+                break;
+            case 'f':
+                if (indexes[i].kind() == 'i') {
+                    h = std::hash<long double>()((long double)*(long long int*)(indexes[i].pvalue));
+                } else {
+                    h = std::hash<long double>()(*(long double*)(indexes[i].pvalue));
+                }
+                break;
+            case 'b':
+                h = std::hash<bool>()(*(bool*)(indexes[i].pvalue));
+                break;
+            case 's':
+                h = std::hash<const void*>()(indexes[i].pvalue); // Interned
+                break;
+        }
+
+        ret ^= h + 0x9e3779b9 + (ret << 6) + (ret >> 2);
+    }
+
+    return ret;
+}
+
+void Array::buildIndex() {
+    element_index.clear();
+    element_index.reserve(elements.size());
+
+    for (ArrayElement* el : elements) {
+        element_index.emplace(hashIndexes(el->getIndexes()), el);
+    }
+
+    is_indexed = true;
+}
+
+// String keys in 'indexes' must be interned
+ArrayElement* Array::findElement(const ValuePointer* indexes) {
+    if (!is_indexed && elements.size() >= INDEX_THRESHOLD) {
+        buildIndex();
+    }
+
+    if (is_indexed) {
+        auto range = element_index.equal_range(hashIndexes(indexes));
+
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second->checkIndexes(indexes)) {
+                return it->second;
+            }
+        }
+    } else {
+        for (int i=0; i<elements.size(); i++) {
+            if (elements[i]->checkIndexes(indexes)) {
+                return elements[i];
+            }
+        }
+    }
+
+    return NULL;
 }
 
 // Search for the element with given index values
 // If doesn't exists then create it and return it's address
 ArrayElement* Array::getElement(const std::vector<ValuePointer>& indexes, bool create) {
+    return getElement(indexes.data(), create);
+}
 
-    for (int i=0; i<elements.size(); i++) {
-        int s = indexes.size();
-        if (elements[i]->checkIndexes(indexes)) {
-            return elements[i];
+// 'indexes' must hold as many values as the array has index datatypes
+ArrayElement* Array::getElement(const ValuePointer* indexes, bool create) {
+    // Replace string keys with their interned copies so they can be compared by pointer.
+    // A key which has never been interned can't be used by any element.
+    std::vector<ValuePointer> search_indexes(indexes, indexes + getIndexDatatypes().size());
+    bool is_known_key = true;
+
+    for (int i=0; i<search_indexes.size(); i++) {
+        if (search_indexes[i].kind() == 's') {
+            const std::string* interned = StringTable::instance().find(*(const std::string*)search_indexes[i].pvalue);
+
+            if (interned == NULL) {
+                is_known_key = false;
+                break;
+            }
+
+            search_indexes[i].pvalue = (void*)interned;
+        }
+    }
+
+    if (is_known_key) {
+        ArrayElement* el = findElement(search_indexes.data());
+
+        if (el != NULL) {
+            return el;
         }
     }
 
@@ -562,9 +639,15 @@ ArrayElement* Array::getElement(const std::vector<ValuePointer>& indexes, bool c
         return NULL;
     }
 
-    // Create the empty element
+    return createElement(indexes);
+}
 
-    ArrayElement* new_element = new ArrayElement();
+// Creates the element with given index values and the default value
+ArrayElement* Array::createElement(const ValuePointer* indexes) {
+    const TypeDescriptor& descriptor = TypeTable::instance().get(datatype);
+    const std::vector<char>& index_datatypes = descriptor.index_datatypes;
+
+    ArrayElement* new_element = arena.create<ArrayElement>(&arena, (unsigned int)index_datatypes.size());
 
     // Create indexes for the new element
     for (int i=0; i<index_datatypes.size(); i++) {
@@ -573,7 +656,11 @@ ArrayElement* Array::getElement(const std::vector<ValuePointer>& indexes, bool c
                 new_element->addIndex(*(long long int*)(indexes[i].pvalue));
                 break;
             case 'f':
-                new_element->addIndex(*(long double*)(indexes[i].pvalue));
+                if (indexes[i].kind() == 'i') {
+                    new_element->addIndex((long double)*(long long int*)(indexes[i].pvalue));
+                } else {
+                    new_element->addIndex(*(long double*)(indexes[i].pvalue));
+                }
                 break;
             case 'b':
                 new_element->addIndex(*(bool*)(indexes[i].pvalue));
@@ -587,7 +674,7 @@ ArrayElement* Array::getElement(const std::vector<ValuePointer>& indexes, bool c
     // Add an empty value to the new element
     void* p_var = NULL;
 
-    switch (element_datatype[0]) {
+    switch (TypeTable::kind(descriptor.element_type)) {
         case 'i':
             p_var = new_element->setValue((long long int)0);
             break;
@@ -600,31 +687,17 @@ ArrayElement* Array::getElement(const std::vector<ValuePointer>& indexes, bool c
         case 's':
             p_var = new_element->setValue(std::string());
             break;
-        case 'a': {
-            std::vector<char> subelement_index_datatypes;
-            int i;
-            int s_size = element_datatype.size();
-            // Get index datatypes
-            for(i=3; i<s_size; i++) {
-                char c = element_datatype[i];
-
-                if (c == ']') {
-                    i+=2; // Skip ']' and following ' '
-                    break;
-                }
-                if (c == ',') continue;
-                subelement_index_datatypes.push_back(c);
-            }
-            // Get element datatype
-            std::string subelement_datatype = std::string(element_datatype.substr(i)); // right(s_size - i));
-            p_var = new_element->setValue(element_datatype, Array(subelement_index_datatypes, subelement_datatype));
-
+        case 'a':
+            p_var = new_element->setValue(descriptor.element_type, Array(descriptor.element_type));
             break;
-        }
     } // ~switch
 
     elements.push_back(new_element);
 
+    if (is_indexed) {
+        element_index.emplace(hashIndexes(new_element->getIndexes()), new_element);
+    }
+
     return new_element;
 }
 
@@ -638,21 +711,18 @@ std::string Array::toString() const {
     return ret;
 }
 
-std::string Array::getDatatypeString() const {
-    std::string ret = "a [";
-    bool first = true;
-
-    for(char indx_type: index_datatypes) {
-        ret += (first ? "" : ",") + indx_type;
-        first = false;
-    }
+const std::string& Array::getDatatypeString() const {
+    return TypeTable::instance().getSignature(datatype);
+}
 
-    ret += "] " + element_datatype;
+bool Array::areArraysCompatible(TypeId datatype_id1, TypeId datatype_id2) {
+    if (datatype_id1 == datatype_id2)
+        return true;
 
-    return ret;
-}
+    // Different datatypes are still compatible if they differ only by int -> float promotions
+    const std::string& datatype1 = TypeTable::instance().getSignature(datatype_id1);
+    const std::string& datatype2 = TypeTable::instance().getSignature(datatype_id2);
 
-bool Array::areArraysCompatible(const std::string& datatype1, const std::string& datatype2) {
     if (datatype1.size() != datatype2.size())
         return false;
 
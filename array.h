@@ -3,6 +3,10 @@
 
 #include <string>
 #include <vector>
+#include <unordered_map>
+
+#include "typetable.h"
+#include "arena.h"
 
 class Array;
 
@@ -12,12 +16,15 @@ class Array;
 // It doesn't own the pvalue
 struct ValuePointer
 {
-    std::string datatype;
+    TypeId datatype;
     void* pvalue;
 
     ValuePointer();
-    ValuePointer(const std::string& datatype, void* pvalue);
+    ValuePointer(TypeId datatype, void* pvalue);
     ValuePointer(const ValuePointer& other);
+    ValuePointer& operator=(const ValuePointer& other);
+
+    char kind() const { return TypeTable::kind(datatype); }
 
     bool operator==(const ValuePointer& other);
     bool operator!=(const ValuePointer& other);
@@ -26,22 +33,26 @@ struct ValuePointer
     std::string toString() const;
 };
 
+// Array elements live in the arena of the owning array together with their index and value cells
 class ArrayElement
 {
 private:
-    std::vector<ValuePointer> indexes;
+    Arena* arena;
+    ValuePointer* indexes;
+    unsigned int indexes_count;     // The number of indexes added so far
+    unsigned int indexes_size;      // The number of index slots
     ValuePointer value;
 
 public:
-    ArrayElement();
-    ArrayElement(const ValuePointer& pval);
-    ArrayElement(const ArrayElement& other);
+    ArrayElement(Arena* arena, unsigned int indexes_size);
+    ArrayElement(Arena* arena, const ArrayElement& other);
+    ArrayElement(const ArrayElement& other) = delete;
     ~ArrayElement();
     bool operator==(const ArrayElement& other);
     bool operator!=(const ArrayElement& other);
     void clear();
     void clear_value();
-    void operator= (const ArrayElement& other);
+    void operator= (const ArrayElement& other) = delete;
     ArrayElement& operator+=(const ArrayElement& other);
     void addIndex(long long int idx);
     void addIndex(long double idx);
@@ -51,30 +62,45 @@ public:
     void* setValue(long double v);
     void* setValue(bool v);
     void* setValue(const std::string& v);
-    void* setValue(const std::string& datatype, const Array& v);
+    void* setValue(TypeId datatype, const Array& v);
     ValuePointer& getValue();
-    bool checkIndexes(const std::vector<ValuePointer>& search_indexes);
+    bool checkIndexes(const ValuePointer* search_indexes);
     std::string indexesToString() const;
     std::string valueToString() const;
     std::string toString() const;
-    const std::vector<ValuePointer>& getIndexes();
+    const ValuePointer* getIndexes() const;
+    unsigned int getIndexesCount() const;
 };
 
 class Array
 {
 private:
-    std::vector<char> index_datatypes;
-    std::string element_datatype;
+    TypeId datatype;    // The array datatype, e.g. "a [i,s] f". Index and element datatypes are taken from its descriptor.
     std::vector<ArrayElement*> elements;
+    Arena arena;        // Holds the elements with their indexes and values
+
+    // Elements by the hash of their indexes. Built once the array grows past INDEX_THRESHOLD
+    // elements or for a bulk operation, then maintained on every insertion.
+    static const size_t INDEX_THRESHOLD = 16;
+    std::unordered_multimap<size_t, ArrayElement*> element_index;
+    bool is_indexed;
+
+    size_t hashIndexes(const ValuePointer* indexes) const;
+    void buildIndex();
+    ArrayElement* findElement(const ValuePointer* indexes);
+    ArrayElement* createElement(const ValuePointer* indexes);
+    ArrayElement* getElement(const ValuePointer* indexes, bool create);
+    void merge(const Array& other);
 
 public:
     Array();
-    Array(const std::vector<char>& index_datatypes, const std::string& element_datatype);
+    Array(TypeId datatype);
     Array(const Array& other);
     ~Array();
-    void addElement(ArrayElement* element);
 
+    // Destroys the elements and frees the arena
     void clear();
+    // Destroys the elements. The arena memory is kept for reuse.
     void clearElements();
 
     void operator=(const Array& other);
@@ -83,22 +109,26 @@ public:
     Array operator+(const Array& other);
     Array& operator+=(const Array& other);
 
+    TypeId getDatatype() const;
     const std::vector<char>& getIndexDatatypes() const;
-    const std::string& getElementDatatype() const;
+    TypeId getElementDatatype() const;
 
-    void setIndexDatatypes(const std::vector<char>& datatypes);
-    void setElementDatatype(const std::string& datatype);
+    void setDatatype(TypeId datatype);
 
     const std::vector<ArrayElement*> getElements() const;
 
+    // The memory charged for the array: its arena, the buffers of its string values and its nested arrays.
+    // A copy of the array takes about as much.
+    size_t memorySize() const;
+
     // Search for the element with given index values
     // If doesn't exists then create it and return it's address
     ArrayElement* getElement(const std::vector<ValuePointer>& indexes, bool create=true);
 
     std::string toString() const;
 
-    std::string getDatatypeString() const;
-    static bool areArraysCompatible(const std::string& datatype1, const std::string& datatype2);
+    const std::string& getDatatypeString() const;
+    static bool areArraysCompatible(TypeId datatype1, TypeId datatype2);
 };
 
 
@@ -0,0 +1,84 @@
+#include "benchmark.h"
+#include "tokenizer.h"
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+
+// The nanoseconds per classification of all 'identifiers' 'rounds' times. 'checksum' keeps the calls from being optimized away.
+template<typename Classify>
+static double timeClassification(const std::vector<std::string>& identifiers, unsigned int rounds, Classify classify, unsigned long long& checksum)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    for (unsigned int round=0; round<rounds; round++) {
+        for (const std::string& identifier: identifiers) {
+            checksum += static_cast<unsigned int>(classify(identifier));
+        }
+    }
+
+    double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    size_t calls = identifiers.size() * rounds;
+
+    return calls > 0 ? ns / calls : 0.0;
+}
+
+/*******************************************
+ * struct KeywordBenchmarkReport
+ *******************************************/
+
+std::string KeywordBenchmarkReport::toString() const
+{
+    std::ostringstream s;
+
+    s << std::fixed << std::setprecision(2);
+    s << identifiers << " identifiers, " << rounds << " rounds" << std::endl;
+    s << "perfect hash " << hash_ns << " ns, linear scan " << scan_ns << " ns per identifier";
+    if (hash_ns > 0) {
+        s << " (" << scan_ns / hash_ns << "x)";
+    }
+    s << std::endl;
+    s << mismatches << " mismatches" << std::endl;
+
+    return s.str();
+}
+
+/*******************************************
+ * class Benchmark
+ *******************************************/
+
+KeywordBenchmarkReport Benchmark::keywords(const std::vector<std::string>& scripts, unsigned int rounds)
+{
+    KeywordBenchmarkReport report;
+    std::vector<std::string> identifiers;
+
+    for (const std::string& script: scripts) {
+        Tokenizer tokenizer;
+
+        tokenizer.tokenize(script);
+
+        for (const Token& token: tokenizer.getTokens()) {
+            if (token.type == ETokenType::IDENTIFIER) {
+                identifiers.push_back(tokenizer.getText(token));
+            }
+        }
+    }
+
+    for (const std::string& identifier: identifiers) {
+        if (Tokenizer::keyword(identifier) != Tokenizer::keywordByScan(identifier)) {
+            report.mismatches++;
+        }
+    }
+
+    unsigned long long hash_checksum = 0, scan_checksum = 0;
+
+    report.identifiers = identifiers.size();
+    report.rounds = rounds;
+    report.scan_ns = timeClassification(identifiers, rounds, Tokenizer::keywordByScan, scan_checksum);
+    report.hash_ns = timeClassification(identifiers, rounds, Tokenizer::keyword, hash_checksum);
+
+    if (hash_checksum != scan_checksum) {
+        report.mismatches++;
+    }
+
+    return report;
+}
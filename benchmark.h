@@ -0,0 +1,27 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <string>
+#include <vector>
+
+struct KeywordBenchmarkReport
+{
+    size_t identifiers{ 0 };        // Identifier tokens of the scripts, classified in every round
+    unsigned int rounds{ 0 };
+    double hash_ns{ 0 };            // Per identifier, Tokenizer::keyword
+    double scan_ns{ 0 };            // Per identifier, Tokenizer::keywordByScan
+    size_t mismatches{ 0 };         // Identifiers the two classify differently
+
+    std::string toString() const;
+};
+
+// Microbenchmarks of the compiler run from the command line
+class Benchmark
+{
+public:
+    // Times the keyword classification of the identifiers of the 'scripts' by the perfect hash against the
+    // linear scan of the keywords and checks that both agree on every identifier
+    static KeywordBenchmarkReport keywords(const std::vector<std::string>& scripts, unsigned int rounds);
+};
+
+#endif // BENCHMARK_H
@@ -1,29 +1,31 @@
 #include "bytecode.h"
+#include "memoryaccount.h"
+#include <iomanip>
 
 
 /*******************************************
  * class Datatype
  *******************************************/
-Datatype::Datatype() : variableType(EVariableTypes::UNDEFINED), name(NULL), scope(NULL), datatype(NULL), funParamDatatype(NULL), address(NULL), function_ref(-1), dynamic_idx(-1) {}
-Datatype::Datatype(const char* name, const char* scope, const char* datatype, EVariableTypes variableType) : variableType(variableType), name(NULL), scope(NULL), datatype(NULL), funParamDatatype(NULL), address(NULL), function_ref(-1), dynamic_idx(-1) {
+Datatype::Datatype() : variableType(EVariableTypes::UNDEFINED), name(NULL), scope(NULL), datatype(NULL), type_id(TYPE_UNDEFINED), funParamDatatype(NULL), address(NULL), function_ref(-1), dynamic_idx(-1) {}
+Datatype::Datatype(const char* name, const char* scope, const char* datatype, EVariableTypes variableType) : variableType(variableType), name(NULL), scope(NULL), datatype(NULL), type_id(TYPE_UNDEFINED), funParamDatatype(NULL), address(NULL), function_ref(-1), dynamic_idx(-1) {
     setName(name);
     setScope(scope);
     setDatatype(datatype);
 }
 Datatype::Datatype(const char* name, const char* scope, const char* datatype, unsigned int dynamic_idx, EVariableTypes variableType) : 
-                                    variableType(variableType), name(NULL), scope(NULL), datatype(NULL), funParamDatatype(NULL), address(NULL), function_ref(-1), dynamic_idx(dynamic_idx) {
+                                    variableType(variableType), name(NULL), scope(NULL), datatype(NULL), type_id(TYPE_UNDEFINED), funParamDatatype(NULL), address(NULL), function_ref(-1), dynamic_idx(dynamic_idx) {
     setName(name);
     setScope(scope);
     setDatatype(datatype);
 }
 Datatype::Datatype(const char* name, const char* scope, const char* datatype, const char* funParamDatatype, EVariableTypes variableType, int function_ref) : 
-                                    variableType(variableType), name(NULL), scope(NULL), datatype(NULL), funParamDatatype(NULL), address(NULL), function_ref(function_ref), dynamic_idx(-1) {
+                                    variableType(variableType), name(NULL), scope(NULL), datatype(NULL), type_id(TYPE_UNDEFINED), funParamDatatype(NULL), address(NULL), function_ref(function_ref), dynamic_idx(-1) {
     setName(name);
     setScope(scope);
     setDatatype(datatype);
     setFunParamDatatype(funParamDatatype);
 }
-Datatype::Datatype(const Datatype& other) : name(NULL), scope(NULL), datatype(NULL), funParamDatatype(NULL), address(NULL) {
+Datatype::Datatype(const Datatype& other) : name(NULL), scope(NULL), datatype(NULL), type_id(TYPE_UNDEFINED), funParamDatatype(NULL), address(NULL) {
     variableType = other.variableType;
     function_ref = other.function_ref;
     setName(other.getName());
@@ -68,6 +70,7 @@ void Datatype::setDatatype(const char* datatype) {
         size_t new_size = strlen(datatype)+1;
         this->datatype = (char*)realloc((void*)this->datatype, new_size);
         strcpy_s(this->datatype, new_size, datatype);
+        type_id = TypeTable::instance().getTypeId(datatype);
     }
 }
 
@@ -91,6 +94,10 @@ const char* Datatype::getDatatype() const {
     return datatype;
 }
 
+TypeId Datatype::getTypeId() const {
+    return type_id;
+}
+
 const char* Datatype::getFunParamDatatype() const {
     return funParamDatatype;
 }
@@ -104,29 +111,19 @@ void* Datatype::makeDynamicAddress() {
 
     if (datatype[0] == 'i') {
         ret = new long long int;
+        MemoryAccount::charge(sizeof(long long int));
     } else if (datatype[0] == 'f') {
         ret = new long double;
+        MemoryAccount::charge(sizeof(long double));
     } else if (datatype[0] == 's') {
         ret = new std::string;
+        MemoryAccount::charge(sizeof(std::string));
     } else if (datatype[0] == 'b') {
         ret = new unsigned char;
+        MemoryAccount::charge(sizeof(unsigned char));
     } else if (datatype[0] == 'a') {
-        std::vector<char> index_datatypes;
-        int i;
-        // Get index datatypes
-        for(i=3; i<strlen(datatype); i++) {
-            unsigned char c = datatype[i];
-
-            if (c == ']') {
-                i+=2; // Skip ']' and following ' '
-                break;
-            }
-            if (c == ',') continue;
-            index_datatypes.push_back(c);
-        }
-        // Get element datatype
-        std::string element_datatype = std::string(datatype+i);
-        ret = new Array(index_datatypes, element_datatype);
+        ret = new Array(type_id);
+        MemoryAccount::charge(sizeof(Array));
     }
 
     return ret;
@@ -160,34 +157,49 @@ void* Datatype::getAddress() {
 }
 
 void Datatype::disposeAddress() {
-    if (strcmp(datatype, "i") == 0) {
+    if (address == NULL) {
+        return;
+    }
+
+    if (datatype[0] == 'i') {
         delete static_cast<long long int*>(address);
-    } else if (strcmp(datatype, "f") == 0) {
+        MemoryAccount::credit(sizeof(long long int));
+    } else if (datatype[0] == 'f') {
         delete static_cast<long double*>(address);
-    } else if (strcmp(datatype, "s") == 0) {
+        MemoryAccount::credit(sizeof(long double));
+    } else if (datatype[0] == 's') {
+        MemoryAccount::credit(sizeof(std::string) + MemoryAccount::stringSize(*static_cast<std::string*>(address)));
         delete static_cast<std::string*>(address);
-    } else if (strcmp(datatype, "b") == 0) {
+    } else if (datatype[0] == 'b') {
         delete static_cast<unsigned char*>(address);
-    } else if (strcmp(datatype, "a") == 0) {
+        MemoryAccount::credit(sizeof(unsigned char));
+    } else if (datatype[0] == 'a') {
         delete static_cast<Array*>(address);
+        MemoryAccount::credit(sizeof(Array));
     }
 
     address = NULL;
 }
 
-void Datatype::printVariable()
+void Datatype::printVariable(std::ostream& s)
 {
     if (variableType == EVariableTypes::VARIABLE) {
         if (datatype[0] == 'i') {
-            printf("[%s]: %lld\n", datatype, *static_cast<long long int*>(address));
+            s << "[" << datatype << "]: " << *static_cast<long long int*>(address) << "\n";
         } else if (datatype[0] == 'f') {
-            printf("[%s]: %LF\n", datatype, *static_cast<long double*>(address));
+            std::ios_base::fmtflags flags = s.flags();
+            std::streamsize precision = s.precision();
+
+            // Like printf's %LF
+            s << "[" << datatype << "]: " << std::fixed << std::uppercase << std::setprecision(6) << *static_cast<long double*>(address) << "\n";
+            s.flags(flags);
+            s.precision(precision);
         } else if (datatype[0] == 's') {
-            printf("[%s]: %s\n", datatype, (*static_cast<std::string*>(address)).data());
+            s << "[" << datatype << "]: " << (*static_cast<std::string*>(address)).data() << "\n";
         } else if (datatype[0] == 'b') {
-            printf("[%s]: %u\n", datatype, (unsigned int)*static_cast<unsigned char*>(address));
+            s << "[" << datatype << "]: " << (unsigned int)*static_cast<unsigned char*>(address) << "\n";
         } else if (datatype[0] == 'a') {
-            printf("[%s]: %s\n", datatype, (*static_cast<Array*>(address)).toString().data());
+            s << "[" << datatype << "]: " << (*static_cast<Array*>(address)).toString() << "\n";
         }
     }
 }
@@ -209,6 +221,124 @@ unsigned int Datatype::getCallStackPos() {
 }
 
 
-Bytecode::Bytecode()
+Bytecode::Bytecode() : code_size(0), is_linked(true)
+{
+}
+
+std::vector<unsigned char>& Bytecode::addChunk()
+{
+    chunks.push_back(std::vector<unsigned char>());
+    chunks.back().reserve(CHUNK_SIZE + 16);
+
+    return chunks.back();
+}
+
+Bytecode& Bytecode::operator+=(Bytecode& other)
+{
+    unsigned int label_base = labels.size();
+
+    for (unsigned int label_pos : other.labels) {
+        labels.push_back(label_pos == UNBOUND_LABEL ? UNBOUND_LABEL : label_pos + code_size);
+    }
+
+    for (const Relocation& r : other.relocations) {
+        relocations.push_back(Relocation(r.pos + code_size, r.label + label_base));
+    }
+
+    for (const FunctionRef& f : other.function_refs) {
+        function_refs.push_back(FunctionRef(f.variable_index, f.function_pos + code_size));  // Add updated function reference
+    }
+
+    // Move code
+    if (!other.code.empty()) {
+        chunks.push_back(std::move(other.code));
+    }
+    chunks.splice(chunks.end(), other.chunks);
+
+    code_size += other.code_size;
+    is_linked = is_linked && other.code_size == 0 && other.relocations.empty();
+
+    other.code.clear();
+    other.code_size = 0;
+    other.is_linked = true;
+    other.labels.clear();
+    other.relocations.clear();
+    other.function_refs.clear();
+
+    return *this;
+}
+
+void Bytecode::link()
 {
+    for (const std::vector<unsigned char>& chunk : chunks) {
+        code.insert(code.end(), chunk.begin(), chunk.end());
+    }
+    chunks.clear();
+
+    for (const Relocation& r : relocations) {
+        unsigned int addr = labels[r.label] == UNBOUND_LABEL ? 0 : labels[r.label];
+
+        memcpy(&code[r.pos], &addr, 4);
+    }
+
+    is_linked = true;
+}
+
+void Bytecode::compact()
+{
+    if (!is_linked) {
+        link();
+    }
+
+    code.shrink_to_fit();
+    labels.shrink_to_fit();
+    relocations.shrink_to_fit();
+    function_refs.shrink_to_fit();
+}
+
+size_t Bytecode::getMemoryEstimate() const
+{
+    size_t size = sizeof(Bytecode) + code.capacity();
+
+    for (const std::vector<unsigned char>& chunk : chunks) {
+        size += chunk.capacity();
+    }
+
+    size += labels.capacity() * sizeof(unsigned int) + relocations.capacity() * sizeof(Relocation);
+    size += function_refs.capacity() * sizeof(FunctionRef) + variables.capacity() * sizeof(Datatype);
+
+    return size;
+}
+
+void Bytecode::relocateVariables(unsigned int first, unsigned int offset)
+{
+    if (offset == 0) {
+        return;
+    }
+
+    link();
+
+    unsigned int i = 0;
+    while (i < code.size()) {
+        unsigned int operand = i + 1;
+        InstrOperand layout = getInstrOperand(&code[i]);
+
+        if (layout.is_variable) {
+            unsigned int idx;
+
+            memcpy(&idx, &code[operand], 4);
+            if (idx >= first) {
+                idx += offset;
+                memcpy(&code[operand], &idx, 4);
+            }
+        }
+
+        i = operand + layout.size;
+    }
+
+    for (FunctionRef& f : function_refs) {
+        if (f.variable_index >= first) {
+            f.variable_index += offset;
+        }
+    }
 }
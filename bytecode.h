@@ -4,7 +4,9 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <list>
 #include <fstream>
+#include <sstream>
 #include <iostream>
 #include <string.h>
 #include <errno.h>
@@ -58,6 +60,47 @@ enum EInstrCodes {
                             // Used allocating and initializing function parameters. This statement must be provided in a sequence revert to the actual parameter values provided to the stack. Variables created on the call-stack have to be created in one-more-time reverted order.
 };
 
+// The operand of an instruction: the bytes following the opcode and whether they start with a variable index
+// from the DATA section. The walks over the code (the listing, the relocation of variables) step with it,
+// so it has to follow the emitters of class Bytecode.
+struct InstrOperand
+{
+    unsigned int size;
+    bool is_variable;
+};
+
+// 'instr' points to the opcode in the code
+inline InstrOperand getInstrOperand(const unsigned char* instr)
+{
+    switch (*instr) {
+        case EInstrCodes::PUTADDR:
+        case EInstrCodes::PUTDADDR:
+        case EInstrCodes::CALL:
+        case EInstrCodes::INITVAR:
+        case EInstrCodes::ALLOCVAR:
+        case EInstrCodes::ALLOCVARS:
+        case EInstrCodes::RETURN:
+            return { 4, true };
+        case EInstrCodes::SYSCALL:  // The parameter index, then the function name
+            return { (unsigned int)(4 + strlen((const char*)instr + 5) + 1), true };
+        case EInstrCodes::PUTMEMBERADDR:
+        case EInstrCodes::JUMPIFFALSE:
+        case EInstrCodes::JUMP:
+            return { 4, false };
+        case EInstrCodes::PUTINDADDR:
+        case EInstrCodes::PUTBOOLEAN:
+            return { 1, false };
+        case EInstrCodes::PUTINT:
+            return { 8, false };
+        case EInstrCodes::PUTFLOAT:
+            return { 12, false };
+        case EInstrCodes::PUTSTRING:
+            return { (unsigned int)(strlen((const char*)instr + 1) + 1), false };
+        default:
+            return { 0, false };
+    }
+}
+
 class Datatype
 {
 public:
@@ -65,6 +108,7 @@ public:
 private:
     enum EVariableTypes variableType;
     char* datatype;
+    TypeId type_id; // interned id of 'datatype'
     char* funParamDatatype;
     void* address;
     int function_ref; // function address in the code
@@ -88,13 +132,14 @@ public:
     const char* getName() const;
     const char* getScope() const;
     const char* getDatatype() const;
+    TypeId getTypeId() const;
     const char* getFunParamDatatype() const;
     enum EVariableTypes getVariableType() const;
     void* makeAddress();
     void* makeDynamicAddress();
     void* getAddress();
     void disposeAddress();
-    void printVariable();
+    void printVariable(std::ostream& s);
     unsigned int getFunRef() const;
     unsigned int getDynamicIdx() const;
     void setToDefault();
@@ -111,70 +156,122 @@ struct FunctionRef
     }
 };
 
+// The code is emitted into a list of chunks. Appending a Bytecode moves its chunks instead of copying the code.
+// Jumps refer to labels. 'link' joins the chunks and writes the label addresses into the jump instructions.
 class Bytecode
 {
 private:
+    static constexpr unsigned int CHUNK_SIZE = 256;
+    static constexpr unsigned int UNBOUND_LABEL = (unsigned int)-1;
+
+    struct Relocation
+    {
+        unsigned int pos;       // Position of the 4-byte address operand
+        unsigned int label;
+
+        Relocation(unsigned int pos, unsigned int label) : pos(pos), label(label) {
+        }
+    };
+
     std::vector<Datatype> variables;
-    std::vector<unsigned char> code;
-    std::vector<unsigned int> jumps;
+    std::vector<unsigned char> code;                // Linked code
+    std::list<std::vector<unsigned char>> chunks;   // Code emitted since the last link
+    unsigned int code_size;                         // The size of the linked and not linked code
+    bool is_linked;
+    std::vector<unsigned int> labels;               // Label positions in the code
+    std::vector<Relocation> relocations;
     std::vector<FunctionRef> function_refs;
 
+    void link();
+    std::vector<unsigned char>& addChunk();
+
+    // Returns the position of the instruction
+    unsigned int emit(unsigned char instr) {
+        std::vector<unsigned char>& chunk = (chunks.empty() || chunks.back().size() >= CHUNK_SIZE) ? addChunk() : chunks.back();
+
+        chunk.push_back(instr);
+        is_linked = false;
+
+        return code_size++;
+    }
+
+    void emitBytes(const void* val, unsigned int size) {
+        const unsigned char* bytes = (const unsigned char*)val;
+        std::vector<unsigned char>& chunk = chunks.back(); // Operands follow their instruction in the same chunk
+
+        chunk.insert(chunk.end(), bytes, bytes + size);
+        code_size += size;
+    }
+
+    void emitString(const char* val) {
+        emitBytes(val, strlen(val) + 1);
+    }
+
+    void emitJump(unsigned char instr, unsigned int label) {
+        unsigned int addr = 0;
+
+        emit(instr);
+        relocations.push_back(Relocation(code_size, label));
+        emitBytes(&addr, 4);
+    }
+
+    // The variable index of a listed instruction with the name of the variable
+    void printVariableOperand(std::ostream& s, const unsigned char* operand) {
+        unsigned int addr;
+
+        memcpy(&addr, operand, 4);
+
+        const Datatype& v = variables.at(addr);
+
+        s << addr << "\t\t; " << v.getScope() << "." << v.getName() << std::endl;
+    }
+
 public:
     Bytecode();
     void clear() {
         variables.clear();
         code.clear();
-        jumps.clear();
+        chunks.clear();
+        code_size = 0;
+        is_linked = true;
+        labels.clear();
+        relocations.clear();
         function_refs.clear();
     }
     
-    std::vector<unsigned char>& getCode() { return code; }
+    std::vector<unsigned char>& getCode() {
+        if (!is_linked) {
+            link();
+        }
+        return code;
+    }
     std::vector<Datatype>& getVariables() { return variables; }
 
-    Bytecode& operator+=(Bytecode& other) {
-        std::vector<unsigned int>::iterator i_jumps;
-        std::vector<FunctionRef>::iterator i_funs;
-        unsigned int addr;
-        unsigned char* paddr = (unsigned char*)&addr;
-        unsigned int code_size = code.size();
-        
-        // Adjust addresses
-        for (i_jumps = other.jumps.begin(); i_jumps < other.jumps.end(); i_jumps++) {
-            unsigned int j = *i_jumps;
-
-            jumps.push_back(j+code_size);  // Add updated jump addresses
-
-            *paddr = other.code[j];
-            *(paddr+1) = other.code[j+1];
-            *(paddr+2) = other.code[j+2];
-            *(paddr+3) = other.code[j+3];
-
-            addr += code_size;
-
-            other.code[j] = *paddr;
-            other.code[j+1] = *(paddr+1);
-            other.code[j+2] = *(paddr+2);
-            other.code[j+3] = *(paddr+3);
-        }
+    unsigned int size() const { return code_size; }
 
-        for (i_funs = other.function_refs.begin(); i_funs < other.function_refs.end(); i_funs++) {
-            function_refs.push_back(FunctionRef(i_funs->variable_index, i_funs->function_pos+code_size));  // Add updated function reference
-        }
+    // Links the code and frees the spare capacity, e.g. before the bytecode is kept as a compiled program
+    void compact();
+    // The approximate memory of the code and its tables (bytes)
+    size_t getMemoryEstimate() const;
 
-        // Move code
-        code.insert(
-            code.end(),
-            std::make_move_iterator(other.code.begin()),
-            std::make_move_iterator(other.code.end())
-        );
+    // Appends the code of 'other' and moves its labels, jumps and function references. 'other' is left without code.
+    // Labels of 'other' must be bound before.
+    Bytecode& operator+=(Bytecode& other);
 
-        return *this;
+    unsigned int newLabel() {
+        labels.push_back(UNBOUND_LABEL);
+        return labels.size()-1;
     }
 
-    void addJump(unsigned int addr) {
-        jumps.push_back(addr);
+    // Binds the label to the current end of the code
+    void setLabel(unsigned int label) {
+        labels[label] = code_size;
+        is_linked = false;
     }
 
+    // Adds 'offset' to the variable indexes from 'first' on, used by instructions and function references
+    void relocateVariables(unsigned int first, unsigned int offset);
+
     void addFunction(unsigned int fun_var_pos, unsigned int fun_code_pos) {
         function_refs.push_back(FunctionRef(fun_var_pos, fun_code_pos));
     }
@@ -183,13 +280,6 @@ public:
         return function_refs;
     }
 
-    void setAddress(unsigned int pos, unsigned int val) { 
-        void* addr = (void*)&val;
-        code[pos]   = ( *((unsigned char*)addr) );
-        code[pos+1] = ( *((unsigned char*)addr+1) );
-        code[pos+2] = ( *((unsigned char*)addr+2) );
-        code[pos+3] = ( *((unsigned char*)addr+3) );
-    }
     unsigned int DATA(const char* name, const char* scope, const char* datatype) {
         variables.push_back(Datatype(name, scope, datatype, Datatype::EVariableTypes::VARIABLE));
         return variables.size()-1;
@@ -199,33 +289,18 @@ public:
         return variables.size()-1;
     }
     unsigned int INITVAR(unsigned int index) {
-        code.push_back(EInstrCodes::INITVAR);
-        unsigned int pos = code.size()-1;
-        void* addr = (void*)&index;
-        code.push_back( *((unsigned char*)addr) );
-        code.push_back( *((unsigned char*)addr+1) );
-        code.push_back( *((unsigned char*)addr+2) );
-        code.push_back( *((unsigned char*)addr+3) );
+        unsigned int pos = emit(EInstrCodes::INITVAR);
+        emitBytes(&index, 4);
         return pos;
     }
     unsigned int ALLOCVAR(unsigned int index) {
-        code.push_back(EInstrCodes::ALLOCVAR);
-        unsigned int pos = code.size()-1;
-        void* addr = (void*)&index;
-        code.push_back( *((unsigned char*)addr) );
-        code.push_back( *((unsigned char*)addr+1) );
-        code.push_back( *((unsigned char*)addr+2) );
-        code.push_back( *((unsigned char*)addr+3) );
+        unsigned int pos = emit(EInstrCodes::ALLOCVAR);
+        emitBytes(&index, 4);
         return pos;
     }
     unsigned int ALLOCVARS(unsigned int index) {
-        code.push_back(EInstrCodes::ALLOCVARS);
-        unsigned int pos = code.size()-1;
-        void* addr = (void*)&index;
-        code.push_back( *((unsigned char*)addr) );
-        code.push_back( *((unsigned char*)addr+1) );
-        code.push_back( *((unsigned char*)addr+2) );
-        code.push_back( *((unsigned char*)addr+3) );
+        unsigned int pos = emit(EInstrCodes::ALLOCVARS);
+        emitBytes(&index, 4);
         return pos;
     }
     unsigned int FUN(const char* name, const char* scope, const char* datatype, const char* funParamDatatype, int function_ref) {
@@ -233,175 +308,101 @@ public:
 
         return variables.size()-1;
     }
-    unsigned int NOP() { code.push_back(EInstrCodes::NOP); return code.size()-1; }
+    unsigned int NOP() { return emit(EInstrCodes::NOP); }
     unsigned int PUTADDR(unsigned int index) { 
-        code.push_back(EInstrCodes::PUTADDR);
-        unsigned int pos = code.size()-1;
-        void* addr = (void*)&index;
-        code.push_back( *((unsigned char*)addr) );
-        code.push_back( *((unsigned char*)addr+1) );
-        code.push_back( *((unsigned char*)addr+2) );
-        code.push_back( *((unsigned char*)addr+3) );
+        unsigned int pos = emit(EInstrCodes::PUTADDR);
+        emitBytes(&index, 4);
         return pos;
     }
     unsigned int PUTDADDR(unsigned int index) { 
-        code.push_back(EInstrCodes::PUTDADDR);
-        unsigned int pos = code.size()-1;
-        void* addr = (void*)&index;
-        code.push_back( *((unsigned char*)addr) );
-        code.push_back( *((unsigned char*)addr+1) );
-        code.push_back( *((unsigned char*)addr+2) );
-        code.push_back( *((unsigned char*)addr+3) );
+        unsigned int pos = emit(EInstrCodes::PUTDADDR);
+        emitBytes(&index, 4);
         return pos;
     }
     unsigned int CALL(unsigned int index) { 
-        code.push_back(EInstrCodes::CALL);
-        unsigned int pos = code.size()-1;
-        void* addr = (void*)&index;
-        code.push_back( *((unsigned char*)addr) );
-        code.push_back( *((unsigned char*)addr+1) );
-        code.push_back( *((unsigned char*)addr+2) );
-        code.push_back( *((unsigned char*)addr+3) );
+        unsigned int pos = emit(EInstrCodes::CALL);
+        emitBytes(&index, 4);
         return pos;
     }
     unsigned int PUTINDADDR(unsigned char index_count) {
-        code.push_back(EInstrCodes::PUTINDADDR);
-        unsigned int pos = code.size()-1;
-        void* addr = (void*)&index_count;
-        code.push_back( *((unsigned char*)addr) );
+        unsigned int pos = emit(EInstrCodes::PUTINDADDR);
+        emitBytes(&index_count, 1);
         return pos;
     }
     // TODO: needs to be revised
     unsigned int PUTMEMBERADDR(unsigned int index) {
-        code.push_back(EInstrCodes::PUTMEMBERADDR);
-        unsigned int pos = code.size()-1;
-        void* addr = (void*)&index;
-        code.push_back( *((unsigned char*)addr) );
-        code.push_back( *((unsigned char*)addr+1) );
-        code.push_back( *((unsigned char*)addr+2) );
-        code.push_back( *((unsigned char*)addr+3) );
+        unsigned int pos = emit(EInstrCodes::PUTMEMBERADDR);
+        emitBytes(&index, 4);
         return pos;
     }
     unsigned int PUTINT(long long int val) {
-        code.push_back(EInstrCodes::PUTINT);
-        unsigned int pos = code.size()-1;
-        void* addr = (void*)&val;
-        code.push_back( *((unsigned char*)addr) );
-        code.push_back( *((unsigned char*)addr+1) );
-        code.push_back( *((unsigned char*)addr+2) );
-        code.push_back( *((unsigned char*)addr+3) );
-        code.push_back( *((unsigned char*)addr+4) );
-        code.push_back( *((unsigned char*)addr+5) );
-        code.push_back( *((unsigned char*)addr+6) );
-        code.push_back( *((unsigned char*)addr+7) );
+        unsigned int pos = emit(EInstrCodes::PUTINT);
+        emitBytes(&val, 8);
         return pos;
     }
     unsigned int PUTFLOAT(long double val) {
-        code.push_back(EInstrCodes::PUTFLOAT);
-        unsigned int pos = code.size()-1;
-        void* addr = (void*)&val;
-        code.push_back( *((unsigned char*)addr) );
-        code.push_back( *((unsigned char*)addr+1) );
-        code.push_back( *((unsigned char*)addr+2) );
-        code.push_back( *((unsigned char*)addr+3) );
-        code.push_back( *((unsigned char*)addr+4) );
-        code.push_back( *((unsigned char*)addr+5) );
-        code.push_back( *((unsigned char*)addr+6) );
-        code.push_back( *((unsigned char*)addr+7) );
-        code.push_back( *((unsigned char*)addr+8) );
-        code.push_back( *((unsigned char*)addr+9) );
-        code.push_back( *((unsigned char*)addr+10) );
-        code.push_back( *((unsigned char*)addr+11) );
+        unsigned int pos = emit(EInstrCodes::PUTFLOAT);
+        emitBytes(&val, 12);
         return pos;
     }
     // val: unicode bytearray
     unsigned int PUTSTRING(const char* val) {
-        code.push_back(EInstrCodes::PUTSTRING);
-        unsigned int pos = code.size()-1;
-        int i = 0;
-        do {
-            code.push_back( val[i] );
-        } while(val[i++] != 0);
+        unsigned int pos = emit(EInstrCodes::PUTSTRING);
+        emitString(val);
         return pos;
     }
     unsigned int PUTBOOLEAN(bool val) {
-        code.push_back(EInstrCodes::PUTBOOLEAN);
-        unsigned int pos = code.size()-1;
-        code.push_back(val ? (unsigned char)1 : (unsigned char)0);
+        unsigned int pos = emit(EInstrCodes::PUTBOOLEAN);
+        unsigned char b = val ? (unsigned char)1 : (unsigned char)0;
+        emitBytes(&b, 1);
         return pos;
     }
-    unsigned int MOVE() { code.push_back(EInstrCodes::MOVE); return code.size()-1; }
-    unsigned int MOVEADD() { code.push_back(EInstrCodes::MOVEADD); return code.size()-1; }
-    unsigned int MOVESUBTR() { code.push_back(EInstrCodes::MOVESUBTR); return code.size()-1; }
-    unsigned int MOVEMUL() { code.push_back(EInstrCodes::MOVEMUL); return code.size()-1; }
-    unsigned int MOVEDIV() { code.push_back(EInstrCodes::MOVEDIV); return code.size()-1; }
-    unsigned int EQUAL() { code.push_back(EInstrCodes::EQUAL); return code.size()-1; }
-    unsigned int NOTEQUAL() { code.push_back(EInstrCodes::NOTEQUAL); return code.size()-1; }
-    unsigned int LESSEQUAL() { code.push_back(EInstrCodes::LESSEQUAL); return code.size()-1; }
-    unsigned int GREATEREQUAL() { code.push_back(EInstrCodes::GREATEREQUAL); return code.size()-1; }
-    unsigned int LESS() { code.push_back(EInstrCodes::LESS); return code.size()-1; }
-    unsigned int GREATER() { code.push_back(EInstrCodes::GREATER); return code.size()-1; }
-    unsigned int JUMPIFFALSE(unsigned int val) { 
-        code.push_back(EInstrCodes::JUMPIFFALSE);
-        unsigned int pos = code.size()-1;
-        void* addr = (void*)&val;
-        code.push_back( *((unsigned char*)addr) );
-        code.push_back( *((unsigned char*)addr+1) );
-        code.push_back( *((unsigned char*)addr+2) );
-        code.push_back( *((unsigned char*)addr+3) );
+    unsigned int MOVE() { return emit(EInstrCodes::MOVE); }
+    unsigned int MOVEADD() { return emit(EInstrCodes::MOVEADD); }
+    unsigned int MOVESUBTR() { return emit(EInstrCodes::MOVESUBTR); }
+    unsigned int MOVEMUL() { return emit(EInstrCodes::MOVEMUL); }
+    unsigned int MOVEDIV() { return emit(EInstrCodes::MOVEDIV); }
+    unsigned int EQUAL() { return emit(EInstrCodes::EQUAL); }
+    unsigned int NOTEQUAL() { return emit(EInstrCodes::NOTEQUAL); }
+    unsigned int LESSEQUAL() { return emit(EInstrCodes::LESSEQUAL); }
+    unsigned int GREATEREQUAL() { return emit(EInstrCodes::GREATEREQUAL); }
+    unsigned int LESS() { return emit(EInstrCodes::LESS); }
+    unsigned int GREATER() { return emit(EInstrCodes::GREATER); }
+    // label: see 'newLabel'
+    unsigned int JUMPIFFALSE(unsigned int label) { 
+        unsigned int pos = code_size;
+        emitJump(EInstrCodes::JUMPIFFALSE, label);
         return pos;
     }
-    unsigned int JUMP(unsigned int val) { 
-        code.push_back(EInstrCodes::JUMP);
-        unsigned int pos = code.size()-1;
-        void* addr = (void*)&val;
-        code.push_back( *((unsigned char*)addr) );
-        code.push_back( *((unsigned char*)addr+1) );
-        code.push_back( *((unsigned char*)addr+2) );
-        code.push_back( *((unsigned char*)addr+3) );
+    unsigned int JUMP(unsigned int label) { 
+        unsigned int pos = code_size;
+        emitJump(EInstrCodes::JUMP, label);
         return pos;
     }
-    unsigned int MUL() { code.push_back(EInstrCodes::MUL); return code.size()-1; }
-    unsigned int DIV() { code.push_back(EInstrCodes::DIV); return code.size()-1; }
-    unsigned int ADD() { code.push_back(EInstrCodes::ADD); return code.size()-1; }
-    unsigned int SUB() { code.push_back(EInstrCodes::SUB); return code.size()-1; }
-    unsigned int NEG() { code.push_back(EInstrCodes::NEG); return code.size()-1; }
-    unsigned int END() { code.push_back(EInstrCodes::END); return code.size()-1; }
+    unsigned int MUL() { return emit(EInstrCodes::MUL); }
+    unsigned int DIV() { return emit(EInstrCodes::DIV); }
+    unsigned int ADD() { return emit(EInstrCodes::ADD); }
+    unsigned int SUB() { return emit(EInstrCodes::SUB); }
+    unsigned int NEG() { return emit(EInstrCodes::NEG); }
+    unsigned int END() { return emit(EInstrCodes::END); }
     // val: unicode bytearray
     unsigned int SYSCALL(unsigned int var_idx, const char* val) {
-        code.push_back(EInstrCodes::SYSCALL);
-        unsigned int pos = code.size()-1;
-        void* addr = (void*)&var_idx;
-        code.push_back( *((unsigned char*)addr) );
-        code.push_back( *((unsigned char*)addr+1) );
-        code.push_back( *((unsigned char*)addr+2) );
-        code.push_back( *((unsigned char*)addr+3) );
+        unsigned int pos = emit(EInstrCodes::SYSCALL);
+        emitBytes(&var_idx, 4);
 
         // Store function name
-        int i = 0;
-        do {
-            code.push_back( val[i] );
-        } while(val[i++] != 0);
+        emitString(val);
         return pos;
     }
     unsigned int RETURN(unsigned int fun_var_idx) { 
-        code.push_back(EInstrCodes::RETURN);
-        
-        unsigned int pos = code.size()-1;
-        void* addr = (void*)&fun_var_idx;
-        code.push_back( *((unsigned char*)addr) );
-        code.push_back( *((unsigned char*)addr+1) );
-        code.push_back( *((unsigned char*)addr+2) );
-        code.push_back( *((unsigned char*)addr+3) );
+        unsigned int pos = emit(EInstrCodes::RETURN);
+        emitBytes(&fun_var_idx, 4);
         return pos;
     }
 
     bool print(const std::string& filename) {
         std::ofstream s;
 
-        std::map<unsigned int, unsigned int> functions; // Contains the list of function addresses <function code idx, function variable idx>
-
-        unsigned char c;
         s.open(filename, std::ofstream::out | std::ofstream::trunc);
         if (!s.is_open()) {
             char errmsg[201];
@@ -411,6 +412,25 @@ public:
             return false;
         }
 
+        print(s);
+
+        return true;
+    }
+
+    // The listing of the DATA and CODE sections
+    std::string listing() {
+        std::ostringstream s;
+
+        print(s);
+
+        return s.str();
+    }
+
+    void print(std::ostream& s) {
+        link();
+
+        std::map<unsigned int, unsigned int> functions; // Contains the list of function addresses <function code idx, function variable idx>
+
         // Generate the DATA section
         for(unsigned int i = 0; i<variables.size(); i++) {
             const Datatype& v = variables.at(i);
@@ -426,9 +446,7 @@ public:
         }
 
         // Generate the CODE section
-        for(unsigned int i = 0; i<code.size(); i++) {
-            std::string s_fun_name;
-
+        for(unsigned int i = 0; i<code.size(); i += 1 + getInstrOperand(&code[i]).size) {
             auto fun_map_iterator { functions.find(i) };
 
             if (fun_map_iterator != std::end(functions)) {
@@ -436,165 +454,46 @@ public:
                 s << "; " << v.getScope() << "." << v.getName() << "(" << v.getDatatype() << ")" << std::endl;
             }
 
-            c = code[i];
+            const unsigned char* operand = code.data() + i + 1;
 
             s << i << " ";
 
-            switch(c) {
+            switch(code[i]) {
                 case EInstrCodes::NOP: s << "NOP" << std::endl; break;
                 case EInstrCodes::DATA: break; // It's handled separately
                 case EInstrCodes::DDATA: break; // It's handled separately
                 case EInstrCodes::FUN: break; // It's handled separately
-                case EInstrCodes::INITVAR: {
-                    s << "INITVAR ";
-                    unsigned int addr;
-                    unsigned char* paddr = (unsigned char*)&addr;
-                    *paddr = code[++i];
-                    *(paddr+1) = code[++i];
-                    *(paddr+2) = code[++i];
-                    *(paddr+3) = code[++i];
-
-                    const Datatype& v = variables.at(addr);
-
-                    s << addr << "\t\t; " << v.getScope() << "." << v.getName() << std::endl;
-                    break;
-                }
-                case EInstrCodes::ALLOCVAR: {
-                    s << "ALLOCVAR ";
-                    unsigned int addr;
-                    unsigned char* paddr = (unsigned char*)&addr;
-                    *paddr = code[++i];
-                    *(paddr+1) = code[++i];
-                    *(paddr+2) = code[++i];
-                    *(paddr+3) = code[++i];
-
-                    const Datatype& v = variables.at(addr);
-                    
-                    s << addr << "\t\t; " << v.getScope() << "." << v.getName() << std::endl;
-                    break;
-                }
-                case EInstrCodes::ALLOCVARS: {
-                    s << "ALLOCVARS ";
-                    unsigned int addr;
-                    unsigned char* paddr = (unsigned char*)&addr;
-                    *paddr = code[++i];
-                    *(paddr+1) = code[++i];
-                    *(paddr+2) = code[++i];
-                    *(paddr+3) = code[++i];
-
-                    const Datatype& v = variables.at(addr);
-                    
-                    s << addr << "\t\t; " << v.getScope() << "." << v.getName() << std::endl;
-                    break;
-                }
-                case EInstrCodes::PUTADDR: {
-                    s << "PUTADDR ";
-                    unsigned int addr;
-                    unsigned char* paddr = (unsigned char*)&addr;
-                    *paddr = code[++i];
-                    *(paddr+1) = code[++i];
-                    *(paddr+2) = code[++i];
-                    *(paddr+3) = code[++i];
-
-                    const Datatype& v = variables.at(addr);
-                    
-                    s << addr << "\t\t; " << v.getScope() << "." << v.getName() << std::endl;
-                    break;
-                }
-                case EInstrCodes::PUTDADDR: {
-                    s << "PUTDADDR ";
-                    unsigned int addr;
-                    unsigned char* paddr = (unsigned char*)&addr;
-                    *paddr = code[++i];
-                    *(paddr+1) = code[++i];
-                    *(paddr+2) = code[++i];
-                    *(paddr+3) = code[++i];
-
-                    const Datatype& v = variables.at(addr);
-                    
-                    s << addr << "\t\t; " << v.getScope() << "." << v.getName() << std::endl;
-                    break;
-                }
-                case EInstrCodes::CALL: {
-                    s << "CALL ";
-                    unsigned int addr;
-                    unsigned char* paddr = (unsigned char*)&addr;
-                    *paddr = code[++i];
-                    *(paddr+1) = code[++i];
-                    *(paddr+2) = code[++i];
-                    *(paddr+3) = code[++i];
-
-                    const Datatype& v = variables.at(addr);
-                    
-                    s << addr << "\t\t; " << v.getScope() << "." << v.getName() << std::endl;
-                    break;
-                }
+                case EInstrCodes::INITVAR: s << "INITVAR "; printVariableOperand(s, operand); break;
+                case EInstrCodes::ALLOCVAR: s << "ALLOCVAR "; printVariableOperand(s, operand); break;
+                case EInstrCodes::ALLOCVARS: s << "ALLOCVARS "; printVariableOperand(s, operand); break;
+                case EInstrCodes::PUTADDR: s << "PUTADDR "; printVariableOperand(s, operand); break;
+                case EInstrCodes::PUTDADDR: s << "PUTDADDR "; printVariableOperand(s, operand); break;
+                case EInstrCodes::CALL: s << "CALL "; printVariableOperand(s, operand); break;
                 case EInstrCodes::PUTINDADDR: {
-                    s << "PUTINDADDR " << (unsigned char)code[++i] << std::endl;
+                    s << "PUTINDADDR " << operand[0] << std::endl;
                     break;
                 }
                 case EInstrCodes::PUTMEMBERADDR: break; // TODO
                 case EInstrCodes::PUTINT: {
-                    s << "PUTINT ";
                     long long int val;
-                    unsigned char* pval = (unsigned char*)&val;
-                    *pval = code[++i];
-                    *(pval+1) = code[++i];
-                    *(pval+2) = code[++i];
-                    *(pval+3) = code[++i];
-                    *(pval+4) = code[++i];
-                    *(pval+5) = code[++i];
-                    *(pval+6) = code[++i];
-                    *(pval+7) = code[++i];
-
-                    s << val << std::endl;
+
+                    memcpy(&val, operand, 8);
+                    s << "PUTINT " << val << std::endl;
                     break;
                 }
                 case EInstrCodes::PUTFLOAT: {
-                    s << "PUTFLOAT ";
                     long double val;
-                    unsigned char* pval = (unsigned char*)&val;
-                    *pval = code[++i];
-                    *(pval+1) = code[++i];
-                    *(pval+2) = code[++i];
-                    *(pval+3) = code[++i];
-                    *(pval+4) = code[++i];
-                    *(pval+5) = code[++i];
-                    *(pval+6) = code[++i];
-                    *(pval+7) = code[++i];
-                    *(pval+8) = code[++i];
-                    *(pval+9) = code[++i];
-                    *(pval+10) = code[++i];
-                    *(pval+11) = code[++i];
-
-                    std::string std_string = std::to_string(val);
-                    s << std_string.c_str() << std::endl;
+
+                    memcpy(&val, operand, 12);
+                    s << "PUTFLOAT " << std::to_string(val) << std::endl;
                     break;
                 }
                 case EInstrCodes::PUTSTRING: {
-                    s << "PUTSTRING ";
-
-                    unsigned char c;
-                    std::string str;
-
-                    do {
-                        c = code[++i];
-
-                        if (c == 0) {
-                            break;
-                        }
-
-                        str += c;
-                    } while(true);
-
-                    s << str << std::endl;
+                    s << "PUTSTRING " << (const char*)operand << std::endl;
                     break;
                 }
                 case EInstrCodes::PUTBOOLEAN: {
-                    s << "PUTBOOLEAN ";
-                    unsigned char val = code[++i];
-
-                    s << (val ? "true" : "false") << std::endl;
+                    s << "PUTBOOLEAN " << (operand[0] ? "true" : "false") << std::endl;
                     break;
                 }
                 case EInstrCodes::MOVE: { s << "MOVE" << std::endl; break; }
@@ -609,27 +508,17 @@ public:
                 case EInstrCodes::LESS: { s << "LESS" << std::endl; break; }
                 case EInstrCodes::GREATER: { s << "GREATER" << std::endl; break; }
                 case EInstrCodes::JUMPIFFALSE: {
-                    s << "JUMPIFFALSE ";
                     unsigned int addr;
-                    unsigned char* paddr = (unsigned char*)&addr;
-                    *paddr = code[++i];
-                    *(paddr+1) = code[++i];
-                    *(paddr+2) = code[++i];
-                    *(paddr+3) = code[++i];
 
-                    s << addr << std::endl;
+                    memcpy(&addr, operand, 4);
+                    s << "JUMPIFFALSE " << addr << std::endl;
                     break;
                 }
                 case EInstrCodes::JUMP: {
-                    s << "JUMP ";
                     unsigned int addr;
-                    unsigned char* paddr = (unsigned char*)&addr;
-                    *paddr = code[++i];
-                    *(paddr+1) = code[++i];
-                    *(paddr+2) = code[++i];
-                    *(paddr+3) = code[++i];
 
-                    s << addr << std::endl;
+                    memcpy(&addr, operand, 4);
+                    s << "JUMP " << addr << std::endl;
                     break;
                 }
                 case EInstrCodes::MUL: { s << "MU" << std::endl; break; }
@@ -639,54 +528,22 @@ public:
                 case EInstrCodes::NEG: { s << "NEG" << std::endl; break; }
                 case EInstrCodes::END: { s << "END" << std::endl; break; }
                 case EInstrCodes::SYSCALL: {
-                    s << "SYSCALL ";
-
-                    // Parameter variable idx
+                    // Parameter variable idx, then the function name
                     unsigned int addr;
-                    unsigned char* paddr = (unsigned char*)&addr;
-                    *paddr = code[++i];
-                    *(paddr+1) = code[++i];
-                    *(paddr+2) = code[++i];
-                    *(paddr+3) = code[++i];
 
-                    s << addr << " ";
-
-                    // Function name
-                    unsigned char c;
-                    std::string str;
-
-                    do {
-                        c = code[++i];
-
-                        if (c == 0) {
-                            break;
-                        }
-
-                        str += c;
-                    } while (true);
-
-                    s << str << std::endl;
+                    memcpy(&addr, operand, 4);
+                    s << "SYSCALL " << addr << " " << (const char*)(operand + 4) << std::endl;
                     break;
                 }
                 case EInstrCodes::RETURN: {
-                    s << "RETURN ";
-                    
                     unsigned int addr;
-                    unsigned char* paddr = (unsigned char*)&addr;
-                    *paddr = code[++i];
-                    *(paddr+1) = code[++i];
-                    *(paddr+2) = code[++i];
-                    *(paddr+3) = code[++i];
-
-                    s << addr << std::endl;
-                    break; 
+
+                    memcpy(&addr, operand, 4);
+                    s << "RETURN " << addr << std::endl;
+                    break;
                 }
             } // ~switch
         } // ~for
-
-        s.close();
-
-        return true;
     }
 
     void makeAddresses()
@@ -707,11 +564,11 @@ public:
         }
     }
 
-    void printVariables()
+    void printVariables(std::ostream& s)
     {
         for(int i=0; i< variables.size(); i++) {
-            printf("%d ", i);
-            variables[i].printVariable();
+            s << i << " ";
+            variables[i].printVariable(s);
         }
     }
 };
@@ -0,0 +1,95 @@
+#include "compilepool.h"
+#include <algorithm>
+
+/*******************************************
+ * class CompilePool
+ *******************************************/
+
+CompilePool::CompilePool()
+{
+    unsigned int worker_count = std::max(1u, std::thread::hardware_concurrency());
+
+    for (unsigned int i=0; i<worker_count; i++) {
+        workers.push_back(std::thread(&CompilePool::help, this));
+    }
+}
+
+CompilePool::~CompilePool()
+{
+    {
+        std::lock_guard<std::mutex> lock(tasks_mutex);
+        stopping = true;
+    }
+
+    tasks_available.notify_all();
+
+    for (std::thread& worker: workers) {
+        worker.join();
+    }
+}
+
+CompilePool& CompilePool::instance()
+{
+    static CompilePool pool;
+    return pool;
+}
+
+void CompilePool::help()
+{
+    std::unique_lock<std::mutex> lock(tasks_mutex);
+
+    while (true) {
+        idle++;
+        tasks_available.wait(lock, [this]() { return stopping || !tasks.empty(); });
+        idle--;
+
+        if (stopping) {
+            return;
+        }
+
+        std::shared_ptr<Task> task = tasks.front();
+        tasks.pop_front();
+
+        if (task->closed) {
+            continue;
+        }
+
+        task->running++;
+        lock.unlock();
+
+        task->work();
+
+        lock.lock();
+        task->running--;
+        helper_finished.notify_all();
+    }
+}
+
+void CompilePool::run(unsigned int helpers, const std::function<void()>& work)
+{
+    std::shared_ptr<Task> task = std::make_shared<Task>();
+    task->work = work;
+
+    {
+        std::lock_guard<std::mutex> lock(tasks_mutex);
+
+        // The helpers queued by other compilations take the idle workers first
+        helpers = std::min<unsigned int>(helpers, idle > tasks.size() ? idle - (unsigned int)tasks.size() : 0);
+
+        for (unsigned int i=0; i<helpers; i++) {
+            tasks.push_back(task);
+        }
+    }
+
+    for (unsigned int i=0; i<helpers; i++) {
+        tasks_available.notify_one();
+    }
+
+    work();
+
+    // The helpers which haven't started yet are dropped by the workers
+    std::unique_lock<std::mutex> lock(tasks_mutex);
+
+    task->closed = true;
+    helper_finished.wait(lock, [&task]() { return task->running == 0; });
+}
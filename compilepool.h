@@ -0,0 +1,51 @@
+#ifndef COMPILEPOOL_H
+#define COMPILEPOOL_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+
+// The process-wide workers helping compilations, e.g. with the function bodies (see Parser::compile_deferred_functions).
+// The workers are fixed, one per core, and shared by all sessions, so concurrent compilations don't add threads.
+// Helpers are only queued for idle workers. A compilation started while the others keep the workers busy runs
+// on its own thread.
+class CompilePool
+{
+private:
+    // A 'run' call. Helpers starting after the caller has finished its part don't touch the work anymore.
+    struct Task
+    {
+        std::function<void()> work;
+        unsigned int running{ 0 };
+        bool closed{ false };
+    };
+
+    std::vector<std::thread> workers;
+    std::deque<std::shared_ptr<Task>> tasks;
+    unsigned int idle{ 0 };
+    std::mutex tasks_mutex;
+    std::condition_variable tasks_available;
+    std::condition_variable helper_finished;
+    bool stopping{ false };
+
+    CompilePool();
+    ~CompilePool();
+
+    void help();
+
+public:
+    CompilePool(const CompilePool&) = delete;
+    CompilePool& operator=(const CompilePool&) = delete;
+
+    static CompilePool& instance();
+
+    // Calls 'work' on the calling thread and on up to 'helpers' idle workers at once and returns when all calls
+    // have returned. 'work' must take its items from a shared counter, so it's done whoever takes part.
+    void run(unsigned int helpers, const std::function<void()>& work);
+};
+
+#endif // COMPILEPOOL_H
@@ -0,0 +1,106 @@
+#include "compiler.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+/*******************************************
+ * class Compiler
+ *******************************************/
+
+CompileResult Compiler::compile(const std::string& source, const CompileOptions& options)
+{
+    CompileResult result;
+    Parser parser;
+    ParseTrace parse_trace;
+
+    parser.setThreads(options.threads);
+
+    auto start = std::chrono::steady_clock::now();
+    result.status = parser.parse(source, parse_trace, result.bytecode);
+    result.compile_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+    if (result.status != EParseStatus::PARSE_OK) {
+        result.errors = parse_trace.getString();
+    }
+
+    if (options.listing) {
+        result.listing = result.bytecode.listing();
+    }
+
+    return result;
+}
+
+std::vector<CompileResult> Compiler::compileDirectory(const std::string& directory, const CompileOptions& options, const std::string& extension)
+{
+    std::vector<std::filesystem::path> files;
+    std::error_code error;
+
+    for (std::filesystem::directory_iterator iter(directory, error), end; !error && iter != end; iter.increment(error)) {
+        if (iter->is_regular_file() && iter->path().extension() == extension) {
+            files.push_back(iter->path());
+        }
+    }
+
+    std::sort(files.begin(), files.end());
+
+    // The files are compiled in parallel, so each one compiles its functions on one thread
+    CompileOptions file_options = options;
+    file_options.threads = 1;
+
+    std::vector<CompileResult> results(files.size());
+    std::atomic<unsigned int> next(0);
+    auto work = [&]() {
+        unsigned int i;
+
+        while ((i = next++) < files.size()) {
+            std::ifstream file(files[i], std::ios::in | std::ios::binary);
+
+            if (file.is_open()) {
+                std::stringstream source;
+                source << file.rdbuf();
+                results[i] = compile(source.str(), file_options);
+            } else {
+                results[i].errors = "Error opening " + files[i].string();
+            }
+
+            results[i].name = files[i].filename().string();
+        }
+    };
+
+    unsigned int thread_count = std::min<unsigned int>(options.threads ? options.threads : std::thread::hardware_concurrency(), files.size());
+    std::vector<std::thread> threads;
+
+    for (unsigned int i=1; i<thread_count; i++) {
+        threads.push_back(std::thread(work));
+    }
+    work();
+    for (std::thread& t: threads) {
+        t.join();
+    }
+
+    return results;
+}
+
+std::string Compiler::timingReport(const std::vector<CompileResult>& results)
+{
+    std::ostringstream s;
+    long long total_us = 0;
+    unsigned int failed = 0;
+
+    for (const CompileResult& result: results) {
+        s << result.name << "\t" << (result.status == EParseStatus::PARSE_OK ? "OK" : "ERROR") << "\t" << result.compile_us << " us" << std::endl;
+
+        total_us += result.compile_us;
+        if (result.status != EParseStatus::PARSE_OK) {
+            failed++;
+        }
+    }
+
+    s << results.size() << " files, " << failed << " failed, total compile time " << total_us << " us" << std::endl;
+
+    return s.str();
+}
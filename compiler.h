@@ -0,0 +1,41 @@
+#ifndef COMPILER_H
+#define COMPILER_H
+
+#include <string>
+#include <vector>
+
+#include "parser.h"
+
+struct CompileOptions
+{
+    bool listing{ false };          // Produce the bytecode listing
+    unsigned int threads{ 0 };      // Threads compiling function bodies; 0 - all cores
+};
+
+// Everything one compilation produces. Nothing is written to files or the console.
+struct CompileResult
+{
+    std::string name;               // The file name in batch compilations
+    EParseStatus status{ EParseStatus::PARSE_ERROR };
+    Bytecode bytecode;
+    std::string errors;             // The parse trace of a failed compilation
+    std::string listing;            // If CompileOptions::listing
+    long long compile_us{ 0 };      // Without reading the file
+};
+
+// Compilation as a function of the source and the options.
+// Every compilation uses its own Parser, so any number of them may run at once.
+class Compiler
+{
+public:
+    static CompileResult compile(const std::string& source, const CompileOptions& options);
+
+    // Compiles the files with the 'extension' in the 'directory' on all cores.
+    // The results are sorted by the file name. Files which can't be read get PARSE_ERROR and the reason in 'errors'.
+    static std::vector<CompileResult> compileDirectory(const std::string& directory, const CompileOptions& options, const std::string& extension = ".ant");
+
+    // One line per file with the status and the compile time, and the totals
+    static std::string timingReport(const std::vector<CompileResult>& results);
+};
+
+#endif // COMPILER_H
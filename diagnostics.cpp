@@ -0,0 +1,72 @@
+#include "diagnostics.h"
+
+/*******************************************
+ * class StreamSink
+ *******************************************/
+
+void StreamSink::write(EDiagnosticLevel, const std::string& text)
+{
+    std::lock_guard<std::mutex> lock(stream_mutex);
+
+    stream << text;
+    if (text.empty() || text.back() != '\n') {
+        stream << '\n';
+    }
+}
+
+/*******************************************
+ * class MemorySink
+ *******************************************/
+
+// The text is cut back to the capacity only after it has grown by half of it, so a cut moves the kept text
+// once per capacity / 2 written bytes and not once per message
+void MemorySink::write(EDiagnosticLevel, const std::string& message)
+{
+    std::lock_guard<std::mutex> lock(text_mutex);
+
+    text += message;
+    if (message.empty() || message.back() != '\n') {
+        text += '\n';
+    }
+
+    if (text.size() > capacity + capacity / 2) {
+        text.erase(0, text.size() - capacity);
+    }
+}
+
+std::string MemorySink::take()
+{
+    std::lock_guard<std::mutex> lock(text_mutex);
+    std::string ret;
+
+    if (text.size() > capacity) {
+        text.erase(0, text.size() - capacity);
+    }
+
+    ret.swap(text);
+
+    return ret;
+}
+
+/*******************************************
+ * class Diagnostics
+ *******************************************/
+
+thread_local Diagnostics* Diagnostics::bound = NULL;
+
+void Diagnostics::write(EDiagnosticLevel message_level, const std::string& text)
+{
+    if (isEnabled(message_level) && bound->sink) {
+        bound->sink->write(message_level, text);
+    }
+}
+
+EDiagnosticLevel Diagnostics::parseLevel(const std::string& name)
+{
+    if (name == "error") return EDiagnosticLevel::LEVEL_ERROR;
+    if (name == "info") return EDiagnosticLevel::LEVEL_INFO;
+    if (name == "debug") return EDiagnosticLevel::LEVEL_DEBUG;
+    if (name == "trace") return EDiagnosticLevel::LEVEL_TRACE;
+
+    return EDiagnosticLevel::LEVEL_OFF;
+}
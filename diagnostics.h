@@ -0,0 +1,96 @@
+#ifndef DIAGNOSTICS_H
+#define DIAGNOSTICS_H
+
+#include <string>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <ostream>
+
+// Ordered by the amount of detail. A context at a level gets the messages of that level and the levels above.
+enum class EDiagnosticLevel { LEVEL_OFF, LEVEL_ERROR, LEVEL_INFO, LEVEL_DEBUG, LEVEL_TRACE };
+
+// Receives the diagnostic messages of a context. 'write' may be called from any thread.
+class DiagnosticsSink
+{
+public:
+    virtual ~DiagnosticsSink() {}
+
+    virtual void write(EDiagnosticLevel level, const std::string& text) = 0;
+};
+
+// Writes the messages to a stream, e.g. std::cout of a console run
+class StreamSink : public DiagnosticsSink
+{
+private:
+    std::ostream& stream;
+    std::mutex stream_mutex;
+
+public:
+    StreamSink(std::ostream& stream) : stream(stream) {}
+
+    void write(EDiagnosticLevel level, const std::string& text) override;
+};
+
+// Keeps the messages in memory until they're taken. Returns at most 'capacity' bytes, the oldest text is cut off.
+// Between two cuts it may hold up to half as much again.
+class MemorySink : public DiagnosticsSink
+{
+private:
+    std::string text;
+    size_t capacity;
+    mutable std::mutex text_mutex;
+
+public:
+    MemorySink(size_t capacity) : capacity(capacity) {}
+
+    void write(EDiagnosticLevel level, const std::string& message) override;
+
+    // Returns the kept text and clears it
+    std::string take();
+};
+
+// A diagnostics context: the level and the sink of e.g. one session. The context is bound to the thread doing the
+// work of its owner, so deep code like array destructors reports to the right sink without knowing it. Nothing is
+// written when no context is bound, and messages are only built after 'isEnabled' has passed them.
+class Diagnostics
+{
+private:
+    static thread_local Diagnostics* bound;
+
+    std::atomic<EDiagnosticLevel> level;
+    std::shared_ptr<DiagnosticsSink> sink;
+
+public:
+    // Binds the context to the current thread for the lifetime of the scope. A NULL context unbinds.
+    class Scope
+    {
+    private:
+        Diagnostics* previous;
+
+    public:
+        Scope(Diagnostics* diagnostics) : previous(bound) { bound = diagnostics; }
+        ~Scope() { bound = previous; }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+
+    Diagnostics(EDiagnosticLevel level, const std::shared_ptr<DiagnosticsSink>& sink) : level(level), sink(sink) {}
+    Diagnostics(const Diagnostics&) = delete;
+    Diagnostics& operator=(const Diagnostics&) = delete;
+
+    // May be changed while the context is bound on another thread
+    void setLevel(EDiagnosticLevel new_level) { level = new_level; }
+    EDiagnosticLevel getLevel() const { return level; }
+
+    // Whether the context bound to the thread takes messages of the 'message_level'
+    static bool isEnabled(EDiagnosticLevel message_level) {
+        return bound != NULL && message_level != EDiagnosticLevel::LEVEL_OFF && message_level <= bound->level.load(std::memory_order_relaxed);
+    }
+    static void write(EDiagnosticLevel message_level, const std::string& text);
+
+    // "off", "error", "info", "debug" or "trace". LEVEL_OFF for anything else.
+    static EDiagnosticLevel parseLevel(const std::string& name);
+};
+
+#endif // DIAGNOSTICS_H
@@ -0,0 +1,235 @@
+#include "executionservice.h"
+#include "metrics.h"
+#include <Wt/WServer.h>
+#include <algorithm>
+
+/*******************************************
+ * class ExecutionJob
+ *******************************************/
+
+ExecutionJob::ExecutionJob(const std::shared_ptr<const Bytecode>& program, const std::string& session_id,
+    const std::shared_ptr<Diagnostics>& diagnostics, size_t output_capacity, const ProgressHandler& on_progress,
+    const OutputHandler& on_output, const FinishedHandler& on_finished) :
+    program(program), status(EExecStatus::OK_RUN), session_id(session_id), diagnostics(diagnostics), output(output_capacity),
+    on_progress(on_progress), on_output(on_output), on_finished(on_finished)
+{
+}
+
+void ExecutionJob::cancel()
+{
+    cancelled = true;
+    vm.cancel();
+}
+
+void ExecutionJob::flushOutput()
+{
+    std::string text;
+
+    // Cleared first: output written from now on needs another batch
+    output_posted = false;
+
+    unsigned long long dropped = output.take(text);
+    if (on_output && (!text.empty() || dropped > 0)) {
+        on_output(text, dropped);
+    }
+}
+
+/*******************************************
+ * class ExecutionService
+ *******************************************/
+
+ExecutionService::ExecutionService() : stopping(false), memory_quota(DEFAULT_MEMORY_QUOTA)
+{
+    unsigned int worker_count = std::max(1u, std::thread::hardware_concurrency());
+
+    for (unsigned int i=0; i<worker_count; i++) {
+        workers.push_back(std::thread(&ExecutionService::work, this));
+    }
+}
+
+ExecutionService::~ExecutionService()
+{
+    {
+        std::lock_guard<std::mutex> lock(jobs_mutex);
+
+        stopping = true;
+        jobs.clear();
+        for (const std::shared_ptr<ExecutionJob>& job: running) {
+            job->cancel();
+        }
+    }
+
+    jobs_available.notify_all();
+
+    for (std::thread& worker: workers) {
+        worker.join();
+    }
+}
+
+ExecutionService& ExecutionService::instance()
+{
+    static ExecutionService service;
+    return service;
+}
+
+std::shared_ptr<ExecutionJob> ExecutionService::submit(const std::shared_ptr<const Bytecode>& program, const std::string& session_id,
+    const std::shared_ptr<Diagnostics>& diagnostics, const ExecutionJob::ProgressHandler& on_progress,
+    const ExecutionJob::OutputHandler& on_output, const ExecutionJob::FinishedHandler& on_finished)
+{
+    std::shared_ptr<ExecutionJob> job = std::make_shared<ExecutionJob>(program, session_id, diagnostics, OUTPUT_CAPACITY,
+        on_progress, on_output, on_finished);
+
+    {
+        std::lock_guard<std::mutex> lock(jobs_mutex);
+        jobs.push_back(job);
+    }
+
+    jobs_available.notify_one();
+
+    return job;
+}
+
+void ExecutionService::work()
+{
+    while (true) {
+        std::shared_ptr<ExecutionJob> job;
+
+        {
+            std::unique_lock<std::mutex> lock(jobs_mutex);
+
+            jobs_available.wait(lock, [this]() { return stopping || !jobs.empty(); });
+            if (stopping) {
+                return;
+            }
+
+            job = jobs.front();
+            jobs.pop_front();
+            running.push_back(job);
+        }
+
+        bool yielded = runSlice(job);
+
+        {
+            std::lock_guard<std::mutex> lock(jobs_mutex);
+            running.erase(std::find(running.begin(), running.end(), job));
+
+            // Round robin: the job waits behind the jobs queued meanwhile
+            if (yielded && !stopping) {
+                jobs.push_back(job);
+            }
+        }
+
+        if (yielded) {
+            jobs_available.notify_one();
+        }
+    }
+}
+
+// Runs the job for one time slice. Returns true if the job hasn't finished.
+bool ExecutionService::runSlice(const std::shared_ptr<ExecutionJob>& job)
+{
+    Diagnostics::Scope diagnostics_scope(job->diagnostics.get());
+
+    if (!job->vm.isStarted()) {
+        // 'init' clears a cancel request of the VM, so the job's own flag is checked after it
+        job->vm.init();
+        job->vm.setMemoryQuota(memory_quota);
+        job->vm.setOutput(&job->output);
+
+        if (job->cancelled) {
+            job->status = EExecStatus::EXEC_CANCELLED;
+            finish(job);
+            return false;
+        }
+
+        ExecutionJob* p_job = job.get();
+
+        // Queued jobs only hold a reference to the program
+        job->bytecode = *job->program;
+        job->program.reset();
+
+        job->start_time = std::chrono::steady_clock::now();
+        job->last_progress = job->start_time;
+        job->vm.setProgressHandler([this, p_job](unsigned long long executed_instructions) {
+            reportProgress(*p_job, executed_instructions);
+        });
+        job->vm.start(job->bytecode);
+    }
+
+    job->vm.resume(job->bytecode, job->status, 0, TIME_SLICE_US);
+
+    if (job->status == EExecStatus::EXEC_YIELDED) {
+        return true;
+    }
+
+    long long execution_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - job->start_time).count();
+    Metrics::instance().recordExecution(execution_us, job->vm.getExecutedInstructions(), job->vm.getPeakCallDepth(),
+        job->vm.getMemoryPeak(), job->status);
+
+    finish(job);
+    return false;
+}
+
+void ExecutionService::finish(const std::shared_ptr<ExecutionJob>& job)
+{
+    job->finished = true;
+
+    Wt::WServer* server = Wt::WServer::instance();
+    if (server && job->on_finished) {
+        server->post(job->session_id, [job]() {
+            job->flushOutput();
+            job->on_finished(job->status, job->bytecode);
+            release(*job);
+        });
+    } else {
+        release(*job);
+    }
+}
+
+// The session may keep a finished job, e.g. for its result. The job keeps only that.
+void ExecutionService::release(ExecutionJob& job)
+{
+    job.program.reset();
+    job.bytecode = Bytecode();
+}
+
+// Runs on the worker thread
+void ExecutionService::reportProgress(ExecutionJob& job, unsigned long long executed_instructions)
+{
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+    if (now - job.last_progress < std::chrono::milliseconds(PROGRESS_INTERVAL_MS)) {
+        return;
+    }
+
+    job.last_progress = now;
+
+    Wt::WServer* server = Wt::WServer::instance();
+    if (!server) {
+        return;
+    }
+
+    std::shared_ptr<ExecutionJob> p_job = job.shared_from_this();
+
+    if (job.on_progress) {
+        server->post(job.session_id, [p_job, executed_instructions]() {
+            p_job->on_progress(executed_instructions);
+        });
+    }
+
+    postOutput(p_job);
+}
+
+// Runs on the worker thread. The output written until the batch is handled goes with it.
+void ExecutionService::postOutput(const std::shared_ptr<ExecutionJob>& job)
+{
+    Wt::WServer* server = Wt::WServer::instance();
+
+    if (!server || !job->on_output || job->output.isEmpty() || job->output_posted.exchange(true)) {
+        return;
+    }
+
+    server->post(job->session_id, [job]() {
+        job->flushOutput();
+    });
+}
@@ -0,0 +1,115 @@
+#ifndef EXECUTIONSERVICE_H
+#define EXECUTIONSERVICE_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <functional>
+
+#include "bytecode.h"
+#include "diagnostics.h"
+#include "outputbuffer.h"
+#include "vm.h"
+
+// One program submitted to the ExecutionService
+class ExecutionJob : public std::enable_shared_from_this<ExecutionJob>
+{
+public:
+    typedef std::function<void(unsigned long long executed_instructions)> ProgressHandler;
+    // A batch of the program output. 'dropped' - bytes lost since the previous batch, because the session fell behind.
+    typedef std::function<void(const std::string& text, unsigned long long dropped)> OutputHandler;
+    typedef std::function<void(EExecStatus status, Bytecode& bytecode)> FinishedHandler;
+
+    ExecutionJob(const std::shared_ptr<const Bytecode>& program, const std::string& session_id,
+        const std::shared_ptr<Diagnostics>& diagnostics, size_t output_capacity, const ProgressHandler& on_progress, const OutputHandler& on_output, const FinishedHandler& on_finished);
+
+    // May be called from any thread. A job which hasn't started yet doesn't run at all.
+    void cancel();
+    bool isFinished() const { return finished; }
+    // The result, once the job is finished
+    EExecStatus getStatus() const { return status; }
+
+    // The memory owned by the program, see VM::getMemoryUsed. May be called from any thread.
+    size_t getMemoryUsed() const { return vm.getMemoryUsed(); }
+    size_t getMemoryPeak() const { return vm.getMemoryPeak(); }
+
+private:
+    friend class ExecutionService;
+
+    std::shared_ptr<const Bytecode> program;    // Shared with the session until the job starts
+    Bytecode bytecode;      // The job's own copy, made when it starts. The VM keeps the variable values in it.
+    VM vm;
+    EExecStatus status;
+    std::string session_id;
+    std::shared_ptr<Diagnostics> diagnostics;  // Bound while the job runs. Shared, the session may end first.
+    OutputBuffer output;
+    ProgressHandler on_progress;
+    OutputHandler on_output;
+    FinishedHandler on_finished;
+    std::atomic<bool> cancelled{ false };
+    std::atomic<bool> finished{ false };
+    std::atomic<bool> output_posted{ false };   // An output batch is on its way to the session
+    std::chrono::steady_clock::time_point last_progress;
+    std::chrono::steady_clock::time_point start_time;
+
+    // Runs in the session context
+    void flushOutput();
+};
+
+// Runs programs on a fixed pool of worker threads, so a long script blocks neither its Wt session nor the Wt server threads.
+// The workers share the programs in time slices, round robin, so any number of sessions can run programs at once
+// and a runaway program only takes its share of the workers.
+// The handlers of a job are posted to its session with WServer::post. They run in the session context like any
+// other event handler and must call 'triggerUpdate' to push their changes. Handlers of an ended session are dropped.
+// The program output is buffered per job and posted in batches at most every PROGRESS_INTERVAL_MS. A batch takes all
+// the output written until it's handled, so the output of a program never queues more than one event in its session.
+class ExecutionService
+{
+private:
+    static constexpr unsigned int PROGRESS_INTERVAL_MS = 250;  // The minimal interval between two progress reports of a job
+    static const unsigned int TIME_SLICE_US = 10000;        // Then a job lets the next queued job run on its worker
+    static const size_t DEFAULT_MEMORY_QUOTA = 64 * 1024 * 1024;
+    static constexpr size_t OUTPUT_CAPACITY = 64 * 1024;    // The output of a job waiting for its session. Older output is dropped.
+
+    std::vector<std::thread> workers;
+    std::deque<std::shared_ptr<ExecutionJob>> jobs;         // Waiting for a worker, including the yielded ones
+    std::vector<std::shared_ptr<ExecutionJob>> running;
+    std::mutex jobs_mutex;
+    std::condition_variable jobs_available;
+    bool stopping;
+    std::atomic<size_t> memory_quota;
+
+    ExecutionService();
+    ~ExecutionService();
+
+    void work();
+    bool runSlice(const std::shared_ptr<ExecutionJob>& job);
+    void finish(const std::shared_ptr<ExecutionJob>& job);
+    void reportProgress(ExecutionJob& job, unsigned long long executed_instructions);
+    void postOutput(const std::shared_ptr<ExecutionJob>& job);
+    static void release(ExecutionJob& job);
+
+public:
+    ExecutionService(const ExecutionService&) = delete;
+    ExecutionService& operator=(const ExecutionService&) = delete;
+
+    static ExecutionService& instance();
+
+    // Queues the compiled 'program' for execution. The program isn't changed, each job runs its own copy.
+    // The diagnostics of the run go to the 'diagnostics' context, which may be NULL. The returned job can be used to cancel it.
+    std::shared_ptr<ExecutionJob> submit(const std::shared_ptr<const Bytecode>& program, const std::string& session_id,
+        const std::shared_ptr<Diagnostics>& diagnostics, const ExecutionJob::ProgressHandler& on_progress, const ExecutionJob::OutputHandler& on_output,
+        const ExecutionJob::FinishedHandler& on_finished);
+
+    // The memory a job may own (bytes, 0 - no limit). Applies to the jobs started later.
+    void setMemoryQuota(size_t quota) { memory_quota = quota; }
+    size_t getMemoryQuota() const { return memory_quota; }
+};
+
+#endif // EXECUTIONSERVICE_H
@@ -0,0 +1,216 @@
+#include "loadtest.h"
+#include "HelloApplication.h"
+#include <Wt/Test/WTestEnvironment.h>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <unistd.h>
+#endif
+
+// The value below which the 'fraction' of the sorted 'values' lies
+static long long percentile(const std::vector<long long>& values, double fraction)
+{
+    if (values.empty()) {
+        return 0;
+    }
+
+    size_t i = std::min(values.size() - 1, (size_t)(fraction * values.size()));
+    return values[i];
+}
+
+static long long elapsedUs(std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+}
+
+/*******************************************
+ * struct LoadTestReport
+ *******************************************/
+
+std::string LoadTestReport::toString() const
+{
+    std::ostringstream s;
+    double seconds = duration_us / 1e6;
+
+    s << std::fixed << std::setprecision(2);
+    s << sessions << " sessions, " << cycles << " cycles (" << failures << " failed) in " << seconds << " s: "
+      << (seconds > 0 ? cycles / seconds : 0.0) << " cycles/s" << std::endl;
+    s << "compile  p50 " << percentile(compile_us, 0.5) / 1000.0 << " ms, p99 " << percentile(compile_us, 0.99) / 1000.0 << " ms" << std::endl;
+    s << "execute  p50 " << percentile(execute_us, 0.5) / 1000.0 << " ms, p99 " << percentile(execute_us, 0.99) / 1000.0 << " ms" << std::endl;
+    s << "cycle    p50 " << percentile(cycle_us, 0.5) / 1000.0 << " ms, p99 " << percentile(cycle_us, 0.99) / 1000.0 << " ms" << std::endl;
+    s << "memory per session " << memory_per_session / 1024 << " KB, held between requests: parser "
+      << parser_per_session / 1024.0 << " KB, program " << program_per_session / 1024.0 << " KB" << std::endl;
+
+    return s.str();
+}
+
+/*******************************************
+ * class LoadTest
+ *******************************************/
+
+LoadTestReport LoadTest::run(const std::vector<std::string>& scripts, const LoadTestOptions& options)
+{
+    LoadTestReport report;
+    std::mutex report_mutex;
+    std::condition_variable state_changed;
+    unsigned int ready = 0;
+    bool started = false;
+
+    report.sessions = options.sessions;
+
+    if (scripts.empty() || options.sessions == 0) {
+        return report;
+    }
+
+    auto session = [&](unsigned int session_idx) {
+        Wt::Test::WTestEnvironment env;
+        HelloApplication app(env);
+
+        // The cycles start when all sessions exist, so the memory is measured with every session alive
+        {
+            std::unique_lock<std::mutex> lock(report_mutex);
+
+            ready++;
+            state_changed.notify_all();
+            state_changed.wait(lock, [&]() { return started; });
+        }
+
+        std::vector<long long> compile_us, execute_us, cycle_us;
+        unsigned int failures = 0;
+
+        for (unsigned int cycle=0; cycle<options.cycles; cycle++) {
+            const std::string& script = scripts[(session_idx + cycle) % scripts.size()];
+            std::chrono::steady_clock::time_point cycle_start = std::chrono::steady_clock::now();
+
+            // The script replaces the whole source of the previous cycle
+            SourceEdit edit;
+            edit.first_row = 0;
+
+            ParseTrace parse_trace;
+            EParseStatus ret = app.compileSource(script, edit, parse_trace);
+            std::chrono::steady_clock::time_point compiled = std::chrono::steady_clock::now();
+
+            compile_us.push_back(elapsedUs(cycle_start, compiled));
+
+            if (ret == EParseStatus::PARSE_OK) {
+                std::shared_ptr<ExecutionJob> job = app.submitExecution();
+
+                // Events posted by the ExecutionService don't reach test sessions, so the end is polled
+                while (!job->isFinished()) {
+                    std::this_thread::sleep_for(std::chrono::microseconds(100));
+                }
+
+                execute_us.push_back(elapsedUs(compiled, std::chrono::steady_clock::now()));
+
+                if (job->getStatus() != EExecStatus::OK_STOP) {
+                    failures++;
+                }
+            } else {
+                failures++;
+            }
+
+            cycle_us.push_back(elapsedUs(cycle_start, std::chrono::steady_clock::now()));
+        }
+
+        SessionMemoryReport memory = app.memoryReport();
+        std::lock_guard<std::mutex> lock(report_mutex);
+
+        report.cycles += options.cycles;
+        report.parser_per_session += memory.parser / options.sessions;
+        report.program_per_session += memory.program / options.sessions;
+        report.failures += failures;
+        report.compile_us.insert(report.compile_us.end(), compile_us.begin(), compile_us.end());
+        report.execute_us.insert(report.execute_us.end(), execute_us.begin(), execute_us.end());
+        report.cycle_us.insert(report.cycle_us.end(), cycle_us.begin(), cycle_us.end());
+    };
+
+    size_t memory_before = residentMemory();
+    std::vector<std::thread> threads;
+
+    for (unsigned int i=0; i<options.sessions; i++) {
+        threads.push_back(std::thread(session, i));
+    }
+
+    std::chrono::steady_clock::time_point start;
+    {
+        std::unique_lock<std::mutex> lock(report_mutex);
+
+        state_changed.wait(lock, [&]() { return ready == options.sessions; });
+
+        size_t memory_after = residentMemory();
+        report.memory_per_session = memory_after > memory_before ? (memory_after - memory_before) / options.sessions : 0;
+
+        start = std::chrono::steady_clock::now();
+        started = true;
+    }
+    state_changed.notify_all();
+
+    for (std::thread& thread: threads) {
+        thread.join();
+    }
+
+    report.duration_us = elapsedUs(start, std::chrono::steady_clock::now());
+
+    std::sort(report.compile_us.begin(), report.compile_us.end());
+    std::sort(report.execute_us.begin(), report.execute_us.end());
+    std::sort(report.cycle_us.begin(), report.cycle_us.end());
+
+    return report;
+}
+
+std::vector<std::string> LoadTest::readScripts(const std::string& directory, const std::string& extension)
+{
+    std::vector<std::filesystem::path> files;
+    std::vector<std::string> scripts;
+    std::error_code error;
+
+    for (std::filesystem::directory_iterator iter(directory, error), end; !error && iter != end; iter.increment(error)) {
+        if (iter->is_regular_file() && iter->path().extension() == extension) {
+            files.push_back(iter->path());
+        }
+    }
+
+    std::sort(files.begin(), files.end());
+
+    for (const std::filesystem::path& path: files) {
+        std::ifstream file(path, std::ios::in | std::ios::binary);
+        std::stringstream source;
+
+        source << file.rdbuf();
+        scripts.push_back(source.str());
+    }
+
+    return scripts;
+}
+
+size_t LoadTest::residentMemory()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return counters.WorkingSetSize;
+    }
+
+    return 0;
+#else
+    std::ifstream statm("/proc/self/statm");
+    size_t pages = 0, resident = 0;
+
+    statm >> pages >> resident;
+
+    return resident * sysconf(_SC_PAGESIZE);
+#endif
+}
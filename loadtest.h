@@ -0,0 +1,46 @@
+#ifndef LOADTEST_H
+#define LOADTEST_H
+
+#include <string>
+#include <vector>
+
+struct LoadTestOptions
+{
+    unsigned int sessions{ 16 };    // Concurrent sessions, each one driven by its own thread like a user
+    unsigned int cycles{ 20 };      // Compile/execute cycles per session
+};
+
+struct LoadTestReport
+{
+    unsigned int sessions{ 0 };
+    unsigned int cycles{ 0 };               // Completed cycles of all sessions
+    unsigned int failures{ 0 };             // Cycles whose compilation or execution failed
+    long long duration_us{ 0 };             // From the start of the first cycle to the end of the last one
+    size_t memory_per_session{ 0 };         // The growth of the resident memory by creating the sessions, per session
+    size_t parser_per_session{ 0 };         // The averages of HelloApplication::memoryReport after the last cycle
+    size_t program_per_session{ 0 };
+    std::vector<long long> compile_us;      // Sorted
+    std::vector<long long> execute_us;      // From the submission to the end of the program. Sorted.
+    std::vector<long long> cycle_us;        // Sorted
+
+    // Throughput, p50/p99 latencies and the memory per session
+    std::string toString() const;
+};
+
+// Spins up HelloApplication sessions in-process with Wt::Test::WTestEnvironment and drives compile/execute cycles
+// of the scripts from many threads at once. The programs run on the ExecutionService like in the server.
+// Measures the capacity of the engine without a browser.
+class LoadTest
+{
+public:
+    // Every session runs through the scripts, starting with a different one
+    static LoadTestReport run(const std::vector<std::string>& scripts, const LoadTestOptions& options);
+
+    // The files with the 'extension' in the 'directory', sorted by the name
+    static std::vector<std::string> readScripts(const std::string& directory, const std::string& extension = ".ant");
+
+private:
+    static size_t residentMemory();
+};
+
+#endif // LOADTEST_H
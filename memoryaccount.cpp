@@ -0,0 +1,21 @@
+#include "memoryaccount.h"
+
+static const size_t SHORT_STRING_CAPACITY = std::string().capacity();
+
+/*******************************************
+ * class MemoryAccount
+ *******************************************/
+
+thread_local MemoryAccount* MemoryAccount::bound = NULL;
+
+size_t MemoryAccount::stringSize(const std::string& s)
+{
+    return s.capacity() > SHORT_STRING_CAPACITY ? s.capacity() + 1 : 0;
+}
+
+void MemoryAccount::reset()
+{
+    used = 0;
+    peak = 0;
+    exceeded = false;
+}
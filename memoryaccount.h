@@ -0,0 +1,91 @@
+#ifndef MEMORYACCOUNT_H
+#define MEMORYACCOUNT_H
+
+#include <cstddef>
+#include <string>
+#include <atomic>
+
+// Counts the memory owned by one program execution: variables, array blocks and string buffers.
+// The account of the running program is bound to the executing thread with a Scope, so the allocation sites
+// in arrays and variables needn't know their VM. Allocations made without a bound account aren't counted.
+// Only the bound thread changes the counters; 'getUsed' and 'getPeak' may be read from any thread.
+class MemoryAccount
+{
+private:
+    static thread_local MemoryAccount* bound;
+
+    std::atomic<size_t> used{ 0 };
+    std::atomic<size_t> peak{ 0 };
+    size_t quota{ 0 };          // Bytes, 0 - no limit
+    bool exceeded{ false };
+
+    void add(size_t size) {
+        size_t now = used.load(std::memory_order_relaxed) + size;
+
+        used.store(now, std::memory_order_relaxed);
+        if (now > peak.load(std::memory_order_relaxed)) {
+            peak.store(now, std::memory_order_relaxed);
+        }
+        if (quota && now > quota) {
+            exceeded = true;
+        }
+    }
+
+    // Saturates at 0, a value may have been created before the account was bound
+    void remove(size_t size) {
+        size_t now = used.load(std::memory_order_relaxed);
+
+        used.store(now > size ? now - size : 0, std::memory_order_relaxed);
+    }
+
+public:
+    // Binds the account to the current thread for the lifetime of the scope
+    class Scope
+    {
+    private:
+        MemoryAccount* previous;
+
+    public:
+        Scope(MemoryAccount& account) : previous(bound) { bound = &account; }
+        ~Scope() { bound = previous; }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+
+    MemoryAccount() {}
+    MemoryAccount(const MemoryAccount&) = delete;
+    MemoryAccount& operator=(const MemoryAccount&) = delete;
+
+    // The allocation sites report to the account bound to the thread
+    static void charge(size_t size) {
+        if (bound != NULL) bound->add(size);
+    }
+    static void credit(size_t size) {
+        if (bound != NULL) bound->remove(size);
+    }
+    static void recharge(size_t old_size, size_t new_size) {
+        if (new_size > old_size) {
+            charge(new_size - old_size);
+        } else {
+            credit(old_size - new_size);
+        }
+    }
+    // Lets an operation refuse an allocation which would exceed the quota before it's made
+    static bool canAllocate(size_t size) {
+        return bound == NULL || bound->quota == 0 || bound->used.load(std::memory_order_relaxed) + size <= bound->quota;
+    }
+
+    // The size of the string buffer on the heap. Short strings are stored in the string object.
+    static size_t stringSize(const std::string& s);
+
+    void setQuota(size_t quota) { this->quota = quota; }
+    size_t getQuota() const { return quota; }
+    size_t getUsed() const { return used.load(std::memory_order_relaxed); }
+    size_t getPeak() const { return peak.load(std::memory_order_relaxed); }
+    bool isExceeded() const { return exceeded; }
+
+    // Clears the counters for the next program. The quota stays.
+    void reset();
+};
+
+#endif // MEMORYACCOUNT_H
@@ -0,0 +1,176 @@
+#include "metrics.h"
+#include "vm.h"
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+
+static const std::vector<unsigned long long> LATENCY_BUCKETS_US = {
+    100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 500000,
+    1000000, 2500000, 5000000, 10000000, 30000000, 60000000
+};
+static const std::vector<unsigned long long> SIZE_BUCKETS = {
+    1 << 10, 1 << 12, 1 << 14, 1 << 16, 1 << 18, 1 << 20, 1 << 22, 1 << 24, 1 << 26, 1 << 28
+};
+static const std::vector<unsigned long long> COUNT_BUCKETS = {
+    1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000, 10000000000ULL
+};
+static const std::vector<unsigned long long> DEPTH_BUCKETS = {
+    1, 2, 4, 8, 16, 32, 64, 128, 256, 512, 1024, 4096
+};
+
+/*******************************************
+ * class Histogram
+ *******************************************/
+
+Histogram::Histogram(const std::string& name, const std::string& help, const std::vector<unsigned long long>& bounds, double scale) :
+    name(name), help(help), bounds(bounds), scale(scale), buckets(new std::atomic<unsigned long long>[bounds.size() + 1])
+{
+    for (size_t i=0; i<=bounds.size(); i++) {
+        buckets[i] = 0;
+    }
+}
+
+void Histogram::observe(unsigned long long value)
+{
+    size_t bucket = std::lower_bound(bounds.begin(), bounds.end(), value) - bounds.begin();
+
+    buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(value, std::memory_order_relaxed);
+}
+
+// The buckets are read one by one while they may be updated, so a scrape may be off by the concurrent observations
+void Histogram::write(std::ostream& s) const
+{
+    unsigned long long cumulative = 0;
+
+    s << "# HELP " << name << " " << help << "\n";
+    s << "# TYPE " << name << " histogram\n";
+
+    for (size_t i=0; i<bounds.size(); i++) {
+        cumulative += buckets[i].load(std::memory_order_relaxed);
+        s << name << "_bucket{le=\"" << bounds[i] * scale << "\"} " << cumulative << "\n";
+    }
+
+    cumulative += buckets[bounds.size()].load(std::memory_order_relaxed);
+    s << name << "_bucket{le=\"+Inf\"} " << cumulative << "\n";
+    s << name << "_sum " << sum.load(std::memory_order_relaxed) * scale << "\n";
+    s << name << "_count " << cumulative << "\n";
+}
+
+/*******************************************
+ * class Counter
+ *******************************************/
+
+void Counter::write(std::ostream& s) const
+{
+    s << "# HELP " << name << " " << help << "\n";
+    s << "# TYPE " << name << " counter\n";
+    s << name << " " << value.load(std::memory_order_relaxed) << "\n";
+}
+
+/*******************************************
+ * class MetricsRegistry
+ *******************************************/
+
+MetricsRegistry& MetricsRegistry::instance()
+{
+    static MetricsRegistry registry;
+    return registry;
+}
+
+Histogram& MetricsRegistry::histogram(const std::string& name, const std::string& help, const std::vector<unsigned long long>& bounds, double scale)
+{
+    std::lock_guard<std::mutex> lock(metrics_mutex);
+
+    for (const std::unique_ptr<Histogram>& histogram: histograms) {
+        if (histogram->getName() == name) {
+            return *histogram;
+        }
+    }
+
+    histograms.push_back(std::make_unique<Histogram>(name, help, bounds, scale));
+    return *histograms.back();
+}
+
+Counter& MetricsRegistry::counter(const std::string& name, const std::string& help)
+{
+    std::lock_guard<std::mutex> lock(metrics_mutex);
+
+    for (const std::unique_ptr<Counter>& counter: counters) {
+        if (counter->getName() == name) {
+            return *counter;
+        }
+    }
+
+    counters.push_back(std::make_unique<Counter>(name, help));
+    return *counters.back();
+}
+
+std::string MetricsRegistry::text()
+{
+    std::lock_guard<std::mutex> lock(metrics_mutex);
+    std::ostringstream s;
+
+    s << std::setprecision(15);
+
+    for (const std::unique_ptr<Histogram>& histogram: histograms) {
+        histogram->write(s);
+    }
+    for (const std::unique_ptr<Counter>& counter: counters) {
+        counter->write(s);
+    }
+
+    return s.str();
+}
+
+/*******************************************
+ * class Metrics
+ *******************************************/
+
+Metrics::Metrics() :
+    compile_duration(MetricsRegistry::instance().histogram("ants_compile_duration_seconds", "Time to compile a program.", LATENCY_BUCKETS_US, 1e-6)),
+    source_size(MetricsRegistry::instance().histogram("ants_compile_source_bytes", "Size of the compiled source.", SIZE_BUCKETS)),
+    bytecode_size(MetricsRegistry::instance().histogram("ants_compile_bytecode_bytes", "Size of the code of successful compilations.", SIZE_BUCKETS)),
+    compile_errors(MetricsRegistry::instance().counter("ants_compile_errors_total", "Compilations which failed.")),
+    execution_duration(MetricsRegistry::instance().histogram("ants_execution_duration_seconds", "Time from the start to the end of a program, including the waits between its time slices.", LATENCY_BUCKETS_US, 1e-6)),
+    executed_instructions(MetricsRegistry::instance().histogram("ants_execution_instructions", "Instructions executed by a program.", COUNT_BUCKETS)),
+    call_depth(MetricsRegistry::instance().histogram("ants_execution_peak_call_depth", "The deepest nesting of function calls of a program.", DEPTH_BUCKETS)),
+    memory_peak(MetricsRegistry::instance().histogram("ants_execution_peak_memory_bytes", "The most memory owned by a program at once.", SIZE_BUCKETS)),
+    instructions_total(MetricsRegistry::instance().counter("ants_instructions_executed_total", "Instructions executed by all programs.")),
+    execution_errors(MetricsRegistry::instance().counter("ants_execution_errors_total", "Programs which stopped with an error.")),
+    executions_cancelled(MetricsRegistry::instance().counter("ants_executions_cancelled_total", "Programs cancelled while running."))
+{
+}
+
+Metrics& Metrics::instance()
+{
+    static Metrics metrics;
+    return metrics;
+}
+
+void Metrics::recordCompile(long long compile_us, size_t source_bytes, size_t bytecode_bytes, bool ok)
+{
+    compile_duration.observe(compile_us);
+    source_size.observe(source_bytes);
+
+    if (ok) {
+        bytecode_size.observe(bytecode_bytes);
+    } else {
+        compile_errors.add();
+    }
+}
+
+void Metrics::recordExecution(long long execution_us, unsigned long long instructions, unsigned int peak_call_depth, size_t peak_memory, EExecStatus status)
+{
+    execution_duration.observe(execution_us);
+    executed_instructions.observe(instructions);
+    call_depth.observe(peak_call_depth);
+    memory_peak.observe(peak_memory);
+    instructions_total.add(instructions);
+
+    if (status == EExecStatus::EXEC_CANCELLED) {
+        executions_cancelled.add();
+    } else if (status != EExecStatus::OK_STOP) {
+        execution_errors.add();
+    }
+}
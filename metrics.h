@@ -0,0 +1,106 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <ostream>
+
+enum class EExecStatus;
+
+// A histogram of non-negative integer observations (microseconds, bytes, counts) with fixed bucket bounds.
+// 'observe' is lock-free and may be called from any thread.
+class Histogram
+{
+private:
+    std::string name;
+    std::string help;
+    std::vector<unsigned long long> bounds;     // The upper bounds of the buckets, ascending. The +Inf bucket is implicit.
+    double scale;                               // Converts the observations to the exported unit, e.g. 1e-6 for microseconds to seconds
+    std::unique_ptr<std::atomic<unsigned long long>[]> buckets;     // Not cumulative, one more than 'bounds'
+    std::atomic<unsigned long long> sum{ 0 };   // The count is the total of the buckets
+
+public:
+    Histogram(const std::string& name, const std::string& help, const std::vector<unsigned long long>& bounds, double scale);
+
+    void observe(unsigned long long value);
+    const std::string& getName() const { return name; }
+
+    // Writes the histogram in the Prometheus text format
+    void write(std::ostream& s) const;
+};
+
+// A monotonic counter. 'add' is lock-free.
+class Counter
+{
+private:
+    std::string name;
+    std::string help;
+    std::atomic<unsigned long long> value{ 0 };
+
+public:
+    Counter(const std::string& name, const std::string& help) : name(name), help(help) {}
+
+    void add(unsigned long long n = 1) { value.fetch_add(n, std::memory_order_relaxed); }
+    const std::string& getName() const { return name; }
+
+    void write(std::ostream& s) const;
+};
+
+// The process-wide set of metrics. Metrics are registered once and live as long as the process.
+// Only the registration and 'text' take the lock, updating a metric doesn't.
+class MetricsRegistry
+{
+private:
+    std::vector<std::unique_ptr<Histogram>> histograms;
+    std::vector<std::unique_ptr<Counter>> counters;
+    std::mutex metrics_mutex;
+
+    MetricsRegistry() {}
+
+public:
+    MetricsRegistry(const MetricsRegistry&) = delete;
+    MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+    static MetricsRegistry& instance();
+
+    // Registers the metric on the first call. Later calls with the same name return the registered metric.
+    Histogram& histogram(const std::string& name, const std::string& help, const std::vector<unsigned long long>& bounds, double scale = 1.0);
+    Counter& counter(const std::string& name, const std::string& help);
+
+    // All metrics in the Prometheus text exposition format
+    std::string text();
+};
+
+// The metrics of compilations and program executions
+class Metrics
+{
+private:
+    Histogram& compile_duration;
+    Histogram& source_size;
+    Histogram& bytecode_size;
+    Counter& compile_errors;
+    Histogram& execution_duration;
+    Histogram& executed_instructions;
+    Histogram& call_depth;
+    Histogram& memory_peak;
+    Counter& instructions_total;
+    Counter& execution_errors;
+    Counter& executions_cancelled;
+
+    Metrics();
+
+public:
+    Metrics(const Metrics&) = delete;
+    Metrics& operator=(const Metrics&) = delete;
+
+    // Registers the metrics on the first call, so they're exported before anything is recorded
+    static Metrics& instance();
+
+    void recordCompile(long long compile_us, size_t source_bytes, size_t bytecode_bytes, bool ok);
+    void recordExecution(long long execution_us, unsigned long long instructions, unsigned int peak_call_depth, size_t peak_memory, EExecStatus status);
+};
+
+#endif // METRICS_H
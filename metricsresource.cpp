@@ -0,0 +1,21 @@
+#include "metricsresource.h"
+#include "metrics.h"
+
+/*******************************************
+ * class MetricsResource
+ *******************************************/
+
+MetricsResource::MetricsResource()
+{
+}
+
+MetricsResource::~MetricsResource()
+{
+    beingDeleted();
+}
+
+void MetricsResource::handleRequest(const Wt::Http::Request& request, Wt::Http::Response& response)
+{
+    response.setMimeType("text/plain; version=0.0.4");
+    response.out() << MetricsRegistry::instance().text();
+}
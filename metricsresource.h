@@ -0,0 +1,18 @@
+#ifndef METRICSRESOURCE_H
+#define METRICSRESOURCE_H
+
+#include <Wt/WResource.h>
+#include <Wt/Http/Request.h>
+#include <Wt/Http/Response.h>
+
+// Serves the MetricsRegistry in the Prometheus text format. Registered with WServer::addResource.
+class MetricsResource : public Wt::WResource
+{
+public:
+    MetricsResource();
+    ~MetricsResource();
+
+    void handleRequest(const Wt::Http::Request& request, Wt::Http::Response& response) override;
+};
+
+#endif // METRICSRESOURCE_H
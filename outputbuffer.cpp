@@ -0,0 +1,78 @@
+#include "outputbuffer.h"
+#include <algorithm>
+#include <cstring>
+
+/*******************************************
+ * class OutputBuffer
+ *******************************************/
+
+OutputBuffer::OutputBuffer(size_t capacity) : capacity(std::max<size_t>(capacity, 1))
+{
+}
+
+bool OutputBuffer::writeLine(const std::string& text)
+{
+    std::lock_guard<std::mutex> lock(ring_mutex);
+    unsigned long long dropped_before = dropped;
+
+    if (ring.empty()) {
+        ring.resize(capacity);
+    }
+
+    write(text.data(), text.size());
+    write("\n", 1);
+
+    return dropped == dropped_before;
+}
+
+// Called with the lock held
+void OutputBuffer::write(const char* data, size_t length)
+{
+    // Only the tail of a text longer than the ring is kept
+    if (length > capacity) {
+        dropped += length - capacity;
+        data += length - capacity;
+        length = capacity;
+    }
+
+    if (size + length > capacity) {
+        size_t overflow = size + length - capacity;
+
+        dropped += overflow;
+        first = (first + overflow) % capacity;
+        size -= overflow;
+    }
+
+    size_t end = (first + size) % capacity;
+    size_t part = std::min(length, capacity - end);
+
+    memcpy(&ring[end], data, part);
+    memcpy(&ring[0], data + part, length - part);
+    size += length;
+}
+
+unsigned long long OutputBuffer::take(std::string& text)
+{
+    std::lock_guard<std::mutex> lock(ring_mutex);
+    size_t part = std::min(size, capacity - first);
+    unsigned long long ret = dropped;
+
+    text.clear();
+    if (size > 0) {
+        text.reserve(size);
+        text.append(&ring[first], part);
+        text.append(&ring[0], size - part);
+    }
+
+    first = 0;
+    size = 0;
+    dropped = 0;
+
+    return ret;
+}
+
+bool OutputBuffer::isEmpty() const
+{
+    std::lock_guard<std::mutex> lock(ring_mutex);
+    return size == 0 && dropped == 0;
+}
@@ -0,0 +1,35 @@
+#ifndef OUTPUTBUFFER_H
+#define OUTPUTBUFFER_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <mutex>
+
+// The output of one program execution. The VM writes it on the executing thread, the session takes it in batches.
+// A ring of at most 'capacity' bytes: when the reader falls behind, the oldest output is overwritten and counted
+// as dropped, so a chatty program can't take more memory than that. The ring is allocated by the first write.
+class OutputBuffer
+{
+private:
+    std::vector<char> ring;
+    size_t capacity;
+    size_t first{ 0 };                  // The position of the oldest byte
+    size_t size{ 0 };
+    unsigned long long dropped{ 0 };    // Bytes overwritten since the last 'take'
+    mutable std::mutex ring_mutex;
+
+    void write(const char* data, size_t length);
+
+public:
+    explicit OutputBuffer(size_t capacity);
+
+    // Writes the 'text' and a line break. Returns false if older output has been overwritten.
+    bool writeLine(const std::string& text);
+
+    // Moves the buffered output to 'text'. Returns the bytes dropped since the last call.
+    unsigned long long take(std::string& text);
+    bool isEmpty() const;
+};
+
+#endif // OUTPUTBUFFER_H
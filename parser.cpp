@@ -1,6 +1,12 @@
 #include "parser.h"
+#include "prelude.h"
+#include "compilepool.h"
+#include <thread>
+#include <atomic>
+#include <algorithm>
 #include <boost/algorithm/string.hpp>
 #include <boost/algorithm/string/predicate.hpp>
+#include <boost/functional/hash.hpp>
 
 const char* parseStatusDescription[] = {
     "PARSE_OK",
@@ -62,14 +68,7 @@ const char* parseStatusDescription[] = {
     "PARSE_ERROR_PRIMARY_EXPRESSION_MISSING_CLOSING_BRACKET"
 };
 
-const char terminal_symbols[] = ",+-*/()[]{}.<>!=?: \t\n";
-const int terminal_symbols_len = 21;
-
-const char* reservedWords[] = {
-    "and", "or", "not", "int", "float", "string", "boolean", "array", "of", "function"
-};
-
-Parser::Parser()
+Parser::Parser() : source(&tokenizer)
 {
 
 }
@@ -147,316 +146,249 @@ const std::string& Parser::maxDatatype(const std::string& datatype_1, const std:
     return UNKNOWN_DATATYPE;
 }
 
-
-bool Parser::isReserved(std::string const& s)
+const Token& Parser::token(unsigned int pos) const
 {
-    for(int i=0; i<sizeof(reservedWords)/sizeof(char*); i++) {
-        if (boost::iequals(s, reservedWords[i]))
-            return true;
-    }
+    const std::vector<Token>& tokens = source->getTokens();
 
-    // s not found in the list of reserved words
-    return false;
+    return pos < tokens.size() ? tokens[pos] : tokens.back(); // The last token is END_OF_FILE
 }
 
-bool Parser::check_symbol(std::string const& s, const CodeLocation& pos, char symbol)
+const CodeLocation& Parser::location(unsigned int pos) const
 {
-    return (s.length() > pos.pos) && (s[pos.pos] == symbol);
+    return token(pos).pos;
 }
 
-bool Parser::check_string(std::string const& s, CodeLocation& pos, std::string const& str)
+bool Parser::check_symbol(unsigned int pos, char symbol) const
 {
-    int str_len = str.length();
-
-    if (s.length() < pos.pos+str_len)
-        return false;
+    const Token& t = token(pos);
 
-    // TODO: handle UTF-8 comparision
-    for (int i=0; i<str_len; i++) {
-        
-        if (std::toupper(s[pos.pos+i]) != std::toupper(str[i]))
-            return false;
-    }
+    return t.type == ETokenType::SYMBOL && t.symbol == (unsigned char)symbol;
+}
 
-    pos.pos += str_len;
-    pos.col += str_len;
+bool Parser::check_symbol(unsigned int pos, const char* symbol) const
+{
+    const Token& t = token(pos);
 
-    return true;
+    return t.type == ETokenType::SYMBOL && t.symbol == Tokenizer::symbolCode(symbol);
 }
 
-bool Parser::isTerminal(std::string const& s, const CodeLocation& pos)
+// Consumes the keyword token
+bool Parser::check_keyword(unsigned int& pos, EKeyword keyword) const
 {
-    if (s.length() <= pos.pos) return true; // EOF is also terminal 
+    const Token& t = token(pos);
 
-    for(int i = 0; i<terminal_symbols_len; i++) {
-        if (s[pos.pos] == terminal_symbols[i])
-            return true;
+    if (t.type == ETokenType::IDENTIFIER && t.keyword == keyword) {
+        pos++;
+        return true;
     }
 
     return false;
 }
 
-// Consume whitespaces
-void Parser::whitespace(std::string const& s, CodeLocation& pos)
+// Consumes the keyword of a simple datatype and returns its code: 'i', 'f', 's', 'b'. Returns 0 for other tokens.
+char Parser::check_simple_datatype(unsigned int& pos) const
 {
-    int s_len = s.length();
-
-    while (s_len > pos.pos && (s[pos.pos] == ' ' || s[pos.pos] == '\t' || s[pos.pos] == '\n')) {
-        if (s[pos.pos] == '\n') {
-            pos.col = 0;
-            pos.row++;
-        }
-        else {
-            pos.col++;
+    const Token& t = token(pos);
+    char datatype = 0;
+
+    if (t.type == ETokenType::IDENTIFIER) {
+        switch (t.keyword) {
+            case EKeyword::INT: datatype = 'i'; break;
+            case EKeyword::FLOAT: datatype = 'f'; break;
+            case EKeyword::STRING: datatype = 's'; break;
+            case EKeyword::BOOLEAN: datatype = 'b'; break;
+            default: break;
         }
+    }
 
-        pos.pos++;
+    if (datatype != 0) {
+        pos++;
     }
+
+    return datatype;
 }
 
-bool Parser::identifier_first_char(std::string const& s, const CodeLocation& pos)
+// A statement is recognized by its first token, so 'translation_unit' never tries the statement rules one after another
+Parser::EStatement Parser::statement_type(unsigned int pos) const
 {
-    return (s.length() > pos.pos) 
-    && (   (s[pos.pos] >= 'A' && s[pos.pos] <='Z') 
-        || (s[pos.pos] >= 'a' && s[pos.pos] <='z') 
-        || s[pos.pos] == '_'
-       );
+    const Token& t = token(pos);
+
+    if (t.type == ETokenType::IDENTIFIER) {
+        switch (t.keyword) {
+        case EKeyword::INT:
+        case EKeyword::FLOAT:
+        case EKeyword::STRING:
+        case EKeyword::BOOLEAN:
+        case EKeyword::ARRAY:
+            return EStatement::VARIABLE_DECLARATION;
+        case EKeyword::FUNCTION:
+            return EStatement::FUNCTION_DEFINITION;
+        default:
+            return EStatement::ASSIGNMENT;
+        }
+    }
+
+    if (check_symbol(pos, '{')) {
+        return EStatement::BLOCK;
+    }
+    if (check_symbol(pos, '}')) {
+        return EStatement::BLOCK_END;
+    }
+
+    return EStatement::ASSIGNMENT;
 }
 
-bool Parser::identifier_char(std::string const& s, const CodeLocation& pos)
+// Failed rules only note the furthest failure. The ParseTrace tree is built on the diagnostic pass of a failed parse
+void Parser::trace_error(ParseTrace& parse_trace, ParseTrace& child_parse_trace, unsigned int pos, EParseStatus status)
 {
-    return (s.length() > pos.pos) 
-    && (   (s[pos.pos] >= 'A' && s[pos.pos] <='Z') 
-        || (s[pos.pos] >= 'a' && s[pos.pos] <='z') 
-        || (s[pos.pos] >= '0' && s[pos.pos] <='9') 
-        || s[pos.pos] == '_'
-       );
+    furthest_failure.add(pos, status);
+
+    if (build_trace) {
+        child_parse_trace.pos = location(pos);
+        child_parse_trace.status = status;
+        parse_trace.suberrors.push_back(child_parse_trace);
+    }
 }
 
-bool Parser::digit(std::string const& s, CodeLocation& pos)
+void Parser::trace_error(ParseTrace& parse_trace, unsigned int pos, EParseStatus status)
 {
-    return (s.length() > pos.pos) 
-    &&     (s[pos.pos] >= '0' && s[pos.pos] <='9');
+    furthest_failure.add(pos, status);
+
+    if (build_trace) {
+        parse_trace.suberrors.push_back(ParseTrace(location(pos), status));
+    }
 }
 
-RetVal Parser::identifier(std::string const& s, CodeLocation& pos, ParseTrace& parse_trace, Variable& variable, const Scope& scope, Variables::EScopeRange scopeRange)
+RetVal Parser::identifier(unsigned int& pos, ParseTrace& parse_trace, Variable& variable, const Scope& scope, Variables::EScopeRange scopeRange)
 {
-    CodeLocation initial_pos = pos;
-    CodeLocation nonspace_initial_pos;
+    unsigned int initial_pos = pos;
     ParseTrace child_parse_trace;
     EParseStatus ret = EParseStatus::PARSE_ERROR_IDENTIFIER;
+    const Token& t = token(pos);
 
-    whitespace(s, pos);
-
-    nonspace_initial_pos = pos;
-
-    if (identifier_first_char(s, pos)) {
-        pos.pos++;
-        pos.col++;
-
-        while(identifier_char(s, pos)) {
-            pos.pos++;
-            pos.col++;
-        }
-
-        if (isTerminal(s, pos)) {
-            std::string id_str = s.substr(nonspace_initial_pos.pos, pos.pos-nonspace_initial_pos.pos);
-
-            if (isReserved(id_str)) {
-                ret = EParseStatus::PARSE_ERROR_IDENTIFIER_RESERVED_WORD;
-            } else {
-                variables.getVariable(scope, scopeRange, id_str, variable);
-                return RetVal::OK;
-            }
+    if (t.type == ETokenType::IDENTIFIER) {
+        if (Tokenizer::isReserved(t.keyword)) {
+            ret = EParseStatus::PARSE_ERROR_IDENTIFIER_RESERVED_WORD;
+        } else {
+            variables.getVariable(scope, scopeRange, source->getText(t), variable);
+            pos++;
+            return RetVal::OK;
         }
     }
 
     // We have an error
-    child_parse_trace.pos = initial_pos;
-    child_parse_trace.status = ret;
-    parse_trace.suberrors.push_back(child_parse_trace);
+    trace_error(parse_trace, child_parse_trace, initial_pos, ret);
 
     pos = initial_pos;
     return RetVal::FAIL_CONTINUE;
 }
 
-bool Parser::string_char(std::string const& s, CodeLocation& pos)
-{
-    if (s.length() > pos.pos && s[pos.pos] == '"') { // The end of the string
-        return false;
-    }
-
-    if ((s.length() > pos.pos + 1)
-        && s[pos.pos] == '\\' && (s[pos.pos + 1] == '"' || s[pos.pos + 1] == '\\')
-        ) {
-        pos.pos += 2;
-        pos.col += 2;
-
-        return true;
-    }
-
-    if (s.length() > pos.pos) { // Take everything between " and "
-        pos.pos++;
-        pos.col++;
-
-        return true;
-    }
-
-    return false;
-}
-
-RetVal Parser::string_expression(std::string const& s, CodeLocation& pos, ParseTrace& parse_trace, std::string& value)
+RetVal Parser::string_expression(unsigned int& pos, ParseTrace& parse_trace, std::string& value)
 {
-    CodeLocation initial_pos = pos;
+    unsigned int initial_pos = pos;
     ParseTrace child_parse_trace;
     RetVal ret = RetVal::FAIL_CONTINUE;
+    const Token& t = token(pos);
 
-    whitespace(s, pos);
+    if (t.type == ETokenType::STRING) {
+        value = source->getText(t);
+        pos++;
+        return RetVal::OK;
+    }
 
-    if (check_symbol(s, pos, '"')) {
+    if (t.type == ETokenType::INVALID && source->getText(t)[0] == '"') { // Unterminated string
         ret = RetVal::FAIL_STOP;
-
-        pos.pos++;
-        pos.col++;
-
-        while(string_char(s, pos)); // 'string_char' advances 'pos'
-
-        if (check_symbol(s, pos, '"')) {
-            pos.pos++;
-            pos.col++;
-
-            if (isTerminal(s, pos)) {
-                value = s.substr(initial_pos.pos+1, pos.pos-initial_pos.pos-2); // Quotation marks included so we need to remove them
-                return RetVal::OK;
-            }
-        }
     }
 
     // We have an error
-    child_parse_trace.pos = initial_pos;
-    child_parse_trace.status = EParseStatus::PARSE_ERROR_STRING_EXPRESSION;
-    parse_trace.suberrors.push_back(child_parse_trace);
+    trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_STRING_EXPRESSION);
 
     pos = initial_pos;
     return ret;
 }
 
-RetVal Parser::unsigned_integer(std::string const& s, CodeLocation& pos, ParseTrace& parse_trace, std::string& value)
+RetVal Parser::unsigned_integer(unsigned int& pos, ParseTrace& parse_trace, std::string& value)
 {
-    CodeLocation initial_pos = pos;
+    unsigned int initial_pos = pos;
     ParseTrace child_parse_trace;
 
-    whitespace(s, pos);
-
-    if (digit(s, pos)) {
-        pos.pos++;
-        pos.col++;
-
-        while (digit(s, pos)) {
-            pos.pos++;
-            pos.col++;
-        }
-
-        if (isTerminal(s, pos)) {
-            value = s.substr(initial_pos.pos, pos.pos-initial_pos.pos);
-            return RetVal::OK;
-        }
+    if (token(pos).type == ETokenType::INTEGER) {
+        value = source->getText(token(pos));
+        pos++;
+        return RetVal::OK;
     }
 
     // We have an error
-    child_parse_trace.pos = initial_pos;
-    child_parse_trace.status = EParseStatus::PARSE_ERROR_UNSIGNED_INTEGER;
-    parse_trace.suberrors.push_back(child_parse_trace);
+    trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_UNSIGNED_INTEGER);
 
     pos = initial_pos;
     return RetVal::FAIL_CONTINUE;
 }
 
-RetVal Parser::unsigned_float(std::string const& s, CodeLocation& pos, ParseTrace& parse_trace, std::string& value)
+RetVal Parser::unsigned_float(unsigned int& pos, ParseTrace& parse_trace, std::string& value)
 {
-    CodeLocation initial_pos = pos;
+    unsigned int initial_pos = pos;
     ParseTrace child_parse_trace;
     RetVal ret = RetVal::FAIL_CONTINUE;
+    const Token& t = token(pos);
 
-    whitespace(s, pos);
-
-    if ((ret = unsigned_integer(s, pos, child_parse_trace, value)) == RetVal::OK) {
-        ret = RetVal::FAIL_CONTINUE;
-
-        if (check_symbol(s, pos, '.')) {
-            ret = RetVal::FAIL_STOP;
-
-            pos.pos++;
-            pos.col++;
+    if (t.type == ETokenType::FLOAT) {
+        value = source->getText(t);
+        pos++;
+        return RetVal::OK;
+    }
 
-            if (unsigned_integer(s, pos, child_parse_trace, value) == RetVal::OK) {
-                if (isTerminal(s, pos)) {
-                    value = s.substr(initial_pos.pos, pos.pos-initial_pos.pos);
-                    return RetVal::OK;
-                }
-            }
-        }
+    if (t.type == ETokenType::INVALID && std::isdigit((unsigned char)source->getText(t)[0])) { // Malformed number, e.g. "1."
+        ret = RetVal::FAIL_STOP;
     }
 
     // We have an error
-    child_parse_trace.pos = initial_pos;
-    child_parse_trace.status = EParseStatus::PARSE_ERROR_UNSIGNED_FLOAT;
-    parse_trace.suberrors.push_back(child_parse_trace);
+    trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_UNSIGNED_FLOAT);
 
     pos = initial_pos;
     return ret;
 }
 
-RetVal Parser::boolean_value(std::string const& s, CodeLocation& pos, ParseTrace& parse_trace, std::string& value)
+RetVal Parser::boolean_value(unsigned int& pos, ParseTrace& parse_trace, std::string& value)
 {
-    CodeLocation initial_pos = pos;
+    unsigned int initial_pos = pos;
     ParseTrace child_parse_trace;
 
-    whitespace(s, pos);
-
-    if (check_string(s, pos, "true")) {
-        if (isTerminal(s, pos)) {
-            value = "true";
-            return RetVal::OK;
-        }
-    } else if (check_string(s, pos, "false")) {
-        if (isTerminal(s, pos)) {
-            value = "false";
-            return RetVal::OK;
-        }
+    if (check_keyword(pos, EKeyword::TRUE_VALUE)) {
+        value = "true";
+        return RetVal::OK;
+    } else if (check_keyword(pos, EKeyword::FALSE_VALUE)) {
+        value = "false";
+        return RetVal::OK;
     }
 
     // We have an error
-    child_parse_trace.pos = initial_pos;
-    child_parse_trace.status = EParseStatus::PARSE_ERROR_BOOLEAN_VALUE;
-    parse_trace.suberrors.push_back(child_parse_trace);
+    trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_BOOLEAN_VALUE);
 
     pos = initial_pos;
     return RetVal::FAIL_CONTINUE;
 }
 
-RetVal Parser::literals(std::string const& s, CodeLocation& pos, ParseTrace& parse_trace, EAssignmentPosition assign_pos, Bytecode& bytecode, std::string& datatype)
+RetVal Parser::literals(unsigned int& pos, ParseTrace& parse_trace, EAssignmentPosition assign_pos, Bytecode& bytecode, std::string& datatype)
 {
-    CodeLocation initial_pos = pos;
+    unsigned int initial_pos = pos;
     ParseTrace child_parse_trace;
     std::string bytecode_primary;
     Variable variable;
     RetVal ret;
 
-    whitespace(s, pos);
-
     if (assign_pos == LEFT) {
         ret = RetVal::FAIL_STOP;
     }
     else { // RIGHT
-        if ((ret = string_expression(s, pos, child_parse_trace, bytecode_primary)) == RetVal::OK) {
+        if ((ret = string_expression(pos, child_parse_trace, bytecode_primary)) == RetVal::OK) {
             datatype = "s";
             bytecode.PUTSTRING(bytecode_primary.data());
             return RetVal::OK;
         }
 
         if (ret == RetVal::FAIL_CONTINUE
-            && (ret = unsigned_float(s, pos, child_parse_trace, bytecode_primary)) == RetVal::OK)
+            && (ret = unsigned_float(pos, child_parse_trace, bytecode_primary)) == RetVal::OK)
         {
             datatype = "f";
             bytecode.PUTFLOAT(std::stold(bytecode_primary));
@@ -464,7 +396,7 @@ RetVal Parser::literals(std::string const& s, CodeLocation& pos, ParseTrace& par
         }
 
         if (ret == RetVal::FAIL_CONTINUE
-            && (ret = unsigned_integer(s, pos, child_parse_trace, bytecode_primary)) == RetVal::OK)
+            && (ret = unsigned_integer(pos, child_parse_trace, bytecode_primary)) == RetVal::OK)
         {
             datatype = "i";
             bytecode.PUTINT(std::stoll(bytecode_primary));
@@ -472,7 +404,7 @@ RetVal Parser::literals(std::string const& s, CodeLocation& pos, ParseTrace& par
         }
 
         if (ret == RetVal::FAIL_CONTINUE
-            && (ret = boolean_value(s, pos, child_parse_trace, bytecode_primary)) == RetVal::OK)
+            && (ret = boolean_value(pos, child_parse_trace, bytecode_primary)) == RetVal::OK)
         {
             datatype = "b";
             bytecode.PUTBOOLEAN(boost::iequals(bytecode_primary, "true"));
@@ -480,30 +412,24 @@ RetVal Parser::literals(std::string const& s, CodeLocation& pos, ParseTrace& par
         }
     }
    // We have an error
-    child_parse_trace.pos = initial_pos;
-    child_parse_trace.status = EParseStatus::PARSE_ERROR_LITERALS;
-    parse_trace.suberrors.push_back(child_parse_trace);
+    trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_LITERALS);
 
     pos = initial_pos;
 
     return ret;
 }
 
-RetVal Parser::primary_expression(std::string const& s, CodeLocation& pos, ParseTrace& parse_trace, EAssignmentPosition assign_pos, Bytecode& bytecode, std::string& datatype, const Scope& scope)
+RetVal Parser::primary_expression(unsigned int& pos, ParseTrace& parse_trace, EAssignmentPosition assign_pos, Bytecode& bytecode, std::string& datatype, const Scope& scope)
 {
-    CodeLocation initial_pos = pos;
+    unsigned int initial_pos = pos;
     ParseTrace child_parse_trace;
     std::string bytecode_primary;
     Variable variable;
     RetVal ret = RetVal::FAIL_CONTINUE;
 
-    whitespace(s, pos);
-
-    if (identifier(s, pos, child_parse_trace, variable, scope, Variables::EScopeRange::INHERITANCE) == RetVal::OK) {
+    if (identifier(pos, child_parse_trace, variable, scope, Variables::EScopeRange::INHERITANCE) == RetVal::OK) {
         if (variable.getIdx() == -1) {
-            child_parse_trace.pos = initial_pos;
-            child_parse_trace.status = EParseStatus::PARSE_ERROR_UNKNOWN_IDENTIFIER;
-            parse_trace.suberrors.push_back(child_parse_trace);
+            trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_UNKNOWN_IDENTIFIER);
 
             pos = initial_pos;
 
@@ -522,48 +448,38 @@ RetVal Parser::primary_expression(std::string const& s, CodeLocation& pos, Parse
                 }
 
                 do {
-                    whitespace(s, pos);
-
-                    if (check_symbol(s, pos, '[') ) {
-                        pos.pos++;
-                        pos.col++;
+                    if (check_symbol(pos, '[') ) {
+                        pos++;
                     
-                        whitespace(s, pos);
 
                         std::string datatype_args;
                         int arg_count = 0;
 
-                        ParseTrace array_index_trace(pos, EParseStatus::PARSE_ERROR_ARRAY_INDEX);
+                        unsigned int index_pos = pos;
+                        ParseTrace array_index_trace;
 
-                        if (argumentlist_expression(s, pos, array_index_trace, RIGHT, bytecode, datatype_args, arg_count, scope) == RetVal::OK) {
-                            whitespace(s, pos);
+                        if (argumentlist_expression(pos, array_index_trace, RIGHT, bytecode, datatype_args, arg_count, scope) == RetVal::OK) {
             
-                            if (check_symbol(s, pos, ']')) {
+                            if (check_symbol(pos, ']')) {
                                 if (process_array_datatype(datatype, datatype_args) ) {
-                                    pos.pos++;
-                                    pos.col++;
+                                    pos++;
 
                                     bytecode.PUTINDADDR(arg_count); // Takes array address from the stack and index value from the stack and puts the address of the resulting variable to the stack
                                     continue; // return PARSE_OK;
                                 } else {
                                     // We got an error
-                                    ParseTrace XXarray_index_trace(pos, EParseStatus::PARSE_ERROR_ARRAY_DATATYPE);
-                                    array_index_trace.suberrors.push_back(XXarray_index_trace);
-                                    child_parse_trace.suberrors.push_back(array_index_trace);
+                                    trace_error(array_index_trace, pos, EParseStatus::PARSE_ERROR_ARRAY_DATATYPE);
+                                    trace_error(child_parse_trace, array_index_trace, index_pos, EParseStatus::PARSE_ERROR_ARRAY_INDEX);
 
-                                    child_parse_trace.pos = initial_pos;
-                                    child_parse_trace.status = EParseStatus::PARSE_ERROR_PRIMARY_EXPRESSION;
-                                    parse_trace.suberrors.push_back(child_parse_trace);
+                                    trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_PRIMARY_EXPRESSION);
 
                                     pos = initial_pos;
                                     return RetVal::FAIL_STOP;
                                 }
                             }
                             else {
-                                child_parse_trace.pos = initial_pos;
-                                child_parse_trace.status = EParseStatus::PARSE_ERROR_PRIMARY_EXPRESSION_MISSING_CLOSING_BRACKET;
-                                child_parse_trace.suberrors.push_back(array_index_trace);
-                                parse_trace.suberrors.push_back(child_parse_trace);
+                                trace_error(child_parse_trace, array_index_trace, index_pos, EParseStatus::PARSE_ERROR_ARRAY_INDEX);
+                                trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_PRIMARY_EXPRESSION_MISSING_CLOSING_BRACKET);
 
                                 pos = initial_pos;
                                 return RetVal::FAIL_STOP;
@@ -571,10 +487,8 @@ RetVal Parser::primary_expression(std::string const& s, CodeLocation& pos, Parse
                         }
                         else {
                             
-                            child_parse_trace.pos = initial_pos;
-                            child_parse_trace.status = EParseStatus::PARSE_ERROR_PRIMARY_EXPRESSION;
-                            child_parse_trace.suberrors.push_back(array_index_trace);
-                            parse_trace.suberrors.push_back(child_parse_trace);
+                            trace_error(child_parse_trace, array_index_trace, index_pos, EParseStatus::PARSE_ERROR_ARRAY_INDEX);
+                            trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_PRIMARY_EXPRESSION);
 
                             pos = initial_pos;
                             return RetVal::FAIL_STOP;
@@ -588,35 +502,24 @@ RetVal Parser::primary_expression(std::string const& s, CodeLocation& pos, Parse
                     }
                 } while(true);
             } else if (variable.getEntityType() == Variable::EVariableTypes::BUILTIN_FUNCTION || variable.getEntityType() == Variable::EVariableTypes::FUNCTION) {
-                whitespace(s, pos);
-
-                if (assign_pos == RIGHT && check_symbol(s, pos, '(') ) {
-                    pos.pos++;
-                    pos.col++;
-
-                    whitespace(s, pos);
+                if (assign_pos == RIGHT && check_symbol(pos, '(') ) {
+                    pos++;
 
                     std::string datatype_args;
                     int arg_count;
 
-                    if (argumentlist_expression(s, pos, child_parse_trace, RIGHT, bytecode, datatype_args, arg_count, scope) == RetVal::OK) {
-                        whitespace(s, pos);
-
-                        if (check_symbol(s, pos, ')')) {
-                            pos.pos++;
-                            pos.col++;
+                    if (argumentlist_expression(pos, child_parse_trace, RIGHT, bytecode, datatype_args, arg_count, scope) == RetVal::OK) {
+                        if (check_symbol(pos, ')')) {
+                            pos++;
 
                             if (isDatatypeConsistentFunctionArguments(variable.getType_fun_params(), datatype_args)) {
                                 datatype = variable.getType();
                                 bytecode.CALL(variable.getIdx());
                                 return RetVal::OK;
                             } else {
-                                ParseTrace argument_list_trace(pos, EParseStatus::PARSE_ERROR_INCOMPATIBLE_FUNCTION_ARGUMENTS);
-                                child_parse_trace.suberrors.push_back(argument_list_trace);
+                                trace_error(child_parse_trace, pos, EParseStatus::PARSE_ERROR_INCOMPATIBLE_FUNCTION_ARGUMENTS);
 
-                                child_parse_trace.pos = initial_pos;
-                                child_parse_trace.status = EParseStatus::PARSE_ERROR_PRIMARY_EXPRESSION;
-                                parse_trace.suberrors.push_back(child_parse_trace);
+                                trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_PRIMARY_EXPRESSION);
 
                                 pos = initial_pos;
                                 return RetVal::FAIL_STOP;
@@ -624,12 +527,9 @@ RetVal Parser::primary_expression(std::string const& s, CodeLocation& pos, Parse
                         }
                     }
 
-                    ParseTrace argument_list_trace(pos, EParseStatus::PARSE_ERROR_ARGUMENT_LIST);
-                    child_parse_trace.suberrors.push_back(argument_list_trace);
+                    trace_error(child_parse_trace, pos, EParseStatus::PARSE_ERROR_ARGUMENT_LIST);
 
-                    child_parse_trace.pos = initial_pos;
-                    child_parse_trace.status = EParseStatus::PARSE_ERROR_PRIMARY_EXPRESSION;
-                    parse_trace.suberrors.push_back(child_parse_trace);
+                    trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_PRIMARY_EXPRESSION);
 
                     pos = initial_pos;
                     return RetVal::FAIL_STOP;
@@ -638,17 +538,13 @@ RetVal Parser::primary_expression(std::string const& s, CodeLocation& pos, Parse
                     bytecode.PUTDADDR(variable.getIdx());
                     return RetVal::OK;
                 } else {
-                    child_parse_trace.pos = initial_pos;
-                    child_parse_trace.status = EParseStatus::PARSE_ERROR_MISSING_FUNCTION_ARGUMENT_LIST;
-                    parse_trace.suberrors.push_back(child_parse_trace);
+                    trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_MISSING_FUNCTION_ARGUMENT_LIST);
 
                     pos = initial_pos;
                     return RetVal::FAIL_STOP;
                 }
             } else {
-                child_parse_trace.pos = initial_pos;
-                child_parse_trace.status = EParseStatus::PARSE_ERROR_UNRECOGNIZED_IDENTIFIER_TYPE;
-                parse_trace.suberrors.push_back(child_parse_trace);
+                trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_UNRECOGNIZED_IDENTIFIER_TYPE);
 
                 pos = initial_pos;
                 return RetVal::FAIL_STOP;
@@ -657,43 +553,34 @@ RetVal Parser::primary_expression(std::string const& s, CodeLocation& pos, Parse
     }
 
     // We have an error
-    child_parse_trace.pos = initial_pos;
-    child_parse_trace.status = EParseStatus::PARSE_ERROR_PRIMARY_EXPRESSION;
-    parse_trace.suberrors.push_back(child_parse_trace);
+    trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_PRIMARY_EXPRESSION);
 
     pos = initial_pos;
     return ret;
 }
 
-RetVal Parser::argumentlist_expression(std::string const& s, CodeLocation& pos, ParseTrace& parse_trace, EAssignmentPosition assign_pos, Bytecode& bytecode, std::string& datatype, int& param_count, const Scope& scope)
+RetVal Parser::argumentlist_expression(unsigned int& pos, ParseTrace& parse_trace, EAssignmentPosition assign_pos, Bytecode& bytecode, std::string& datatype, int& param_count, const Scope& scope)
 {
-    CodeLocation initial_pos = pos;
+    unsigned int initial_pos = pos;
     ParseTrace child_parse_trace;
     std::string datatype_args;
     std::string ret_datatype;
     int count = 0;
 
     do {
-        whitespace(s, pos);
-
-        if (conditional_expression(s, pos, child_parse_trace, assign_pos, bytecode, datatype_args, scope) != RetVal::OK) {
-            child_parse_trace.pos = initial_pos;
-            child_parse_trace.status = EParseStatus::PARSE_ERROR_ARGUMENTLIST_EXPRESSION;
-            parse_trace.suberrors.push_back(child_parse_trace);
+        if (conditional_expression(pos, child_parse_trace, assign_pos, bytecode, datatype_args, scope) != RetVal::OK) {
+            trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_ARGUMENTLIST_EXPRESSION);
 
             pos = initial_pos;
             return RetVal::FAIL_STOP;
         }
 
-        whitespace(s, pos);
-
         ret_datatype += datatype_args;
         count++;
 
-        if (check_symbol(s, pos, ',')) {
+        if (check_symbol(pos, ',')) {
             ret_datatype += ",";
-            pos.pos++;
-            pos.col++;
+            pos++;
         } else {
             break;
         }
@@ -714,49 +601,39 @@ bool Parser::process_array_datatype(std::string& datatype, const std::string& in
     return false;
 }
 
-RetVal Parser::postfix_expression(std::string const& s, CodeLocation& pos, ParseTrace& parse_trace, EAssignmentPosition assign_pos, Bytecode& bytecode, std::string& datatype, const Scope& scope)
+RetVal Parser::postfix_expression(unsigned int& pos, ParseTrace& parse_trace, EAssignmentPosition assign_pos, Bytecode& bytecode, std::string& datatype, const Scope& scope)
 {
-    CodeLocation initial_pos = pos;
+    unsigned int initial_pos = pos;
     ParseTrace child_parse_trace;
     RetVal ret;
     EAction ret_action = EAction::CONTINUE;
 
-    whitespace(s, pos);
-
     if (assign_pos == RIGHT) {
-        ret = literals(s, pos, child_parse_trace, assign_pos, bytecode, datatype);
+        ret = literals(pos, child_parse_trace, assign_pos, bytecode, datatype);
 
         switch (ret) {
         case RetVal::OK:
             return RetVal::OK;
         case RetVal::FAIL_STOP:
-            child_parse_trace.pos = initial_pos;
-            child_parse_trace.status = EParseStatus::PARSE_ERROR_POSTFIX_EXPRESSION;
-            parse_trace.suberrors.push_back(child_parse_trace);
+            trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_POSTFIX_EXPRESSION);
 
             pos = initial_pos;
             return RetVal::FAIL_STOP;
         case RetVal::FAIL_CONTINUE:
-            if (check_symbol(s, pos, '('))
+            if (check_symbol(pos, '('))
             {
-                pos.pos++;
-                pos.col++;
-
-                if ((ret = conditional_expression(s, pos, child_parse_trace, assign_pos, bytecode, datatype, scope)) == RetVal::OK) {
-                    whitespace(s, pos);
+                pos++;
 
-                    if (check_symbol(s, pos, ')')) {
-                        pos.pos++;
-                        pos.col++;
+                if ((ret = conditional_expression(pos, child_parse_trace, assign_pos, bytecode, datatype, scope)) == RetVal::OK) {
+                    if (check_symbol(pos, ')')) {
+                        pos++;
 
                         return RetVal::OK;
                     }
                 }
 
                 // We have an error
-                child_parse_trace.pos = initial_pos;
-                child_parse_trace.status = EParseStatus::PARSE_ERROR_POSTFIX_EXPRESSION;
-                parse_trace.suberrors.push_back(child_parse_trace);
+                trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_POSTFIX_EXPRESSION);
 
                 pos = initial_pos;
                 return RetVal::FAIL_STOP;
@@ -769,9 +646,8 @@ RetVal Parser::postfix_expression(std::string const& s, CodeLocation& pos, Parse
     // std::string scope_modificator;
     Scope primary_expr_scope(scope);
 
-    while (check_symbol(s, pos, '.')) {
-        pos.pos++;
-        pos.col++;
+    while (check_symbol(pos, '.')) {
+        pos++;
 
         ret_action = EAction::STOP;
 
@@ -782,10 +658,10 @@ RetVal Parser::postfix_expression(std::string const& s, CodeLocation& pos, Parse
     bool is_first = true;
 
     do {
-        if ((ret = primary_expression(s, pos, child_parse_trace, assign_pos, bytecode, datatype, is_first ? primary_expr_scope : scope)) == RetVal::OK) {
+        if ((ret = primary_expression(pos, child_parse_trace, assign_pos, bytecode, datatype, is_first ? primary_expr_scope : scope)) == RetVal::OK) {
             is_first = false;
 
-            if (check_symbol(s, pos, '.') ) {
+            if (check_symbol(pos, '.') ) {
                 ret_action = EAction::STOP;
 
                 continue;
@@ -798,87 +674,73 @@ RetVal Parser::postfix_expression(std::string const& s, CodeLocation& pos, Parse
     } while(true);
 
     // We have an error
-    child_parse_trace.pos = initial_pos;
-    child_parse_trace.status = EParseStatus::PARSE_ERROR_POSTFIX_EXPRESSION;
-    parse_trace.suberrors.push_back(child_parse_trace);
+    trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_POSTFIX_EXPRESSION);
 
     pos = initial_pos;
     return ret_action == EAction::STOP ? RetVal::FAIL_STOP : ret;
 }
 
-RetVal Parser::unary_operator(std::string const& s, CodeLocation& pos, ParseTrace& parse_trace, std::string& datatype)
+RetVal Parser::unary_operator(unsigned int& pos, ParseTrace& parse_trace, std::string& datatype)
 {
-    CodeLocation initial_pos = pos;
+    unsigned int initial_pos = pos;
     ParseTrace child_parse_trace;
 
-    whitespace(s, pos);
-
-    if ( check_symbol(s, pos, '-') ) {
+    if ( check_symbol(pos, '-') ) {
         datatype = "n";
-        pos.pos++;
-        pos.col++;
+        pos++;
 
         return RetVal::OK;
-    } else if ( check_string(s, pos, "not") ) {
+    } else if ( check_keyword(pos, EKeyword::NOT) ) {
         datatype = "b";
         return RetVal::OK;
     }
     // This is not an assignment operator
 
-    child_parse_trace.pos = initial_pos;
-    child_parse_trace.status = EParseStatus::PARSE_ERROR_UNARY_OPERATOR;
-    parse_trace.suberrors.push_back(child_parse_trace);
+    trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_UNARY_OPERATOR);
 
     pos = initial_pos;
     return RetVal::FAIL_CONTINUE;
 }
 
-RetVal Parser::unary_expression(std::string const& s, CodeLocation& pos, ParseTrace& parse_trace, EAssignmentPosition assign_pos, Bytecode& bytecode, std::string& datatype, const Scope& scope)
+RetVal Parser::unary_expression(unsigned int& pos, ParseTrace& parse_trace, EAssignmentPosition assign_pos, Bytecode& bytecode, std::string& datatype, const Scope& scope)
 {
-    CodeLocation initial_pos = pos;
+    unsigned int initial_pos = pos;
     ParseTrace child_parse_trace;
     std::string operator_datatype;
     EParseStatus ret = EParseStatus::PARSE_ERROR_UNARY_EXPRESSION;
     RetVal child_ret;
     EAction ret_action = EAction::CONTINUE;
 
-    whitespace(s, pos);
     if (assign_pos == LEFT) {
-        if ((child_ret = postfix_expression(s, pos, child_parse_trace, assign_pos, bytecode, datatype, scope)) == RetVal::OK)
+        if ((child_ret = postfix_expression(pos, child_parse_trace, assign_pos, bytecode, datatype, scope)) == RetVal::OK)
         {
             return RetVal::OK;
         }
         else {
-            child_parse_trace.pos = initial_pos;
-            child_parse_trace.status = EParseStatus::PARSE_ERROR_UNARY_EXPRESSION;;
-            parse_trace.suberrors.push_back(child_parse_trace);
+            trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_UNARY_EXPRESSION);
 
             pos = initial_pos;
             return child_ret;
         }
     }
     else { // RIGHT
-        if ((child_ret = unary_operator(s, pos, child_parse_trace, operator_datatype)) == RetVal::OK) {
+        if ((child_ret = unary_operator(pos, child_parse_trace, operator_datatype)) == RetVal::OK) {
             ret_action = EAction::STOP;
 
-            if ((child_ret = unary_expression(s, pos, child_parse_trace, assign_pos, bytecode, datatype, scope)) == RetVal::OK) {
+            if ((child_ret = unary_expression(pos, child_parse_trace, assign_pos, bytecode, datatype, scope)) == RetVal::OK) {
                 if (isDatatypeConsistent(operator_datatype, datatype)) {
                     bytecode.NEG();
                     return RetVal::OK;
                 }
                 else {
-                    child_parse_trace.pos = initial_pos;
-                    child_parse_trace.status = EParseStatus::PARSE_ERROR_DATATYPE_MISMATCH;
-                    parse_trace.suberrors.push_back(child_parse_trace);
+                    trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_DATATYPE_MISMATCH);
 
                     pos = initial_pos;
                     return RetVal::FAIL_STOP;
                 }
             }
             else {
-                child_parse_trace.pos = initial_pos;
-                child_parse_trace.status = EParseStatus::PARSE_ERROR_UNARY_EXPRESSION;;
-                parse_trace.suberrors.push_back(child_parse_trace);
+                trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_UNARY_EXPRESSION);
 
                 pos = initial_pos;
                 return RetVal::FAIL_STOP;
@@ -886,14 +748,12 @@ RetVal Parser::unary_expression(std::string const& s, CodeLocation& pos, ParseTr
         }
         else {
             if (child_ret == RetVal::FAIL_CONTINUE
-                && (child_ret = postfix_expression(s, pos, child_parse_trace, assign_pos, bytecode, datatype, scope)) == RetVal::OK)
+                && (child_ret = postfix_expression(pos, child_parse_trace, assign_pos, bytecode, datatype, scope)) == RetVal::OK)
             {
                 return RetVal::OK;
             }
             else {
-                child_parse_trace.pos = initial_pos;
-                child_parse_trace.status = EParseStatus::PARSE_ERROR_UNARY_EXPRESSION;;
-                parse_trace.suberrors.push_back(child_parse_trace);
+                trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_UNARY_EXPRESSION);
 
                 pos = initial_pos;
                 return child_ret;
@@ -901,33 +761,27 @@ RetVal Parser::unary_expression(std::string const& s, CodeLocation& pos, ParseTr
         }
     }
     // Actually we shouldn't be here
-    child_parse_trace.pos = initial_pos;
-    child_parse_trace.status = EParseStatus::PARSE_ERROR_UNARY_EXPRESSION;;
-    parse_trace.suberrors.push_back(child_parse_trace);
+    trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_UNARY_EXPRESSION);
 
     pos = initial_pos;
     return RetVal::FAIL_CONTINUE;
 }
 
-RetVal Parser::mult_operator(std::string const& s, CodeLocation& pos, ParseTrace& parse_trace, EArithOperators& arith_operator)
+RetVal Parser::mult_operator(unsigned int& pos, ParseTrace& parse_trace, EArithOperators& arith_operator)
 {
-    CodeLocation initial_pos = pos;
+    unsigned int initial_pos = pos;
     ParseTrace child_parse_trace;
 
-    whitespace(s, pos);
-
-    if ( check_symbol(s, pos, '*') ) {
-        pos.pos++;
-        pos.col++;
+    if ( check_symbol(pos, '*') ) {
+        pos++;
 
         arith_operator = MUL;
 
         return RetVal::OK;
     }
 
-    if ( check_symbol(s, pos, '/') ) {
-        pos.pos++;
-        pos.col++;
+    if ( check_symbol(pos, '/') ) {
+        pos++;
 
         arith_operator = DIV;
 
@@ -936,17 +790,15 @@ RetVal Parser::mult_operator(std::string const& s, CodeLocation& pos, ParseTrace
 
     // This is not an assignment operator
 
-    child_parse_trace.pos = initial_pos;
-    child_parse_trace.status = EParseStatus::PARSE_ERROR_MULT_OPERATOR;
-    parse_trace.suberrors.push_back(child_parse_trace);
+    trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_MULT_OPERATOR);
 
     pos = initial_pos;
     return RetVal::FAIL_CONTINUE;
 }
 
-RetVal Parser::mult_expression(std::string const& s, CodeLocation& pos, ParseTrace& parse_trace, EAssignmentPosition assign_pos, Bytecode& bytecode, std::string& datatype, const Scope& scope)
+RetVal Parser::mult_expression(unsigned int& pos, ParseTrace& parse_trace, EAssignmentPosition assign_pos, Bytecode& bytecode, std::string& datatype, const Scope& scope)
 {
-    CodeLocation initial_pos = pos;
+    unsigned int initial_pos = pos;
     ParseTrace child_parse_trace;
     bool put_mul = false;
     std::string datatype_pre = "-1";
@@ -956,12 +808,8 @@ RetVal Parser::mult_expression(std::string const& s, CodeLocation& pos, ParseTra
     RetVal child_ret;
 
     do {
-        whitespace(s, pos);
-
-        if ((child_ret = unary_expression(s, pos, child_parse_trace, assign_pos, bytecode, datatype_cur, scope)) != RetVal::OK) {
-            child_parse_trace.pos = initial_pos;
-            child_parse_trace.status = EParseStatus::PARSE_ERROR_MULT_EXPRESSION;
-            parse_trace.suberrors.push_back(child_parse_trace);
+        if ((child_ret = unary_expression(pos, child_parse_trace, assign_pos, bytecode, datatype_cur, scope)) != RetVal::OK) {
+            trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_MULT_EXPRESSION);
 
             pos = initial_pos;
             return ret_action == EAction::STOP ? RetVal::FAIL_STOP : child_ret;
@@ -977,16 +825,14 @@ RetVal Parser::mult_expression(std::string const& s, CodeLocation& pos, ParseTra
             }
 
             if ( !(isDatatypeNumeric(datatype_pre) && isDatatypeNumeric(datatype_cur)) ) {
-                child_parse_trace.pos = initial_pos;
-                child_parse_trace.status = EParseStatus::PARSE_ERROR_DATATYPE_MISMATCH;
-                parse_trace.suberrors.push_back(child_parse_trace);
+                trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_DATATYPE_MISMATCH);
 
                 pos = initial_pos;
                 return RetVal::FAIL_STOP;
             }
         }
 
-        if((child_ret = mult_operator(s, pos, child_parse_trace, arith_operator)) != RetVal::OK) {
+        if((child_ret = mult_operator(pos, child_parse_trace, arith_operator)) != RetVal::OK) {
             break;
         } else {
             put_mul = true;
@@ -999,25 +845,21 @@ RetVal Parser::mult_expression(std::string const& s, CodeLocation& pos, ParseTra
     return RetVal::OK;
 }
 
-RetVal Parser::additive_operator(std::string const& s, CodeLocation& pos, ParseTrace& parse_trace, EArithOperators& arith_operator)
+RetVal Parser::additive_operator(unsigned int& pos, ParseTrace& parse_trace, EArithOperators& arith_operator)
 {
-    CodeLocation initial_pos = pos;
+    unsigned int initial_pos = pos;
     ParseTrace child_parse_trace;
 
-    whitespace(s, pos);
-
-    if ( check_symbol(s, pos, '+') ) {
-        pos.pos++;
-        pos.col++;
+    if ( check_symbol(pos, '+') ) {
+        pos++;
 
         arith_operator = ADD;
 
         return RetVal::OK;
     }
 
-    if ( check_symbol(s, pos, '-') ) {
-        pos.pos++;
-        pos.col++;
+    if ( check_symbol(pos, '-') ) {
+        pos++;
 
         arith_operator = SUB;
 
@@ -1026,17 +868,15 @@ RetVal Parser::additive_operator(std::string const& s, CodeLocation& pos, ParseT
 
     // This is not an assignment operator
 
-    child_parse_trace.pos = initial_pos;
-    child_parse_trace.status = EParseStatus::PARSE_ERROR_ADDITIVE_OPERATOR;
-    parse_trace.suberrors.push_back(child_parse_trace);
+    trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_ADDITIVE_OPERATOR);
 
     pos = initial_pos;
     return RetVal::FAIL_CONTINUE;
 }
 
-RetVal Parser::additive_expression(std::string const& s, CodeLocation& pos, ParseTrace& parse_trace, EAssignmentPosition assign_pos, Bytecode& bytecode, std::string& datatype, const Scope& scope)
+RetVal Parser::additive_expression(unsigned int& pos, ParseTrace& parse_trace, EAssignmentPosition assign_pos, Bytecode& bytecode, std::string& datatype, const Scope& scope)
 {
-    CodeLocation initial_pos = pos;
+    unsigned int initial_pos = pos;
     ParseTrace child_parse_trace;
     bool put_add = false;
     std::string datatype_pre = "-1";
@@ -1046,12 +886,8 @@ RetVal Parser::additive_expression(std::string const& s, CodeLocation& pos, Pars
     RetVal child_ret;
 
     do {
-        whitespace(s, pos);
-
-        if ((child_ret = mult_expression(s, pos, child_parse_trace, assign_pos, bytecode, datatype_cur, scope)) != RetVal::OK) {
-            child_parse_trace.pos = initial_pos;
-            child_parse_trace.status = EParseStatus::PARSE_ERROR_ADDITIVE_EXPRESSION;
-            parse_trace.suberrors.push_back(child_parse_trace);
+        if ((child_ret = mult_expression(pos, child_parse_trace, assign_pos, bytecode, datatype_cur, scope)) != RetVal::OK) {
+            trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_ADDITIVE_EXPRESSION);
 
             pos = initial_pos;
             return ret_action == EAction::STOP ? RetVal::FAIL_STOP : child_ret;
@@ -1068,16 +904,14 @@ RetVal Parser::additive_expression(std::string const& s, CodeLocation& pos, Pars
                 (isDatatypeNumeric(datatype_pre) && isDatatypeNumeric(datatype_cur))
                 || (datatype_pre == "s" && datatype_cur == "s")
                 ) ) {
-                child_parse_trace.pos = initial_pos;
-                child_parse_trace.status = EParseStatus::PARSE_ERROR_DATATYPE_MISMATCH;
-                parse_trace.suberrors.push_back(child_parse_trace);
+                trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_DATATYPE_MISMATCH);
 
                 pos = initial_pos;
                 return RetVal::FAIL_STOP;
             }
         }
 
-        if((child_ret = additive_operator(s, pos, child_parse_trace, arith_operator)) != RetVal::OK) {
+        if((child_ret = additive_operator(pos, child_parse_trace, arith_operator)) != RetVal::OK) {
             break;
         } else {
             ret_action = EAction::STOP;
@@ -1090,68 +924,58 @@ RetVal Parser::additive_expression(std::string const& s, CodeLocation& pos, Pars
     return RetVal::OK;
 }
 
-RetVal Parser::relation_operator(std::string const& s, CodeLocation& pos, ParseTrace& parse_trace, Bytecode& bytecode)
+RetVal Parser::relation_operator(unsigned int& pos, ParseTrace& parse_trace, Bytecode& bytecode)
 {
-    CodeLocation initial_pos = pos;
+    unsigned int initial_pos = pos;
     ParseTrace child_parse_trace;
 
-    whitespace(s, pos);
-
-    if ( check_symbol(s, pos, '=') && check_symbol(s, pos+1, '=')) {
-        pos.pos += 2;
-        pos.col += 2;
+    if ( check_symbol(pos, "==")) {
+        pos++;
         bytecode.EQUAL();
         return RetVal::OK;
     }
 
-    if (check_symbol(s, pos, '!') && check_symbol(s, pos+1, '=')) {
-        pos.pos += 2;
-        pos.col += 2;
+    if (check_symbol(pos, "!=")) {
+        pos++;
         bytecode.NOTEQUAL();
         return RetVal::OK;
     }
 
-    if (check_symbol(s, pos, '<') && check_symbol(s, pos+1, '=')) {
-        pos.pos += 2;
-        pos.col += 2;
+    if (check_symbol(pos, "<=")) {
+        pos++;
         bytecode.LESSEQUAL();
         return RetVal::OK;
     }
 
-    if (check_symbol(s, pos, '>') && check_symbol(s, pos+1, '=')) {
-        pos.pos += 2;
-        pos.col += 2;
+    if (check_symbol(pos, ">=")) {
+        pos++;
         bytecode.GREATEREQUAL();
         return RetVal::OK;
     }
 
-    if (check_symbol(s, pos, '<') ) {
-        pos.pos++;
-        pos.col++;
+    if (check_symbol(pos, '<') ) {
+        pos++;
         bytecode.LESS();
         return RetVal::OK;
     }
 
-    if (check_symbol(s, pos, '>') ) {
-        pos.pos++;
-        pos.col++;
+    if (check_symbol(pos, '>') ) {
+        pos++;
         bytecode.GREATER();
         return RetVal::OK;
     }
 
     // This is not an assignment operator
 
-    child_parse_trace.pos = initial_pos;
-    child_parse_trace.status = EParseStatus::PARSE_ERROR_RELATION_OPERATOR;
-    parse_trace.suberrors.push_back(child_parse_trace);
+    trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_RELATION_OPERATOR);
 
     pos = initial_pos;
     return RetVal::FAIL_CONTINUE;
 }
 
-RetVal Parser::relational_expression(std::string const& s, CodeLocation& pos, ParseTrace& parse_trace, EAssignmentPosition assign_pos, Bytecode& bytecode, std::string& datatype, const Scope& scope)
+RetVal Parser::relational_expression(unsigned int& pos, ParseTrace& parse_trace, EAssignmentPosition assign_pos, Bytecode& bytecode, std::string& datatype, const Scope& scope)
 {
-    CodeLocation initial_pos = pos;
+    unsigned int initial_pos = pos;
     ParseTrace child_parse_trace;
     std::string datatype_left;
     std::string datatype_right;
@@ -1159,31 +983,23 @@ RetVal Parser::relational_expression(std::string const& s, CodeLocation& pos, Pa
     RetVal child_ret;
     EAction ret_action = EAction::CONTINUE;
 
-    whitespace(s, pos);
-
-    if ((child_ret = additive_expression(s, pos, child_parse_trace, assign_pos, bytecode, datatype_left, scope)) != RetVal::OK) {
-        child_parse_trace.pos = initial_pos;
-        child_parse_trace.status = EParseStatus::PARSE_ERROR_RELATIONAL_EXPRESSION;
-        parse_trace.suberrors.push_back(child_parse_trace);
+    if ((child_ret = additive_expression(pos, child_parse_trace, assign_pos, bytecode, datatype_left, scope)) != RetVal::OK) {
+        trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_RELATIONAL_EXPRESSION);
 
         pos = initial_pos;
         return child_ret;
     }
 
-    if(relation_operator(s, pos, child_parse_trace, bytecode_relation) == RetVal::OK) {
-        if (additive_expression(s, pos, child_parse_trace, assign_pos, bytecode, datatype_right, scope) != RetVal::OK) {
-            child_parse_trace.pos = initial_pos;
-            child_parse_trace.status = EParseStatus::PARSE_ERROR_RELATIONAL_EXPRESSION;
-            parse_trace.suberrors.push_back(child_parse_trace);
+    if(relation_operator(pos, child_parse_trace, bytecode_relation) == RetVal::OK) {
+        if (additive_expression(pos, child_parse_trace, assign_pos, bytecode, datatype_right, scope) != RetVal::OK) {
+            trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_RELATIONAL_EXPRESSION);
 
             pos = initial_pos;
             return RetVal::FAIL_STOP;
         }
 
         if (!isDatatypeConsistent(datatype_left, datatype_right)) {
-            child_parse_trace.pos = initial_pos;
-            child_parse_trace.status = EParseStatus::PARSE_ERROR_DATATYPE_MISMATCH;
-            parse_trace.suberrors.push_back(child_parse_trace);
+            trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_DATATYPE_MISMATCH);
 
             pos = initial_pos;
             return RetVal::FAIL_STOP;
@@ -1198,9 +1014,9 @@ RetVal Parser::relational_expression(std::string const& s, CodeLocation& pos, Pa
     return RetVal::OK;
 }
 
-RetVal Parser::logical_and_expression(std::string const& s, CodeLocation& pos, ParseTrace& parse_trace, EAssignmentPosition assign_pos, Bytecode& bytecode, std::string& datatype, const Scope& scope)
+RetVal Parser::logical_and_expression(unsigned int& pos, ParseTrace& parse_trace, EAssignmentPosition assign_pos, Bytecode& bytecode, std::string& datatype, const Scope& scope)
 {
-    CodeLocation initial_pos = pos;
+    unsigned int initial_pos = pos;
     ParseTrace child_parse_trace;
     bool put_mul = false;
     std::string datatype_pre = "-1";
@@ -1209,12 +1025,8 @@ RetVal Parser::logical_and_expression(std::string const& s, CodeLocation& pos, P
     RetVal child_ret;
 
     do {
-        whitespace(s, pos);
-
-        if ((child_ret = relational_expression(s, pos, child_parse_trace, assign_pos, bytecode, datatype_cur, scope)) != RetVal::OK) {
-            child_parse_trace.pos = initial_pos;
-            child_parse_trace.status = EParseStatus::PARSE_ERROR_LOGICAL_AND_EXPRESSION;
-            parse_trace.suberrors.push_back(child_parse_trace);
+        if ((child_ret = relational_expression(pos, child_parse_trace, assign_pos, bytecode, datatype_cur, scope)) != RetVal::OK) {
+            trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_LOGICAL_AND_EXPRESSION);
 
             pos = initial_pos;
             return ret_action == EAction::STOP ? RetVal::FAIL_STOP : child_ret;
@@ -1225,9 +1037,7 @@ RetVal Parser::logical_and_expression(std::string const& s, CodeLocation& pos, P
             bytecode.MUL();
 
             if (datatype_pre != "b" || datatype_cur != "b") {
-                child_parse_trace.pos = initial_pos;
-                child_parse_trace.status = EParseStatus::PARSE_ERROR_EXPECTED_BOOLEAN_DATATYPE;
-                parse_trace.suberrors.push_back(child_parse_trace);
+                trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_EXPECTED_BOOLEAN_DATATYPE);
 
                 pos = initial_pos;
                 return RetVal::FAIL_STOP;
@@ -1235,9 +1045,7 @@ RetVal Parser::logical_and_expression(std::string const& s, CodeLocation& pos, P
 
         }
 
-        whitespace(s, pos);
-
-        if (check_string(s, pos, "and")) {
+        if (check_keyword(pos, EKeyword::AND)) {
             ret_action = EAction::STOP;
             put_mul = true;
             datatype_pre = datatype_cur;
@@ -1250,9 +1058,9 @@ RetVal Parser::logical_and_expression(std::string const& s, CodeLocation& pos, P
     return RetVal::OK;
 }
 
-RetVal Parser::logical_or_expression(std::string const& s, CodeLocation& pos, ParseTrace& parse_trace, EAssignmentPosition assign_pos, Bytecode& bytecode, std::string& datatype, const Scope& scope)
+RetVal Parser::logical_or_expression(unsigned int& pos, ParseTrace& parse_trace, EAssignmentPosition assign_pos, Bytecode& bytecode, std::string& datatype, const Scope& scope)
 {
-    CodeLocation initial_pos = pos;
+    unsigned int initial_pos = pos;
     ParseTrace child_parse_trace;
     bool put_add = false;
     std::string datatype_pre = "-1";
@@ -1261,12 +1069,8 @@ RetVal Parser::logical_or_expression(std::string const& s, CodeLocation& pos, Pa
     RetVal child_ret;
 
     do {
-        whitespace(s, pos);
-
-        if ((child_ret = logical_and_expression(s, pos, child_parse_trace, assign_pos, bytecode, datatype_cur, scope)) != RetVal::OK) {
-            child_parse_trace.pos = initial_pos;
-            child_parse_trace.status = EParseStatus::PARSE_ERROR_LOGICAL_OR_EXPRESSION;
-            parse_trace.suberrors.push_back(child_parse_trace);
+        if ((child_ret = logical_and_expression(pos, child_parse_trace, assign_pos, bytecode, datatype_cur, scope)) != RetVal::OK) {
+            trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_LOGICAL_OR_EXPRESSION);
 
             pos = initial_pos;
             return ret_action == EAction::STOP ? RetVal::FAIL_STOP : child_ret;
@@ -1276,18 +1080,14 @@ RetVal Parser::logical_or_expression(std::string const& s, CodeLocation& pos, Pa
             bytecode.ADD();
 
             if (datatype_pre != "b" || datatype_cur != "b") {
-                child_parse_trace.pos = initial_pos;
-                child_parse_trace.status = EParseStatus::PARSE_ERROR_EXPECTED_BOOLEAN_DATATYPE;
-                parse_trace.suberrors.push_back(child_parse_trace);
+                trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_EXPECTED_BOOLEAN_DATATYPE);
 
                 pos = initial_pos;
                 return RetVal::FAIL_STOP;
             }
         }
 
-        whitespace(s, pos);
-
-        if (check_string(s, pos, "or") ) {
+        if (check_keyword(pos, EKeyword::OR) ) {
             ret_action = EAction::STOP;
             put_add = true;
             datatype_pre = datatype_cur;
@@ -1300,84 +1100,64 @@ RetVal Parser::logical_or_expression(std::string const& s, CodeLocation& pos, Pa
     return RetVal::OK;
 }
 
-RetVal Parser::conditional_expression(std::string const& s, CodeLocation& pos, ParseTrace& parse_trace, EAssignmentPosition assign_pos, Bytecode& bytecode, std::string& datatype, const Scope& scope)
+RetVal Parser::conditional_expression(unsigned int& pos, ParseTrace& parse_trace, EAssignmentPosition assign_pos, Bytecode& bytecode, std::string& datatype, const Scope& scope)
 {
-    CodeLocation initial_pos = pos;
+    unsigned int initial_pos = pos;
     ParseTrace child_parse_trace;
     std::string datatype_condition;
     std::string datatype_true;
     std::string datatype_false;
     RetVal child_ret;
 
-    whitespace(s, pos);
-
-    if ((child_ret = logical_or_expression(s, pos, child_parse_trace, assign_pos, bytecode, datatype_condition, scope)) == RetVal::OK ) {
-            whitespace(s, pos);
-
-        if (check_symbol(s, pos, '?')) {
+    if ((child_ret = logical_or_expression(pos, child_parse_trace, assign_pos, bytecode, datatype_condition, scope)) == RetVal::OK ) {
+        if (check_symbol(pos, '?')) {
             if (datatype_condition == "b") {
-                pos.pos++;
-                pos.col++;
+                pos++;
 
-                unsigned int j_l2 = bytecode.JUMPIFFALSE(0);
-                bytecode.addJump(j_l2+1);
+                unsigned int l2 = bytecode.newLabel();
+                unsigned int l3 = bytecode.newLabel();
+                bytecode.JUMPIFFALSE(l2);
 
-                if (conditional_expression(s, pos, child_parse_trace, assign_pos, bytecode, datatype_true, scope) == RetVal::OK) {
-                    whitespace(s, pos);
-                    unsigned int j_l3 = bytecode.JUMP(0);
-                    bytecode.addJump(j_l3+1);
-                    if (check_symbol(s, pos, ':')) {
-                        unsigned int l2 = bytecode.getCode().size();
-                        bytecode.setAddress(j_l2+1, l2);
+                if (conditional_expression(pos, child_parse_trace, assign_pos, bytecode, datatype_true, scope) == RetVal::OK) {
+                    bytecode.JUMP(l3);
+                    if (check_symbol(pos, ':')) {
+                        bytecode.setLabel(l2);
 
-                        pos.pos++;
-                        pos.col++;
+                        pos++;
 
-                        if (conditional_expression(s, pos, child_parse_trace, assign_pos, bytecode, datatype_false, scope) == RetVal::OK) {
+                        if (conditional_expression(pos, child_parse_trace, assign_pos, bytecode, datatype_false, scope) == RetVal::OK) {
                             if ( isDatatypeConsistent(datatype_true, datatype_false) ) {
                                 datatype = maxDatatype(datatype_true, datatype_false);
-                                unsigned int l3 = bytecode.getCode().size();
-                                bytecode.setAddress(j_l3+1, l3);
+                                bytecode.setLabel(l3);
                                 return RetVal::OK;
                             } else {
-                                child_parse_trace.pos = initial_pos;
-                                child_parse_trace.status = EParseStatus::PARSE_ERROR_CONDITIONAL_EXPRESSION_STATEMENTS_DATATYPES;
-                                parse_trace.suberrors.push_back(child_parse_trace);
+                                trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_CONDITIONAL_EXPRESSION_STATEMENTS_DATATYPES);
 
                                 pos = initial_pos;
                                 return RetVal::FAIL_STOP;
                             }
                         } else {
-                            child_parse_trace.pos = initial_pos;
-                            child_parse_trace.status = EParseStatus::PARSE_ERROR_CONDITIONAL_EXPRESSION_FALSE;
-                            parse_trace.suberrors.push_back(child_parse_trace);
+                            trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_CONDITIONAL_EXPRESSION_FALSE);
 
                             pos = initial_pos;
                             return RetVal::FAIL_STOP;
                         }
                     } else {
-                        ParseTrace colon_parse_trace(pos, EParseStatus::PARSE_ERROR_COND_EXP_MISSING_COLON);
-                        child_parse_trace.suberrors.push_back(colon_parse_trace);
+                        trace_error(child_parse_trace, pos, EParseStatus::PARSE_ERROR_COND_EXP_MISSING_COLON);
 
-                        child_parse_trace.pos = initial_pos;
-                        child_parse_trace.status = EParseStatus::PARSE_ERROR_CONDITIONAL_EXPRESSION;
-                        parse_trace.suberrors.push_back(child_parse_trace);
+                        trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_CONDITIONAL_EXPRESSION);
 
                         pos = initial_pos;
                         return RetVal::FAIL_STOP;
                     }
                 } else {
-                    child_parse_trace.pos = initial_pos;
-                    child_parse_trace.status = EParseStatus::PARSE_ERROR_CONDITIONAL_EXPRESSION_TRUE;
-                    parse_trace.suberrors.push_back(child_parse_trace);
+                    trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_CONDITIONAL_EXPRESSION_TRUE);
 
                     pos = initial_pos;
                     return RetVal::FAIL_STOP;
                 }
             } else {
-                child_parse_trace.pos = initial_pos;
-                child_parse_trace.status = EParseStatus::PARSE_ERROR_CONDITIONAL_EXPRESSION_CONDITION_DATATYPE;
-                parse_trace.suberrors.push_back(child_parse_trace);
+                trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_CONDITIONAL_EXPRESSION_CONDITION_DATATYPE);
 
                 pos = initial_pos;
                 return RetVal::FAIL_STOP;
@@ -1388,9 +1168,7 @@ RetVal Parser::conditional_expression(std::string const& s, CodeLocation& pos, P
         }
     }
     else {
-        child_parse_trace.pos = initial_pos;
-        child_parse_trace.status = EParseStatus::PARSE_ERROR_CONDITIONAL_EXPRESSION;
-        parse_trace.suberrors.push_back(child_parse_trace);
+        trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_CONDITIONAL_EXPRESSION);
 
         pos = initial_pos;
         return child_ret;
@@ -1398,58 +1176,49 @@ RetVal Parser::conditional_expression(std::string const& s, CodeLocation& pos, P
 
 
     // We shouldn't be here
-    child_parse_trace.pos = initial_pos;
-    child_parse_trace.status = EParseStatus::PARSE_ERROR_CONDITIONAL_EXPRESSION;
-    parse_trace.suberrors.push_back(child_parse_trace);
+    trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_CONDITIONAL_EXPRESSION);
 
     pos = initial_pos;
     return RetVal::FAIL_CONTINUE;
 }
 
-RetVal Parser::assignment_operator(std::string const& s, CodeLocation& pos, ParseTrace& parse_trace, Bytecode& bytecode, EExtendedAssignOperation& extendedOperation)
+RetVal Parser::assignment_operator(unsigned int& pos, ParseTrace& parse_trace, Bytecode& bytecode, EExtendedAssignOperation& extendedOperation)
 {
-    CodeLocation initial_pos = pos;
+    unsigned int initial_pos = pos;
     ParseTrace child_parse_trace;
 
     extendedOperation = EExtendedAssignOperation::NONE;
 
-    whitespace(s, pos);
-
-    if (check_symbol(s, pos, '=')) {
-        pos.pos++;
-        pos.col++;
+    if (check_symbol(pos, '=')) {
+        pos++;
         bytecode.MOVE();
         extendedOperation = EExtendedAssignOperation::NONE;
         return RetVal::OK;
     }
 
-    if (check_symbol(s, pos, '+') && check_symbol(s, pos+1, '=')) {
-        pos.pos += 2;
-        pos.col += 2;
+    if (check_symbol(pos, "+=")) {
+        pos++;
         bytecode.MOVEADD();
         extendedOperation = EExtendedAssignOperation::ADD;
         return RetVal::OK;
     }
 
-    if (check_symbol(s, pos, '-') && check_symbol(s, pos+1, '=')) {
-        pos.pos += 2;
-        pos.col += 2;
+    if (check_symbol(pos, "-=")) {
+        pos++;
         bytecode.MOVESUBTR();
         extendedOperation = EExtendedAssignOperation::SUB;
         return RetVal::OK;
     }
 
-    if (check_symbol(s, pos, '*') && check_symbol(s, pos+1, '=')) {
-        pos.pos += 2;
-        pos.col += 2;
+    if (check_symbol(pos, "*=")) {
+        pos++;
         bytecode.MOVEMUL();
         extendedOperation = EExtendedAssignOperation::MUL;
         return RetVal::OK;
     }
 
-    if (check_symbol(s, pos, '/') && check_symbol(s, pos+1, '=')) {
-        pos.pos += 2;
-        pos.col += 2;
+    if (check_symbol(pos, "/=")) {
+        pos++;
         bytecode.MOVEDIV();
         extendedOperation = EExtendedAssignOperation::DIV;
         return RetVal::OK;
@@ -1457,17 +1226,15 @@ RetVal Parser::assignment_operator(std::string const& s, CodeLocation& pos, Pars
 
     // This is not an assignment operator
 
-    child_parse_trace.pos = initial_pos;
-    child_parse_trace.status = EParseStatus::PARSE_ERROR_ASSIGNMENT_OPERATOR;
-    parse_trace.suberrors.push_back(child_parse_trace);
+    trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_ASSIGNMENT_OPERATOR);
 
     pos = initial_pos;
     return RetVal::FAIL_CONTINUE;
 }
 
-RetVal Parser::assignment_expression(std::string const& s, CodeLocation& pos, ParseTrace& parse_trace, Bytecode& bytecode, const Scope& scope)
+RetVal Parser::assignment_expression(unsigned int& pos, ParseTrace& parse_trace, Bytecode& bytecode, const Scope& scope)
 {
-    CodeLocation initial_pos = pos;
+    unsigned int initial_pos = pos;
     ParseTrace child_parse_trace;
     Bytecode operator_bytecode;
     std::string datatype_left;
@@ -1476,30 +1243,22 @@ RetVal Parser::assignment_expression(std::string const& s, CodeLocation& pos, Pa
     EExtendedAssignOperation extendedOperation;
     RetVal child_ret;
 
-    whitespace(s, pos);
-
-    if ((child_ret = postfix_expression(s, pos, child_parse_trace, LEFT, bytecode, datatype_left, scope)) != RetVal::OK) {
-        child_parse_trace.pos = initial_pos;
-        child_parse_trace.status = EParseStatus::PARSE_ERROR_ASSIGNMENT_EXPRESSION;
-        parse_trace.suberrors.push_back(child_parse_trace);
+    if ((child_ret = postfix_expression(pos, child_parse_trace, LEFT, bytecode, datatype_left, scope)) != RetVal::OK) {
+        trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_ASSIGNMENT_EXPRESSION);
 
         pos = initial_pos;
         return child_ret;
     }
 
-    if (assignment_operator(s, pos, child_parse_trace, operator_bytecode, extendedOperation) != RetVal::OK) {
-        child_parse_trace.pos = initial_pos;
-        child_parse_trace.status = EParseStatus::PARSE_ERROR_ASSIGNMENT_EXPRESSION;
-        parse_trace.suberrors.push_back(child_parse_trace);
+    if (assignment_operator(pos, child_parse_trace, operator_bytecode, extendedOperation) != RetVal::OK) {
+        trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_ASSIGNMENT_EXPRESSION);
 
         pos = initial_pos;
         return RetVal::FAIL_STOP;
     }
 
-    if (conditional_expression(s, pos, child_parse_trace, RIGHT, bytecode, datatype_right, scope) != RetVal::OK) {
-        child_parse_trace.pos = initial_pos;
-        child_parse_trace.status = EParseStatus::PARSE_ERROR_ASSIGNMENT_EXPRESSION;
-        parse_trace.suberrors.push_back(child_parse_trace);
+    if (conditional_expression(pos, child_parse_trace, RIGHT, bytecode, datatype_right, scope) != RetVal::OK) {
+        trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_ASSIGNMENT_EXPRESSION);
 
         pos = initial_pos;
         return RetVal::FAIL_STOP;
@@ -1516,9 +1275,7 @@ RetVal Parser::assignment_expression(std::string const& s, CodeLocation& pos, Pa
                     || (datatype_left[0] == 'a' && datatype_right[0] == 'a')
                     ) )
                 {
-                    child_parse_trace.pos = initial_pos;
-                    child_parse_trace.status = EParseStatus::PARSE_ERROR_ASSIGNMENT_DATATYPE;
-                    parse_trace.suberrors.push_back(child_parse_trace);
+                    trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_ASSIGNMENT_DATATYPE);
 
                     pos = initial_pos;
                     return RetVal::FAIL_STOP;
@@ -1531,9 +1288,7 @@ RetVal Parser::assignment_expression(std::string const& s, CodeLocation& pos, Pa
                     || (datatype_left[0] == 'a' && datatype_right[0] == 'a')
                     ) )
                 {
-                    child_parse_trace.pos = initial_pos;
-                    child_parse_trace.status = EParseStatus::PARSE_ERROR_ASSIGNMENT_DATATYPE;
-                    parse_trace.suberrors.push_back(child_parse_trace);
+                    trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_ASSIGNMENT_DATATYPE);
 
                     pos = initial_pos;
                     return RetVal::FAIL_STOP;
@@ -1542,9 +1297,7 @@ RetVal Parser::assignment_expression(std::string const& s, CodeLocation& pos, Pa
             case EExtendedAssignOperation::MUL:
             case EExtendedAssignOperation::DIV:
                 if ( !(isDatatypeNumeric(datatype_left) && isDatatypeNumeric(datatype_right)) ) {
-                    child_parse_trace.pos = initial_pos;
-                    child_parse_trace.status = EParseStatus::PARSE_ERROR_ASSIGNMENT_DATATYPE;
-                    parse_trace.suberrors.push_back(child_parse_trace);
+                    trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_ASSIGNMENT_DATATYPE);
 
                     pos = initial_pos;
                     return RetVal::FAIL_STOP;
@@ -1555,9 +1308,7 @@ RetVal Parser::assignment_expression(std::string const& s, CodeLocation& pos, Pa
         bytecode += operator_bytecode;
         return RetVal::OK;
     } else {
-        child_parse_trace.pos = initial_pos;
-        child_parse_trace.status = EParseStatus::PARSE_ERROR_ASSIGNMENT_DATATYPE;
-        parse_trace.suberrors.push_back(child_parse_trace);
+        trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_ASSIGNMENT_DATATYPE);
 
         pos = initial_pos;
         return RetVal::FAIL_STOP;
@@ -1565,42 +1316,33 @@ RetVal Parser::assignment_expression(std::string const& s, CodeLocation& pos, Pa
     
 
     // We shouldn't be here
-    child_parse_trace.pos = initial_pos;
-    child_parse_trace.status = EParseStatus::PARSE_ERROR_ASSIGNMENT_EXPRESSION;
-    parse_trace.suberrors.push_back(child_parse_trace);
+    trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_ASSIGNMENT_EXPRESSION);
 
     pos = initial_pos;
     return RetVal::FAIL_CONTINUE;
 }
 
-RetVal Parser::index_type_declaration(std::string const& s, CodeLocation& pos, ParseTrace& parse_trace, std::string& datatype)
+RetVal Parser::index_type_declaration(unsigned int& pos, ParseTrace& parse_trace, std::string& datatype)
 {
-    CodeLocation initial_pos = pos;
+    unsigned int initial_pos = pos;
     ParseTrace child_parse_trace;
     std::string encoded_datatype;
 
     do {
-        whitespace(s, pos);
+        char index_datatype = check_simple_datatype(pos);
 
-        if (check_string(s, pos, "int")) encoded_datatype += "i";
-        else if (check_string(s, pos, "float")) encoded_datatype += "f";
-        else if (check_string(s, pos, "string")) encoded_datatype += "s";
-        else if (check_string(s, pos, "boolean")) encoded_datatype += "b";
-        else {
-            child_parse_trace.pos = initial_pos;
-            child_parse_trace.status = EParseStatus::PARSE_ERROR_INDEX_TYPE_DECLARATION;
-            parse_trace.suberrors.push_back(child_parse_trace);
+        if (index_datatype != 0) {
+            encoded_datatype += index_datatype;
+        } else {
+            trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_INDEX_TYPE_DECLARATION);
 
             pos = initial_pos;
             return RetVal::FAIL_STOP;
         }
 
-        whitespace(s, pos);
-
-        if (check_symbol(s, pos, ',')) {
+        if (check_symbol(pos, ',')) {
             encoded_datatype += ",";
-            pos.pos++;
-            pos.col++;
+            pos++;
         } else {
             break;
         }
@@ -1610,114 +1352,79 @@ RetVal Parser::index_type_declaration(std::string const& s, CodeLocation& pos, P
     return RetVal::OK;
 }
 
-RetVal Parser::type_declaration(std::string const& s, CodeLocation& pos, ParseTrace& parse_trace, std::string& datatype)
+RetVal Parser::type_declaration(unsigned int& pos, ParseTrace& parse_trace, std::string& datatype)
 {
-    CodeLocation initial_pos = pos;
+    unsigned int initial_pos = pos;
     ParseTrace child_parse_trace;
 
-    whitespace(s, pos);
-
-    if (check_string(s, pos, "int") && isTerminal(s, pos)) {
-        datatype = "i";
-        return RetVal::OK;
-    }
-
-    if (check_string(s, pos, "float") && isTerminal(s, pos)) {
-        datatype = "f";
-        return RetVal::OK;
-    }
+    char simple_datatype = check_simple_datatype(pos);
 
-    if(check_string(s, pos, "string") && isTerminal(s, pos)) {
-        datatype = "s";
+    if (simple_datatype != 0) {
+        datatype.assign(1, simple_datatype);
         return RetVal::OK;
     }
 
-    if(check_string(s, pos, "boolean") && isTerminal(s, pos)) {
-        datatype = "b";
-        return RetVal::OK;
-    }
-
-    if(check_string(s, pos, "array") && isTerminal(s, pos)) {
-        whitespace(s, pos);
-        if (check_symbol(s, pos, '[')) {
+    if(check_keyword(pos, EKeyword::ARRAY)) {
+        if (check_symbol(pos, '[')) {
             std::string index_datatype;
 
-            pos.pos++;
-            pos.col++;
-
-            if (index_type_declaration(s, pos, child_parse_trace, index_datatype) == RetVal::OK) {
-                whitespace(s, pos);
-
-                if (check_symbol(s, pos, ']')) {
-                    pos.pos++;
-                    pos.col++;
+            pos++;
 
-                    whitespace(s, pos);
+            if (index_type_declaration(pos, child_parse_trace, index_datatype) == RetVal::OK) {
+                if (check_symbol(pos, ']')) {
+                    pos++;
 
-                    if (check_string(s, pos, "of")) {
+                    if (check_keyword(pos, EKeyword::OF)) {
                         std::string sub_bytecode;
 
-                        if (type_declaration(s, pos, child_parse_trace, sub_bytecode) == RetVal::OK) {
+                        if (type_declaration(pos, child_parse_trace, sub_bytecode) == RetVal::OK) {
                             datatype = "a [" + index_datatype + "] " + sub_bytecode;
                             return RetVal::OK;
                         }
                     }
                     else {
-                        ParseTrace sub_trace(pos, EParseStatus::PARSE_ERROR_TYPE_DECLARATION_MISSING_OF);
-                        child_parse_trace.suberrors.push_back(sub_trace);
+                        trace_error(child_parse_trace, pos, EParseStatus::PARSE_ERROR_TYPE_DECLARATION_MISSING_OF);
                     }
                 }
                 else {
-                    ParseTrace sub_trace(pos, EParseStatus::PARSE_ERROR_TYPE_DECLARATION_MISSING_CLOSING_BRACKET);
-                    child_parse_trace.suberrors.push_back(sub_trace);
+                    trace_error(child_parse_trace, pos, EParseStatus::PARSE_ERROR_TYPE_DECLARATION_MISSING_CLOSING_BRACKET);
                 }
             }
         }
         else {
-            ParseTrace sub_trace(pos, EParseStatus::PARSE_ERROR_TYPE_DECLARATION_MISSING_OPENING_BRACKET);
-            child_parse_trace.suberrors.push_back(sub_trace);
+            trace_error(child_parse_trace, pos, EParseStatus::PARSE_ERROR_TYPE_DECLARATION_MISSING_OPENING_BRACKET);
         }
 
-        child_parse_trace.pos = initial_pos;
-        child_parse_trace.status = EParseStatus::PARSE_ERROR_TYPE_DECLARATION;
-        parse_trace.suberrors.push_back(child_parse_trace);
+        trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_TYPE_DECLARATION);
 
         pos = initial_pos;
         return RetVal::FAIL_STOP;
     }
 
     // We have an error
-    child_parse_trace.pos = initial_pos;
-    child_parse_trace.status = EParseStatus::PARSE_ERROR_TYPE_DECLARATION;
-    parse_trace.suberrors.push_back(child_parse_trace);
+    trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_TYPE_DECLARATION);
 
     pos = initial_pos;
     return RetVal::FAIL_CONTINUE;
 }
 
-RetVal Parser::variable_declaration(std::string const& s, CodeLocation& pos, ParseTrace& parse_trace, const Scope& scope, EDataMode data_mode, std::string& variable_datatype, unsigned int& variable_idx, std::vector<unsigned int>& function_variables)
+RetVal Parser::variable_declaration(unsigned int& pos, ParseTrace& parse_trace, const Scope& scope, EDataMode data_mode, std::string& variable_datatype, unsigned int& variable_idx, std::vector<unsigned int>& function_variables)
 {
-    CodeLocation initial_pos = pos;
+    unsigned int initial_pos = pos;
     ParseTrace child_parse_trace;
     std::string bytecode_id;
     Variable variable;
     RetVal child_ret;
 
-    whitespace(s, pos);
-
-    if ((child_ret = type_declaration(s, pos, child_parse_trace, variable_datatype)) != RetVal::OK) {
-        child_parse_trace.pos = initial_pos;
-        child_parse_trace.status = EParseStatus::PARSE_ERROR_VARIABLE_DECLARATION;
-        parse_trace.suberrors.push_back(child_parse_trace);
+    if ((child_ret = type_declaration(pos, child_parse_trace, variable_datatype)) != RetVal::OK) {
+        trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_VARIABLE_DECLARATION);
 
         pos = initial_pos;
         return child_ret;
     }
 
-    if (identifier(s, pos, child_parse_trace, variable, scope, Variables::EScopeRange::EXACT) != RetVal::OK) {
-        child_parse_trace.pos = initial_pos;
-        child_parse_trace.status = EParseStatus::PARSE_ERROR_VARIABLE_DECLARATION;
-        parse_trace.suberrors.push_back(child_parse_trace);
+    if (identifier(pos, child_parse_trace, variable, scope, Variables::EScopeRange::EXACT) != RetVal::OK) {
+        trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_VARIABLE_DECLARATION);
 
         pos = initial_pos;
         return RetVal::FAIL_STOP;
@@ -1726,56 +1433,48 @@ RetVal Parser::variable_declaration(std::string const& s, CodeLocation& pos, Par
     if (variable.getIdx() == -1) { // Variable doesn't exist. Create it
         bool var_add = false;
         if (data_mode == EDataMode::STATIC) {
-            var_add = variables.add(Variable(Variable::EVariableTypes::VARIABLE, scope, variable.getName(), variable_datatype, "", initial_pos), variable_idx);
+            var_add = variables.add(Variable(Variable::EVariableTypes::VARIABLE, scope, variable.getName(), variable_datatype, "", location(initial_pos)), variable_idx);
         } else { // DYNAMIC
-            var_add = variables.add(Variable(Variable::EVariableTypes::DYNAMIC_VARIABLE, scope, variable.getName(), variable_datatype, "", initial_pos), variable_idx);
+            var_add = variables.add(Variable(Variable::EVariableTypes::DYNAMIC_VARIABLE, scope, variable.getName(), variable_datatype, "", location(initial_pos)), variable_idx);
         }
         function_variables.push_back(variable_idx);
 
         if (var_add) {
             return RetVal::OK;
         } else {
-            child_parse_trace.pos = initial_pos;
-            child_parse_trace.status = EParseStatus::PARSE_ERROR_DUPLICATE_VARIABLE_DECLARATION;
-            parse_trace.suberrors.push_back(child_parse_trace);
+            trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_DUPLICATE_VARIABLE_DECLARATION);
 
             pos = initial_pos;
             return RetVal::FAIL_STOP;
         }
     } else {
-        child_parse_trace.pos = initial_pos;
-        child_parse_trace.status = EParseStatus::PARSE_ERROR_DUPLICATE_VARIABLE_DECLARATION;
-        parse_trace.suberrors.push_back(child_parse_trace);
+        trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_DUPLICATE_VARIABLE_DECLARATION);
 
         pos = initial_pos;
         return RetVal::FAIL_STOP;
     }
     
     // We shouldn't be here
-    child_parse_trace.pos = initial_pos;
-    child_parse_trace.status = EParseStatus::PARSE_ERROR_VARIABLE_DECLARATION;
-    parse_trace.suberrors.push_back(child_parse_trace);
+    trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_VARIABLE_DECLARATION);
 
     pos = initial_pos;
     return RetVal::FAIL_STOP;
 }
 
 void Parser::initVars(Bytecode& bytecode, const Scope& scope) {
-    const std::vector<Variable>& v = variables.getVariables();
+    for(unsigned int idx: variables.getScopeVariables(scope)) {
+        const Variable& v = variables.get(idx);
 
-    for(int i=0; i<v.size(); i++) {
-        if (v.at(i).getEntityType() == Variable::EVariableTypes::VARIABLE
-        || v.at(i).getEntityType() == Variable::EVariableTypes::DYNAMIC_VARIABLE) {
-            if (v.at(i).getScope() == scope) {
-                bytecode.INITVAR(v.at(i).getIdx());
-            }
+        if (v.getEntityType() == Variable::EVariableTypes::VARIABLE
+        || v.getEntityType() == Variable::EVariableTypes::DYNAMIC_VARIABLE) {
+            bytecode.INITVAR(v.getIdx());
         }
     }
 }
 
-RetVal Parser::function_parameters_declaration(std::string const& s, CodeLocation& pos, ParseTrace& parse_trace, std::vector<unsigned int>& parameter_idxs, const Scope& scope, std::string& parameter_types)
+RetVal Parser::function_parameters_declaration(unsigned int& pos, ParseTrace& parse_trace, std::vector<unsigned int>& parameter_idxs, const Scope& scope, std::string& parameter_types)
 {
-    CodeLocation initial_pos = pos;
+    unsigned int initial_pos = pos;
     ParseTrace child_parse_trace;
     std::string encoded_datatype;
     std::string variable_datatype;
@@ -1784,27 +1483,20 @@ RetVal Parser::function_parameters_declaration(std::string const& s, CodeLocatio
     EAction ret_action = EAction::CONTINUE;
 
     do {
-        whitespace(s, pos);
-
-        if ((child_ret = variable_declaration(s, pos, child_parse_trace, scope, EDataMode::DYNAMIC, variable_datatype, variable_idx, parameter_idxs)) == RetVal::OK) {
+        if ((child_ret = variable_declaration(pos, child_parse_trace, scope, EDataMode::DYNAMIC, variable_datatype, variable_idx, parameter_idxs)) == RetVal::OK) {
             encoded_datatype += variable_datatype;
         } else {
-            child_parse_trace.pos = initial_pos;
-            child_parse_trace.status = EParseStatus::PARSE_ERROR_FUNCTION_PARAMETERS_DECLARATION;
-            parse_trace.suberrors.push_back(child_parse_trace);
+            trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_FUNCTION_PARAMETERS_DECLARATION);
 
             pos = initial_pos;
             return ret_action == EAction::STOP ? RetVal::FAIL_STOP : child_ret;
         }
 
-        whitespace(s, pos);
-
-        if (check_symbol(s, pos, ',')) {
+        if (check_symbol(pos, ',')) {
             ret_action = EAction::STOP;
 
             encoded_datatype += ",";
-            pos.pos++;
-            pos.col++;
+            pos++;
         } else {
             break;
         }
@@ -1814,9 +1506,9 @@ RetVal Parser::function_parameters_declaration(std::string const& s, CodeLocatio
     return RetVal::OK;
 }
 
-RetVal Parser::function_definition(std::string const& s, CodeLocation& pos, ParseTrace& parse_trace, Bytecode& bytecode, Bytecode& function_bytecode, const Scope& parent_scope)
+RetVal Parser::function_definition(unsigned int& pos, ParseTrace& parse_trace, Bytecode& bytecode, Bytecode& function_bytecode, const Scope& parent_scope)
 {
-    CodeLocation initial_pos = pos;
+    unsigned int initial_pos = pos;
     ParseTrace child_parse_trace;
     std::string function_datatype;
     // std::string bytecode_id;
@@ -1826,181 +1518,180 @@ RetVal Parser::function_definition(std::string const& s, CodeLocation& pos, Pars
     unsigned int code_pos=-1;
     std::string s_parameter_types;
     Scope function_scope(parent_scope);
+    Bytecode header_bytecode;
 
-    whitespace(s, pos);
-
-    if (!(check_string(s, pos, "function")
-        && isTerminal(s, pos)) )
+    if (!check_keyword(pos, EKeyword::FUNCTION))
     {
-        child_parse_trace.pos = initial_pos;
-        child_parse_trace.status = EParseStatus::PARSE_ERROR_FUNCTION_DEFINITION;
-        parse_trace.suberrors.push_back(child_parse_trace);
+        trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_FUNCTION_DEFINITION);
 
         pos = initial_pos;
         return RetVal::FAIL_CONTINUE;
     }
 
-    if (identifier(s, pos, child_parse_trace, function_id, parent_scope, Variables::EScopeRange::EXACT) != RetVal::OK) {
-        child_parse_trace.pos = initial_pos;
-        child_parse_trace.status = EParseStatus::PARSE_ERROR_FUNCTION_DEFINITION;
-        parse_trace.suberrors.push_back(child_parse_trace);
+    if (identifier(pos, child_parse_trace, function_id, parent_scope, Variables::EScopeRange::EXACT) != RetVal::OK) {
+        trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_FUNCTION_DEFINITION);
 
         pos = initial_pos;
         return RetVal::FAIL_STOP;
     }
         
     if (function_id.getIdx() != -1) { // Function already declared
-        child_parse_trace.pos = initial_pos;
-        child_parse_trace.status = EParseStatus::PARSE_ERROR_FUNCTION_NAME_IN_USE;
-        parse_trace.suberrors.push_back(child_parse_trace);
+        trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_FUNCTION_NAME_IN_USE);
 
         pos = initial_pos;
         return RetVal::FAIL_STOP;
     }
 
-    if (check_symbol(s, pos, '(')) {
-        pos.pos++;
-        pos.col++;
+    if (check_symbol(pos, '(')) {
+        pos++;
         function_scope.add(function_id.getName());
-        if (function_parameters_declaration(s, pos, child_parse_trace, parameters, function_scope, s_parameter_types) == RetVal::OK) {
-            whitespace(s, pos);
-
-            if (check_symbol(s, pos, ')')) {
-                pos.pos++;
-                pos.col++;
+        if (function_parameters_declaration(pos, child_parse_trace, parameters, function_scope, s_parameter_types) == RetVal::OK) {
+            if (check_symbol(pos, ')')) {
+                pos++;
             } else { // Missing ')'
-                child_parse_trace.pos = initial_pos;
-                child_parse_trace.status = EParseStatus::PARSE_ERROR_ARGUMENT_LIST_DECLARATION;
-                parse_trace.suberrors.push_back(child_parse_trace);
+                trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_ARGUMENT_LIST_DECLARATION);
 
                 pos = initial_pos;
                 return RetVal::FAIL_STOP;
             }
         } else {
-            child_parse_trace.pos = initial_pos;
-            child_parse_trace.status = EParseStatus::PARSE_ERROR_ARGUMENT_LIST_DECLARATION;
-            parse_trace.suberrors.push_back(child_parse_trace);
+            trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_ARGUMENT_LIST_DECLARATION);
 
             pos = initial_pos;
             return RetVal::FAIL_STOP;
         }
     }
 
-    whitespace(s, pos);
-
     unsigned int fun_var_pos;
-    if (check_string(s, pos, "of") && isTerminal(s, pos)) {
-        if (type_declaration(s, pos, child_parse_trace, function_datatype) == RetVal::OK) {
-            if (variables.add(Variable(Variable::EVariableTypes::FUNCTION, parent_scope, function_id.getName(), function_datatype, s_parameter_types, initial_pos), fun_var_pos)) {
+    if (check_keyword(pos, EKeyword::OF)) {
+        if (type_declaration(pos, child_parse_trace, function_datatype) == RetVal::OK) {
+            if (variables.add(Variable(Variable::EVariableTypes::FUNCTION, parent_scope, function_id.getName(), function_datatype, s_parameter_types, location(initial_pos)), fun_var_pos)) {
                 // Initialize function variable (used to pass a return value)
-                code_pos = function_bytecode.ALLOCVAR(fun_var_pos);
+                code_pos = header_bytecode.ALLOCVAR(fun_var_pos);
 
                 // variables.setFunctionRef(fun_var_pos, code_pos == -1 ? pos : code_pos);
-                function_bytecode.addFunction(fun_var_pos, code_pos);
+                header_bytecode.addFunction(fun_var_pos, code_pos);
 
                 // Initialize function parameters
                 for (int i=parameters.size()-1; i>=0; i--) {
                     if (is_first_function_statement) {
-                        code_pos = function_bytecode.ALLOCVARS(parameters[i]);
+                        code_pos = header_bytecode.ALLOCVARS(parameters[i]);
                         is_first_function_statement = false;
                     } else {
-                        function_bytecode.ALLOCVARS(parameters[i]);
+                        header_bytecode.ALLOCVARS(parameters[i]);
                     }
                 } // ~for
             } else {
-                child_parse_trace.pos = initial_pos;
-                child_parse_trace.status = EParseStatus::PARSE_ERROR_FUNCTION_NAME_IN_USE;
-                parse_trace.suberrors.push_back(child_parse_trace);
+                trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_FUNCTION_NAME_IN_USE);
 
                 pos = initial_pos;
                 return RetVal::FAIL_STOP;
             }
         } else {
-            child_parse_trace.pos = initial_pos;
-            child_parse_trace.status = EParseStatus::PARSE_ERROR_FUNCTION_TYPE_DECLARATION;
-            parse_trace.suberrors.push_back(child_parse_trace);
+            trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_FUNCTION_TYPE_DECLARATION);
 
             pos = initial_pos;
             return RetVal::FAIL_STOP;
         }
     }
 
-    Bytecode statement_bytecode;
-    Bytecode statement_function_bytecode;
-    std::vector<unsigned int> function_variables;   // Collects the variables defined by the function and underneeth block_statements to allocate them
-    if (block_statement(s, pos, child_parse_trace, statement_bytecode, statement_function_bytecode, function_scope, Parser::EDataMode::DYNAMIC, function_variables) == RetVal::OK) {
-        for(unsigned int i: function_variables) {
-            function_bytecode.ALLOCVAR(i);
+    // Top-level function bodies are compiled after the top-level pass, see 'compile_deferred_functions'
+    if (defer_functions && parent_scope.isRoot() && check_symbol(pos, '{')) {
+        unsigned int body_end = skip_block(pos);
+
+        if (body_end != 0) {
+            deferred_functions.emplace_back();
+            DeferredFunction& deferred = deferred_functions.back();
+            deferred.body_pos = pos;
+            deferred.function_scope = function_scope;
+            deferred.fun_var_pos = fun_var_pos;
+            deferred.header += header_bytecode;
+            deferred.first_variable = variables.getVariables().size();
+            deferred.ret = RetVal::FAIL_STOP;
+            deferred.body_start = location(pos);
+            deferred.body_end = location(body_end - 1);
+            deferred.body_tokens = body_end - pos;
+
+            pos = body_end;
+            return RetVal::OK;
         }
-        function_bytecode += statement_bytecode;
-        function_bytecode.RETURN(fun_var_pos);
-        function_bytecode += statement_function_bytecode;
+    }
+
+    function_bytecode += header_bytecode;
+    if (function_body(pos, child_parse_trace, function_bytecode, function_scope, fun_var_pos) == RetVal::OK) {
         return RetVal::OK;
     }
     else {
-        child_parse_trace.pos = initial_pos;
-        child_parse_trace.status = EParseStatus::PARSE_ERROR_FUNCTION_DEFINITION;
-        parse_trace.suberrors.push_back(child_parse_trace);
+        trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_FUNCTION_DEFINITION);
 
         pos = initial_pos;
         return RetVal::FAIL_STOP;
     }
 
     // We shouldn't be here
-    child_parse_trace.pos = initial_pos;
-    child_parse_trace.status = EParseStatus::PARSE_ERROR_FUNCTION_DEFINITION;
-    parse_trace.suberrors.push_back(child_parse_trace);
+    trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_FUNCTION_DEFINITION);
 
     pos = initial_pos;
     return RetVal::FAIL_CONTINUE;
 }
 
-RetVal Parser::block_statement(std::string const& s, CodeLocation& pos, ParseTrace& parse_trace, Bytecode& bytecode, Bytecode& function_bytecode, const Scope& scope, EDataMode data_mode, std::vector<unsigned int>& function_variables)
+// Compiles the function's block. The function variable and the parameters are allocated by the caller
+RetVal Parser::function_body(unsigned int& pos, ParseTrace& parse_trace, Bytecode& function_bytecode, const Scope& function_scope, unsigned int fun_var_pos)
 {
-    CodeLocation initial_pos = pos;
-    ParseTrace child_parse_trace;
+    Bytecode statement_bytecode;
+    Bytecode statement_function_bytecode;
+    std::vector<unsigned int> function_variables;   // Collects the variables defined by the function and underneeth block_statements to allocate them
 
-    whitespace(s, pos);
+    if (block_statement(pos, parse_trace, statement_bytecode, statement_function_bytecode, function_scope, Parser::EDataMode::DYNAMIC, function_variables) != RetVal::OK) {
+        return RetVal::FAIL_STOP;
+    }
 
-    if (check_symbol(s, pos, '{')) {
-        pos.pos++;
-        pos.col++;
+    for(unsigned int i: function_variables) {
+        function_bytecode.ALLOCVAR(i);
+    }
+    function_bytecode += statement_bytecode;
+    function_bytecode.RETURN(fun_var_pos);
+    function_bytecode += statement_function_bytecode;
 
-        if (translation_unit(s, pos, child_parse_trace, bytecode, function_bytecode, scope, data_mode, function_variables) == RetVal::OK) {
-            if (check_symbol(s, pos, '}')) {
-                pos.pos++;
-                pos.col++;
+    return RetVal::OK;
+}
+
+RetVal Parser::block_statement(unsigned int& pos, ParseTrace& parse_trace, Bytecode& bytecode, Bytecode& function_bytecode, const Scope& scope, EDataMode data_mode, std::vector<unsigned int>& function_variables)
+{
+    unsigned int initial_pos = pos;
+    ParseTrace child_parse_trace;
+
+    if (check_symbol(pos, '{')) {
+        pos++;
+
+        if (translation_unit(pos, child_parse_trace, bytecode, function_bytecode, scope, data_mode, function_variables) == RetVal::OK) {
+            if (check_symbol(pos, '}')) {
+                pos++;
 
                 return RetVal::OK;
             } else {
-                child_parse_trace.pos = initial_pos;
-                child_parse_trace.status = EParseStatus::PARSE_ERROR_BLOCK_STATEMENT;
-                parse_trace.suberrors.push_back(child_parse_trace);
+                trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_BLOCK_STATEMENT);
 
                 pos = initial_pos;
                 return RetVal::FAIL_STOP;
             }
         } else {
-            child_parse_trace.pos = initial_pos;
-            child_parse_trace.status = EParseStatus::PARSE_ERROR_BLOCK_STATEMENT;
-            parse_trace.suberrors.push_back(child_parse_trace);
+            trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_BLOCK_STATEMENT);
 
             pos = initial_pos;
             return RetVal::FAIL_STOP;
         }
     }
     
-    child_parse_trace.pos = initial_pos;
-    child_parse_trace.status = EParseStatus::PARSE_ERROR_BLOCK_STATEMENT;
-    parse_trace.suberrors.push_back(child_parse_trace);
+    trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_BLOCK_STATEMENT);
 
     pos = initial_pos;
     return RetVal::FAIL_CONTINUE;
 }
 
-RetVal Parser::translation_unit(std::string const& s, CodeLocation& pos, ParseTrace& parse_trace, Bytecode& bytecode, Bytecode& function_bytecode, const Scope& scope, EDataMode data_mode, std::vector<unsigned int>& function_variables)
+RetVal Parser::translation_unit(unsigned int& pos, ParseTrace& parse_trace, Bytecode& bytecode, Bytecode& function_bytecode, const Scope& scope, EDataMode data_mode, std::vector<unsigned int>& function_variables)
 {
-    CodeLocation initial_pos = pos;
+    unsigned int initial_pos = pos;
     Bytecode statement_bytecode;
     Bytecode statement_function_bytecode;
     int subscope_count = 0;
@@ -2008,49 +1699,47 @@ RetVal Parser::translation_unit(std::string const& s, CodeLocation& pos, ParseTr
     unsigned int variable_idx;
     RetVal child_ret;
 
-    whitespace(s, pos);
-
     do {
         ParseTrace child_parse_trace;
         statement_bytecode.clear();
         statement_function_bytecode.clear();
+        EStatement statement = statement_type(pos);
+
+        if (statement == EStatement::BLOCK_END && scope.isRoot()) {
+            statement = EStatement::ASSIGNMENT; // Unbalanced '}'. Report it as a broken statement
+        }
 
-        if ((child_ret = assignment_expression(s, pos, child_parse_trace, statement_bytecode, scope)) == RetVal::OK) {
+        if (statement == EStatement::ASSIGNMENT
+            && (child_ret = assignment_expression(pos, child_parse_trace, statement_bytecode, scope)) == RetVal::OK) {
             bytecode += statement_bytecode;
-        } else if (child_ret == RetVal::FAIL_CONTINUE
-            && (child_ret = variable_declaration(s, pos, child_parse_trace, scope, data_mode, variable_datatype, variable_idx, function_variables)) == RetVal::OK)
+        } else if (statement == EStatement::VARIABLE_DECLARATION
+            && (child_ret = variable_declaration(pos, child_parse_trace, scope, data_mode, variable_datatype, variable_idx, function_variables)) == RetVal::OK)
         {
             bytecode += statement_bytecode;
-        } else if (child_ret == RetVal::FAIL_CONTINUE
-            && (child_ret = block_statement(s, pos, child_parse_trace, statement_bytecode, statement_function_bytecode, Scope(scope, std::to_string(subscope_count)), data_mode, function_variables)) == RetVal::OK)
+        } else if (statement == EStatement::BLOCK
+            && (child_ret = block_statement(pos, child_parse_trace, statement_bytecode, statement_function_bytecode, Scope(scope, std::to_string(subscope_count)), data_mode, function_variables)) == RetVal::OK)
         {
             initVars(bytecode, Scope(scope, std::to_string(subscope_count)));
             bytecode += statement_bytecode;
             function_bytecode += statement_function_bytecode;
             subscope_count++;
-        } else if (child_ret == RetVal::FAIL_CONTINUE
-            && (child_ret = function_definition(s, pos, child_parse_trace, statement_bytecode, statement_function_bytecode, scope)) == RetVal::OK)
+        } else if (statement == EStatement::FUNCTION_DEFINITION
+            && (child_ret = function_definition(pos, child_parse_trace, statement_bytecode, statement_function_bytecode, scope)) == RetVal::OK)
         {
             function_bytecode += statement_bytecode;
             function_bytecode += statement_function_bytecode;
             subscope_count++;
-        } else if (child_ret == RetVal::FAIL_CONTINUE
-            && !scope.isRoot()
-            && check_symbol(s, pos, '}'))
+        } else if (statement == EStatement::BLOCK_END)
         { // For nested scope terminate on '}'
             return RetVal::OK;
         } else {
-            child_parse_trace.pos = initial_pos;
-            child_parse_trace.status = EParseStatus::PARSE_ERROR_COMPILATION_UNIT;
-            parse_trace.suberrors.push_back(child_parse_trace);
+            trace_error(parse_trace, child_parse_trace, initial_pos, EParseStatus::PARSE_ERROR_COMPILATION_UNIT);
 
             pos = initial_pos;
             return child_ret;
         }
 
-        whitespace(s, pos);
-
-        if (s.length() <= pos.pos) { // EOF
+        if (token(pos).type == ETokenType::END_OF_FILE) {
             break;
         }
     } while(true);
@@ -2060,80 +1749,225 @@ RetVal Parser::translation_unit(std::string const& s, CodeLocation& pos, ParseTr
     return RetVal::OK;
 }
 
-EParseStatus Parser::parse(std::string const& s, ParseTrace& parse_trace, Bytecode& bytecode)
+// Counts the 'function' keywords outside of blocks
+unsigned int Parser::count_root_functions() const
 {
-    Bytecode function_bytecode;
-    CodeLocation pos(0, 0, 0);
-    Scope scope("0");
-    Bytecode translation_bytecode;
+    unsigned int count = 0;
+    int depth = 0;
+
+    for (const Token& t: source->getTokens()) {
+        if (t.type == ETokenType::SYMBOL) {
+            if (t.symbol == (unsigned char)'{') depth++;
+            else if (t.symbol == (unsigned char)'}') depth--;
+        } else if (depth == 0 && t.type == ETokenType::IDENTIFIER && t.keyword == EKeyword::FUNCTION) {
+            count++;
+        }
+    }
 
-    bytecode.clear();
+    return count;
+}
 
-    printf("Text to parse: %s\n", s.c_str());
+// Returns the token index after the '}' closing the block which starts at 'pos'. 0 if the block isn't closed
+unsigned int Parser::skip_block(unsigned int pos) const
+{
+    int depth = 0;
 
-//    ETokenizeStatus tokenize_ret = tokenize(s);
+    for (; token(pos).type != ETokenType::END_OF_FILE; pos++) {
+        if (check_symbol(pos, '{')) {
+            depth++;
+        } else if (check_symbol(pos, '}') && --depth == 0) {
+            return pos + 1;
+        }
+    }
 
-    // Declare predefined constants
-    unsigned int var_true_pos, var_false_pos; // if OK - new variable index in the variable array; if error - code position of the previous declaration
-    variables.add(Variable(Variable::EVariableTypes::BUILTIN_VARIABLE, scope, "true", "b", "", CodeLocation()), var_true_pos);
-    variables.add(Variable(Variable::EVariableTypes::BUILTIN_VARIABLE, scope, "false", "b", "", CodeLocation()), var_false_pos);
+    return 0;
+}
 
-    // Declare predefined functions
-    unsigned int fun_idx;
-    unsigned int fun_pos; // function address to add to the reference table
+// Runs on a worker thread. The worker parser shares the tokens and the scope tree, and reads the program symbols
+// through its own symbol table. Nothing of the main parser is modified until all workers finish.
+void Parser::compile_deferred_function(DeferredFunction& function)
+{
+    Parser worker;
+    ParseTrace parse_trace;
+    unsigned int pos = function.body_pos;
 
-    // SIN(x)
-    {
-        Scope sin_scope(scope, "sin");
-        unsigned int sin_par_idx;
-        variables.add(Variable(Variable::EVariableTypes::BUILTIN_FUNCTION, scope, "sin", "f", "f", CodeLocation()), fun_idx);
-        variables.add(Variable(Variable::EVariableTypes::DYNAMIC_VARIABLE, sin_scope, "x", "f", "", CodeLocation()), sin_par_idx);
-
-        fun_pos = function_bytecode.ALLOCVAR(fun_idx);
-        function_bytecode.ALLOCVARS(sin_par_idx);
-        function_bytecode.PUTDADDR(fun_idx);
-        function_bytecode.SYSCALL(sin_par_idx, std::string("sin").data());  // SYSCALL puts the result to the stack
-        function_bytecode.MOVE();
-        function_bytecode.RETURN(fun_idx);
-        function_bytecode.addFunction(fun_idx, fun_pos);
-        // variables.setFunctionRef(fun_idx, fun_pos);
-    }
-    // COS(x)
-    {
-        Scope cos_scope(scope, "cos");
-        unsigned int cos_par_idx;
-        variables.add(Variable(Variable::EVariableTypes::BUILTIN_FUNCTION, scope, "cos", "f", "f", CodeLocation()), fun_idx);
-        variables.add(Variable(Variable::EVariableTypes::DYNAMIC_VARIABLE, cos_scope, "x", "f", "", CodeLocation()), cos_par_idx);
+    worker.source = source;
+    worker.variables.setBase(&variables, function.first_variable);
+
+    function.ret = worker.function_body(pos, parse_trace, function.code, function.function_scope, function.fun_var_pos);
+
+    function.variables = std::move(worker.variables);
+}
+
+// Hashes of the variable lists 0..i for every i. A function body compiled against the same list compiles the same.
+std::vector<size_t> Parser::symbol_hashes()
+{
+    const std::vector<Variable>& program_variables = variables.getVariables();
+    std::vector<size_t> hashes(program_variables.size() + 1, 0);
+
+    for (unsigned int i=0; i<program_variables.size(); i++) {
+        const Variable& v = program_variables[i];
+        size_t hash = hashes[i];
+
+        boost::hash_combine(hash, static_cast<int>(v.getEntityType()));
+        boost::hash_combine(hash, v.getScope().getNode()->id);
+        boost::hash_combine(hash, v.getName());
+        boost::hash_combine(hash, v.getType());
+        boost::hash_combine(hash, v.getType_fun_params());
+        hashes[i + 1] = hash;
+    }
+
+    return hashes;
+}
+
+// Drops the compiled functions whose bodies overlap the edited rows and moves the ones below the edit
+void Parser::apply_edit(const SourceEdit& edit, int pos_delta)
+{
+    for (auto iter = compiled_functions.begin(); iter != compiled_functions.end();) {
+        DeferredFunction& function = iter->second;
+
+        if (function.body_end.row < edit.first_row) {
+            iter++;
+        } else if (function.body_start.row > edit.last_row - edit.row_delta) {
+            function.body_start.set(function.body_start.pos + pos_delta, function.body_start.row + edit.row_delta, function.body_start.col);
+            function.body_end.set(function.body_end.pos + pos_delta, function.body_end.row + edit.row_delta, function.body_end.col);
+            function.variables.shiftPositions(pos_delta, edit.row_delta);
+            iter++;
+        } else {
+            iter = compiled_functions.erase(iter);
+        }
+    }
+}
+
+// Takes the body compiled by the previous compilation if neither its tokens nor the variables visible from it have changed
+bool Parser::reuse_compiled_function(DeferredFunction& function)
+{
+    auto iter = compiled_functions.find(function.function_scope.getNode()->id);
+
+    if (iter == compiled_functions.end()) {
+        return false;
+    }
+
+    const DeferredFunction& compiled = iter->second;
+    const CodeLocation& body_start = function.body_start;
+    const CodeLocation& body_end = function.body_end;
 
-        fun_pos = function_bytecode.ALLOCVAR(fun_idx);
-        function_bytecode.ALLOCVARS(cos_par_idx);
-        function_bytecode.PUTDADDR(fun_idx);
-        function_bytecode.SYSCALL(cos_par_idx, std::string("cos").data());  // SYSCALL puts the result to the stack
-        function_bytecode.MOVE();
-        function_bytecode.RETURN(fun_idx);
-        function_bytecode.addFunction(fun_idx, fun_pos);
-        // variables.setFunctionRef(fun_idx, fun_pos);
+    if (compiled.body_start.pos != body_start.pos || compiled.body_start.row != body_start.row || compiled.body_start.col != body_start.col
+        || compiled.body_end.pos != body_end.pos || compiled.body_end.row != body_end.row
+        || compiled.body_tokens != function.body_tokens
+        || compiled.first_variable != function.first_variable
+        || compiled.fun_var_pos != function.fun_var_pos
+        || compiled.symbols_hash != function.symbols_hash) {
+        return false;
     }
 
+    function.variables = compiled.variables;
+    function.code = compiled.code;
+    function.ret = RetVal::OK;
+
+    return true;
+}
+
+// Compiles the deferred function bodies on the calling thread and the idle workers of the CompilePool and appends them to 'function_bytecode' in the source order.
+// Variables declared by a body get their final indexes here, so the result doesn't depend on the scheduling.
+// In the incremental mode only the bodies which can't be reused from the previous compilation are compiled.
+RetVal Parser::compile_deferred_functions(Bytecode& function_bytecode)
+{
+    std::vector<DeferredFunction*> pending;
+
+    if (incremental) {
+        std::vector<size_t> hashes = symbol_hashes();
+
+        for (DeferredFunction& function: deferred_functions) {
+            function.symbols_hash = hashes[function.first_variable];
+
+            if (!reuse_compiled_function(function)) {
+                pending.push_back(&function);
+            }
+        }
+    } else {
+        for (DeferredFunction& function: deferred_functions) {
+            pending.push_back(&function);
+        }
+    }
+
+    std::atomic<unsigned int> next(0);
+    auto work = [this, &next, &pending]() {
+        unsigned int i;
+
+        while ((i = next++) < pending.size()) {
+            compile_deferred_function(*pending[i]);
+        }
+    };
+
+    // The workers are shared by all compilations, this one gets the idle ones
+    unsigned int thread_count = std::min<unsigned int>(threads ? threads : std::thread::hardware_concurrency(), pending.size());
+
+    CompilePool::instance().run(thread_count > 0 ? thread_count - 1 : 0, work);
+
+    if (incremental) {
+        for (DeferredFunction* function: pending) {
+            if (function->ret == RetVal::OK) {
+                compiled_functions[function->function_scope.getNode()->id] = *function;
+            }
+        }
+    }
+
+    for (DeferredFunction& function: deferred_functions) {
+        if (function.ret != RetVal::OK) {
+            return function.ret;
+        }
+
+        unsigned int first_variable = variables.getVariables().size();
+
+        function.code.relocateVariables(function.first_variable, first_variable - function.first_variable);
+        variables.addFrom(function.variables);
+
+        function_bytecode += function.header;
+        function_bytecode += function.code;
+    }
+
+    deferred_functions.clear();
+
+    return RetVal::OK;
+}
+
+// Compiles the tokens of the source. Called after 'tokenizer.tokenize'
+RetVal Parser::parse_tokens(ParseTrace& parse_trace, Bytecode& bytecode)
+{
+    Bytecode function_bytecode;
+    unsigned int pos = 0;
+    Scope scope(scope_tree.getRoot("0"));
+    Bytecode translation_bytecode;
+
+    bytecode.clear();
+
+    deferred_functions.clear();
+    defer_functions = !build_trace && (incremental || count_root_functions() >= PARALLEL_FUNCTIONS_MIN);
+
+    // Declare the builtin constants and functions, they are assembled once per process
+    const Prelude& prelude = Prelude::instance();
+
+    prelude.declare(variables, scope);
+    prelude.appendFunctions(function_bytecode);
+
     std::vector<unsigned int> function_variables; // Basically unused on the root level. This is used for allocating funtion-level variables.
-    RetVal ret = translation_unit(s, pos, parse_trace, translation_bytecode, function_bytecode, scope, EDataMode::STATIC, function_variables);
+    RetVal ret = translation_unit(pos, parse_trace, translation_bytecode, function_bytecode, scope, EDataMode::STATIC, function_variables);
+
+    if (ret == RetVal::OK && !deferred_functions.empty()) {
+        ret = compile_deferred_functions(function_bytecode);
+    }
 
     if (ret == RetVal::OK) {
         initVars(bytecode, scope);
 
         // Init predefined variables
-        bytecode.PUTADDR(var_true_pos);
-        bytecode.PUTBOOLEAN(true);
-        bytecode.MOVE();
-
-        bytecode.PUTADDR(var_false_pos);
-        bytecode.PUTBOOLEAN(false);
-        bytecode.MOVE();
+        prelude.appendInitialization(bytecode);
 
         bytecode += translation_bytecode;
 
         // Adding variables and function table to the bytecode
-        unsigned int function_section_pos = bytecode.getCode().size();
+        unsigned int function_section_pos = bytecode.size();
         bytecode += function_bytecode;
 
         // variables.reallocateFunctionRef(function_section_pos);
@@ -2152,10 +1986,51 @@ EParseStatus Parser::parse(std::string const& s, ParseTrace& parse_trace, Byteco
         }
     }
 
-    bytecode.print("compile.bant");
+    return ret;
+}
+
+EParseStatus Parser::parse(std::string const& s, ParseTrace& parse_trace, Bytecode& bytecode)
+{
+    incremental = false;
+    compiled_functions.clear();
+
+    return compile(s, parse_trace, bytecode);
+}
+
+// Incremental compilation of the edited source. The top-level statements are parsed again, but the bodies
+// of top-level functions outside the edited rows are taken from the previous compilation by this method.
+// The parser must not be cleared between the compilations.
+EParseStatus Parser::parse(std::string const& s, const SourceEdit& edit, ParseTrace& parse_trace, Bytecode& bytecode)
+{
+    apply_edit(edit, (int)s.length() - source_length);
+    source_length = s.length();
+
+    variables.clear();
+    incremental = true;
+
+    return compile(s, parse_trace, bytecode);
+}
+
+EParseStatus Parser::compile(std::string const& s, ParseTrace& parse_trace, Bytecode& bytecode)
+{
+    tokenizer.tokenize(s);
+
+    build_trace = false;
+    furthest_failure.clear();
+
+    RetVal ret = parse_tokens(parse_trace, bytecode);
 
     if (ret != RetVal::OK) {
-        parse_trace.pos.set(0, 0, 0);
+        // Repeat the failed parse from scratch to collect the diagnostics
+        variables.clear();
+        furthest_failure.clear();
+        build_trace = true;
+        parse_tokens(parse_trace, bytecode);
+        build_trace = false;
+    }
+
+    if (ret != RetVal::OK) {
+        parse_trace.pos = location(furthest_failure.pos);
         parse_trace.status = EParseStatus::PARSE_ERROR;
         return EParseStatus::PARSE_ERROR;
     }
@@ -2166,4 +2041,29 @@ EParseStatus Parser::parse(std::string const& s, ParseTrace& parse_trace, Byteco
 void Parser::clear()
 {
     variables.clear();
+    compiled_functions.clear();
+    scope_tree.clear();
+}
+
+void Parser::release()
+{
+    tokenizer = Tokenizer();
+    variables = Variables();
+}
+
+size_t Parser::getMemoryEstimate() const
+{
+    size_t size = sizeof(Parser) + scope_tree.getMemoryEstimate();
+
+    size += tokenizer.getTokens().capacity() * sizeof(Token);
+    size += variables.getVariables().size() * sizeof(Variable);
+
+    for (const auto& compiled: compiled_functions) {
+        const DeferredFunction& function = compiled.second;
+
+        size += sizeof(DeferredFunction) + function.header.size() + function.code.size();
+        size += function.variables.getVariables().size() * sizeof(Variable);
+    }
+
+    return size;
 }
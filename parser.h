@@ -3,8 +3,14 @@
 
 #include <string>
 #include <vector>
+#include <unordered_map>
+#include <deque>
+#include <mutex>
+#include <climits>
 
 #include "bytecode.h"
+#include "tokenizer.h"
+#include "typetable.h"
 
 enum class EParseStatus : int
 {
@@ -110,41 +116,6 @@ ADD VAL, ADDR       ; stack: [addr_a.b[3].d, 14.1 ]
 MOV S, ADDR         ; stack: []                             ; a.b[3].d = 14.1
 */
 
-//enum ETokenizeStatus
-//{
-//    TOKENIZE_OK,
-//    TOKENIZE_ERROR
-//};
-
-//enum EToken
-//{
-
-//};
-
-//class Token
-//{
-//    EToken token;
-//};
-
-class CodeLocation {
-public:
-    CodeLocation() {}
-    CodeLocation(int pos, int row, int col) : pos(pos), row(row), col(col) {}
-    int pos{ -1 };
-    int row{ -1 };
-    int col{ -1 };
-
-    void set(int pos, int row, int col) {
-        this->pos = pos;
-        this->row = row;
-        this->col = col;
-    }
-
-    CodeLocation operator+(int inc) {
-        return CodeLocation(pos + inc, col + inc, row);
-    }
-};
-
 class ParseTrace
 {
 public:
@@ -192,82 +163,173 @@ public:
     std::vector<ParseTrace> suberrors;
 };
 
-class Scope {
+// The furthest position where a rule failed and the rules which failed there.
+// It is kept in a fixed buffer, so the parser can update it on every failure without allocations.
+class ParseFailure
+{
+public:
+    static const int MAX_EXPECTED = 16;
+
+    unsigned int pos{ 0 };  // Token index
+    EParseStatus expected[MAX_EXPECTED];
+    int expected_count{ 0 };
+
+    void clear() {
+        pos = 0;
+        expected_count = 0;
+    }
+
+    void add(unsigned int failure_pos, EParseStatus status) {
+        if (failure_pos < pos) return;
+
+        if (failure_pos > pos) {
+            pos = failure_pos;
+            expected_count = 0;
+        }
+
+        for (int i=0; i<expected_count; i++) {
+            if (expected[i] == status) return;
+        }
+
+        if (expected_count < MAX_EXPECTED) {
+            expected[expected_count++] = status;
+        }
+    }
+};
+
+class ScopeTree;
+
+// A node of the scope tree, e.g. "2" in the scope "0.1.2".
+// Nodes are interned by the ScopeTree: there is one node per scope path, so scopes compare by pointer.
+struct ScopeNode
+{
+    unsigned int id;                // Index in the tree, usable as an array index
+    unsigned int depth;             // 1 for a root scope
+    std::string path;               // "0.1.2"
+    const ScopeNode* parent;        // NULL for a root scope
+    ScopeTree* tree;
+    std::unordered_map<std::string, unsigned int> children;    // <name, id>
+};
+
+// Owns the scope nodes. Nodes never move, so pointers to them stay valid until 'clear'.
+// Function bodies compiled in parallel add nodes to the same tree, so adding is locked.
+class ScopeTree
+{
 private:
-    std::vector<std::string> scope;
+    std::deque<ScopeNode> nodes;
+    std::unordered_map<std::string, unsigned int> roots;       // <name, id>
+    mutable std::mutex nodes_mutex;
+
+    const ScopeNode* addNode(const ScopeNode* parent, const std::string& name) {
+        std::lock_guard<std::mutex> lock(nodes_mutex);
+        std::unordered_map<std::string, unsigned int>& siblings = parent ? nodes[parent->id].children : roots;
+        auto iter = siblings.find(name);
+
+        if (iter != siblings.end()) {
+            return &nodes[iter->second];
+        }
+
+        nodes.push_back(ScopeNode());
+        ScopeNode& node = nodes.back();
+        node.id = nodes.size() - 1;
+        node.depth = parent ? parent->depth + 1 : 1;
+        node.path = parent ? parent->path + "." + name : name;
+        node.parent = parent;
+        node.tree = this;
+        siblings[name] = node.id;
+
+        return &node;
+    }
 
 public:
-    Scope() {}
-    Scope(const std::string& s) {
-        scope.push_back(s);
+    ScopeTree() {}
+    ScopeTree(const ScopeTree&) = delete;
+    ScopeTree& operator=(const ScopeTree&) = delete;
+
+    const ScopeNode* getRoot(const std::string& name) {
+        return addNode(NULL, name);
     }
 
-    Scope(const std::vector<std::string>& scope) : scope(scope) {
+    const ScopeNode* getChild(const ScopeNode* parent, const std::string& name) {
+        return addNode(parent, name);
     }
 
-    Scope(const Scope& other) : scope(other.scope) {
+    void clear() {
+        std::lock_guard<std::mutex> lock(nodes_mutex);
+        nodes.clear();
+        roots.clear();
     }
 
-    Scope(const Scope& parent_scope, const std::string& suffix) {
-        scope = parent_scope.scope;
-        scope.push_back(suffix);
+    // The approximate memory of the nodes (bytes)
+    size_t getMemoryEstimate() const {
+        std::lock_guard<std::mutex> lock(nodes_mutex);
+        size_t size = 0;
+
+        for (const ScopeNode& node: nodes) {
+            size += sizeof(ScopeNode) + node.path.capacity() + node.children.size() * sizeof(std::pair<std::string, unsigned int>);
+        }
+
+        return size;
+    }
+};
+
+// A scope is a handle of an interned ScopeNode. An empty scope has no node.
+class Scope {
+private:
+    const ScopeNode* node;
+
+public:
+    Scope() : node(NULL) {}
+    Scope(const ScopeNode* node) : node(node) {
+    }
+
+    Scope(const Scope& parent_scope, const std::string& suffix) : node(parent_scope.node->tree->getChild(parent_scope.node, suffix)) {
+    }
+
+    const ScopeNode* getNode() const {
+        return node;
     }
 
     unsigned int size() const {
-        return scope.size();
+        return node ? node->depth : 0;
     }
 
     void add(const std::string& s) {
-        scope.push_back(s);
+        node = node->tree->getChild(node, s);
     }
 
     bool operator==(const Scope& other) const {
-        return scope == other.scope;
-    }
-
-    Scope& operator=(const Scope& other) {
-        scope = other.scope;
-        return *this;
+        return node == other.node;
     }
 
     void reduce() {
-        if (!scope.empty()) {
-            scope.pop_back();
+        if (node) {
+            node = node->parent;
         }
     }
 
     bool startsWith(const Scope& other) const {
-        if (scope.size() < other.scope.size()) {
+        const ScopeNode* cur = node;
+
+        if (size() < other.size()) {
             return false;
         }
 
-        for(int i=0; i<other.size(); i++) {
-            if (scope[i] != other.scope[i]) {
-                return false;
-            }
+        while (cur && cur->depth > other.size()) {
+            cur = cur->parent;
         }
 
-        return true;
+        return cur == other.node;
     }
 
-    const std::string toString() const {
-        std::string ret;
-        bool is_first = true;
-
-        for(const std::string& s: scope) {
-            if (is_first) {
-                ret = s;
-                is_first = false;
-            } else {
-                ret += "." + s;
-            }
-        }
+    const std::string& toString() const {
+        static const std::string EMPTY_SCOPE;
 
-        return ret;
+        return node ? node->path : EMPTY_SCOPE;
     }
 
     bool isRoot() const {
-        return (scope.size() == 1 && scope.at(0) == "0");
+        return node && node->parent == NULL && node->path == "0";
     }
 };
 
@@ -279,14 +341,14 @@ private:
     enum EVariableTypes entityType;
     Scope scope;
     std::string name;
-    std::string type;
-    std::string type_fun_params;
+    TypeId type;                    // The signature is kept once in the TypeTable
+    std::string type_fun_params;    // The comma separated datatypes of the parameters, empty except for functions
     CodeLocation code_position;
     int variable_idx;
     int function_ref;
 
 public:
-    Variable() : entityType(EVariableTypes::UNDEFINED), name(""), type(""), type_fun_params(""), variable_idx(-1), function_ref(-1) {}
+    Variable() : entityType(EVariableTypes::UNDEFINED), name(""), type(TYPE_UNDEFINED), type_fun_params(""), variable_idx(-1), function_ref(-1) {}
     Variable(const Variable& other) :  entityType(other.entityType),
                                         scope(other.scope),
                                         name(other.name),
@@ -298,7 +360,7 @@ public:
     {
     }
     Variable(EVariableTypes entityType, const Scope& scope, const std::string& name, const std::string& type, const std::string& type_fun_params, CodeLocation code_position) :
-        entityType(entityType), scope(scope), name(name), type(type), type_fun_params(type_fun_params), code_position(code_position), variable_idx(-1), function_ref(-1) {
+        entityType(entityType), scope(scope), name(name), type(TypeTable::instance().getTypeId(type)), type_fun_params(type_fun_params), code_position(code_position), variable_idx(-1), function_ref(-1) {
     }
 
     Variable& operator=(const Variable& other) {
@@ -318,12 +380,13 @@ public:
     const Scope& getScope() const { return scope; }
     const std::string& getName() const { return name; }
     const std::string& getType() const { 
-        return type;
+        return TypeTable::instance().getSignature(type);
     }
     const std::string& getType_fun_params() const { 
         return type_fun_params;
     }
     const CodeLocation& getPosition() const { return code_position; }
+    void setPosition(const CodeLocation& position) { code_position = position; }
     int getIdx() const { return variable_idx; }
     void setIdx(int idx) { variable_idx = idx; }
     void setFunctionRef(int function_ref) { this->function_ref = function_ref; }
@@ -340,32 +403,136 @@ public:
 
 class Variables {
 private:
+    // Symbols declared directly in one scope
+    struct SymbolScope
+    {
+        std::unordered_map<unsigned int, unsigned int> symbols; // name id -> variable index
+        std::vector<unsigned int> variable_idxs;                // In declaration order
+    };
+
     std::vector<Variable> variables;
+    std::unordered_map<unsigned int, SymbolScope> scopes;       // <ScopeNode id, symbols>
+    std::unordered_map<std::string, unsigned int> name_ids;
+    std::vector<unsigned int> NO_VARIABLES;
     std::string UNKNOWN_DATATYPE = "-1";
 
+    // Read-only symbols this table extends, e.g. the program symbols seen from a function body compiled on a worker thread.
+    // Only the base variables with indexes below 'base_size' are visible. Own variables are indexed from 'base_size' on.
+    const Variables* base{ NULL };
+    unsigned int base_size{ 0 };
+
+    // Returns NULL if nothing has been declared in the scope and 'create' is false
+    SymbolScope* getSymbolScope(const ScopeNode* node, bool create) {
+        if (node == NULL) {
+            return NULL;
+        }
+
+        if (create) {
+            return &scopes[node->id];
+        }
+
+        auto iter = scopes.find(node->id);
+
+        return iter == scopes.end() ? NULL : &iter->second;
+    }
+
+    int getNameId(const std::string& name) const {
+        auto iter = name_ids.find(name);
+
+        return iter == name_ids.end() ? -1 : iter->second;
+    }
+
+    // Returns the index of the variable 'name' declared directly in the scope 'node', -1 if there is none
+    int findSymbol(const ScopeNode* node, const std::string& name, unsigned int limit) const {
+        int name_id = getNameId(name);
+        auto iter = name_id == -1 ? scopes.end() : scopes.find(node->id);
+
+        if (iter != scopes.end()) {
+            auto symbol = iter->second.symbols.find(name_id);
+
+            if (symbol != iter->second.symbols.end() && symbol->second < limit) {
+                return symbol->second;
+            }
+        }
+
+        if (base) {
+            return base->findSymbol(node, name, base_size);
+        }
+
+        return -1;
+    }
+
 public:
     enum class EScopeRange {EXACT, INHERITANCE};
 
     void clear() {
         variables.clear();
+        scopes.clear();
+        name_ids.clear();
+        base = NULL;
+        base_size = 0;
+    }
+
+    void setBase(const Variables* base_variables, unsigned int visible_count) {
+        clear();
+        base = base_variables;
+        base_size = visible_count;
     }
 
-    const std::vector<Variable>& getVariables() {
+    // Own variables only
+    const std::vector<Variable>& getVariables() const {
         return variables;
     }
+
+    const Variable& get(unsigned int idx) const {
+        return idx < base_size ? base->get(idx) : variables[idx - base_size];
+    }
+
+    // Indexes of the own variables declared directly in the 'scope'
+    const std::vector<unsigned int>& getScopeVariables(const Scope& scope) {
+        SymbolScope* symbol_scope = getSymbolScope(scope.getNode(), false);
+
+        return symbol_scope ? symbol_scope->variable_idxs : NO_VARIABLES;
+    }
     
     bool add(const Variable& v, unsigned int& pos) {
-        std::vector<Variable>::iterator iter = std::find(variables.begin(), variables.end(), v);
-
-        if (iter == variables.end()) {
-            variables.push_back(v);
-            pos = variables.size()-1;
-            variables[pos].setIdx(pos);
-            return true;
-        } else {
-            pos = iter->getIdx();
+        if (v.getScope().getNode() == NULL) {
             return false;
         }
+
+        int found_idx = findSymbol(v.getScope().getNode(), v.getName(), (unsigned int)-1);
+
+        if (found_idx != -1) {
+            pos = found_idx;
+            return false;
+        }
+
+        SymbolScope& symbol_scope = *getSymbolScope(v.getScope().getNode(), true);
+        unsigned int name_id = name_ids.emplace(v.getName(), name_ids.size()).first->second;
+
+        variables.push_back(v);
+        pos = base_size + variables.size()-1;
+        variables.back().setIdx(pos);
+        symbol_scope.symbols[name_id] = pos;
+        symbol_scope.variable_idxs.push_back(pos);
+        return true;
+    }
+
+    // Moves the declaration positions of the own variables, e.g. after the source above them has been edited
+    void shiftPositions(int pos_delta, int row_delta) {
+        for (Variable& v: variables) {
+            const CodeLocation& position = v.getPosition();
+            v.setPosition(CodeLocation(position.pos + pos_delta, position.row + row_delta, position.col));
+        }
+    }
+
+    // Adds the own variables of 'other'. They get new indexes in the same order.
+    void addFrom(const Variables& other) {
+        unsigned int pos;
+
+        for (const Variable& v: other.variables) {
+            add(v, pos);
+        }
     }
 
     const std::string& getDatatype(const std::string& v) {
@@ -387,59 +554,21 @@ public:
     //     There are 0.x, 0.1.x
     //     0.1.x will be returned
     bool getVariable(const Scope& scope, EScopeRange scopeRange, const std::string& name, Variable& var) {
-        Scope DUMMY_SCOPE;
-        const Scope* max_scope = &DUMMY_SCOPE;
-        int found_idx = -1;
-
-        // // Scope reduction
-        // // scope = 0123.. => 01
-
-        // std::string reduced_scope;
-        // int first_dot_pos = scope.indexOf('.');
-
-        // if (first_dot_pos != -1) {
-        //     int no_dots = scope.size() - first_dot_pos;
-        //     int reduced_scope_len = first_dot_pos - no_dots;
-
-        //     if (reduced_scope_len < 1) {
-        //         var = Variable(Variable::EVariableTypes::UNDEFINED, "", name, "", "", -1);
-        //         return false;
-        //     }
-
-        //     reduced_scope = scope.left(reduced_scope_len);
-        // } else {
-        //     reduced_scope = scope;
-        // }
-
-        if (scopeRange == EScopeRange::EXACT) {
-            for (int i=0; i<variables.size(); i++) {
-                if (variables.at(i).getName() == name && variables.at(i).getScope() == scope) {
-                    var = variables[i];
-                    return true; 
-                }
-            }
-        } else {    // EScopeRange::INHERITANCE
-            for (int i=0; i<variables.size(); i++) {
-                if (variables.at(i).getName() == name) {
-                    const Scope* cur_scope = &(variables[i].getScope());
-
-                    if (scope.startsWith(*cur_scope) ) {
-                        if (cur_scope->size() > max_scope->size()) {
-                            max_scope = cur_scope;
-                            found_idx = i;
-                        }
-                    }
-                }
+        const ScopeNode* node = scope.getNode();
+
+        while (node) {
+            int idx = findSymbol(node, name, (unsigned int)-1);
+
+            if (idx != -1) {
+                var = get(idx);
+                return true;
             }
-        }
 
-        if (found_idx != -1) {
-            var = variables[found_idx];
-            return true;
-        } else {
-            var = Variable(Variable::EVariableTypes::UNDEFINED, DUMMY_SCOPE, name, "", "", CodeLocation());
-            return false;
+            node = scopeRange == EScopeRange::INHERITANCE ? node->parent : NULL;
         }
+
+        var = Variable(Variable::EVariableTypes::UNDEFINED, Scope(), name, "", "", CodeLocation());
+        return false;
     }
 
     // idx - the function refernce index in Variables table
@@ -468,73 +597,136 @@ public:
 
 };
 
-class Parser
+// The rows of the source changed since the previous compilation, see 'Parser::parse'.
+// Rows 'first_row'..'last_row' of the new source replace rows 'first_row'..'last_row - row_delta' of the previous one.
+// The default means nothing has changed.
+struct SourceEdit
+{
+    int first_row{ INT_MAX };
+    int last_row{ INT_MAX };
+    int row_delta{ 0 };
+};
+
+class Parser
 {
 public:
     enum EArithOperators {ADD, SUB, MUL, DIV};
     enum class EExtendedAssignOperation { NONE, ADD, SUB, MUL, DIV };
     enum class EDataMode {STATIC, DYNAMIC};
+    enum class EStatement {ASSIGNMENT, VARIABLE_DECLARATION, BLOCK, FUNCTION_DEFINITION, BLOCK_END};
 
     Parser();
 
 private:
+    // Scripts with at least so many top-level functions compile the function bodies in parallel
+    static const unsigned int PARALLEL_FUNCTIONS_MIN = 8;
+
+    // A top-level function whose body is compiled after the top-level pass
+    struct DeferredFunction
+    {
+        unsigned int body_pos;      // The token index of the body's '{'
+        Scope function_scope;
+        unsigned int fun_var_pos;
+        Bytecode header;            // Allocation of the function variable and parameters
+        unsigned int first_variable;    // Variables visible from the body are below. The body declares its own ones from here on
+        Variables variables;            // Variables declared by the body
+        Bytecode code;
+        RetVal ret;
+        CodeLocation body_start;        // Positions of the body's '{' and '}'
+        CodeLocation body_end;
+        unsigned int body_tokens;
+        size_t symbols_hash;            // Hash of the variables visible from the body, see 'symbol_hashes'
+    };
+
     std::string FLOAT_DATATYPE = "f";
     std::string UNKNOWN_DATATYPE = "-1";
 
     Variables variables;
-    std::vector<unsigned int> function_refs;    // Ids of function variables. Initially they contain references to functions in the 'function_bytecode'. They need to be udjasted after merging 'function_bytecode to 'bytecode'
+    ScopeTree scope_tree;
+    Tokenizer tokenizer;
+    const Tokenizer* source;        // The tokens being parsed. Workers compiling function bodies share them with the main parser
+    bool build_trace{ false };      // Diagnostic pass. Failed rules add their ParseTrace nodes
+    ParseFailure furthest_failure;
+    bool defer_functions{ false };
+    std::deque<DeferredFunction> deferred_functions;
+    bool incremental{ false };      // Keep the compiled top-level function bodies for the next compilation
+    std::unordered_map<unsigned int, DeferredFunction> compiled_functions;   // <function ScopeNode id, function>. Unlinked
+    int source_length{ 0 };
+    unsigned int threads{ 0 };      // The most threads compiling the deferred function bodies, with the idle CompilePool workers; 0 - all cores
 
     const std::string& upcast_datatype(const std::string& datatype);
     const std::string& maxDatatype(const std::string& datatype_1, const std::string& datatype_2);
     bool isDatatypeNumeric(const std::string& datatype);
-    bool isReserved(std::string const& s);
-    bool check_symbol(std::string const& s, const CodeLocation& pos, char symbol);
-    bool check_string(std::string const& s, CodeLocation& pos, std::string const& str);
-    void whitespace(std::string const& s, CodeLocation& pos);
-    bool isTerminal(std::string const& s, const CodeLocation& pos);
+    // 'pos' is the index of the current token. Grammar functions advance it on success and restore it on failure.
+    const Token& token(unsigned int pos) const;
+    const CodeLocation& location(unsigned int pos) const;
+    bool check_symbol(unsigned int pos, char symbol) const;
+    bool check_symbol(unsigned int pos, const char* symbol) const;
+    bool check_keyword(unsigned int& pos, EKeyword keyword) const;
+    char check_simple_datatype(unsigned int& pos) const;
+    void trace_error(ParseTrace& parse_trace, ParseTrace& child_parse_trace, unsigned int pos, EParseStatus status);
+    void trace_error(ParseTrace& parse_trace, unsigned int pos, EParseStatus status);
+    EStatement statement_type(unsigned int pos) const;
     bool process_array_datatype(std::string& datatype, const std::string& index_datatype);
-//    ETokenizeStatus tokenize(std::string const& s);
-    bool identifier_first_char(std::string const& s, const CodeLocation& pos);
-    bool identifier_char(std::string const& s, const CodeLocation& pos);
-    bool string_char(std::string const& s, CodeLocation& pos);
-    bool digit(std::string const& s, CodeLocation& pos);
-    RetVal unsigned_float(std::string const& s, CodeLocation& pos, ParseTrace& parse_trace, std::string& value);
-    RetVal unsigned_integer(std::string const& s, CodeLocation& pos, ParseTrace& parse_trace, std::string& value);
-    RetVal string_expression(std::string const& s, CodeLocation& pos, ParseTrace& parse_trace, std::string& value);
-    RetVal boolean_value(std::string const& s, CodeLocation& pos, ParseTrace& parse_trace, std::string& value);
-    RetVal literals(std::string const& s, CodeLocation& pos, ParseTrace& parse_trace, EAssignmentPosition assign_pos, Bytecode& bytecode, std::string& datatype);
-    RetVal primary_expression(std::string const& s, CodeLocation& pos, ParseTrace& parse_trace, EAssignmentPosition assign_pos, Bytecode& bytecode, std::string& datatype, const Scope& scope);
-    RetVal identifier(std::string const& s, CodeLocation& pos, ParseTrace& parse_trace, Variable& variable, const Scope& scope, Variables::EScopeRange scopeRange);
-    RetVal argumentlist_expression(std::string const& s, CodeLocation& pos, ParseTrace& parse_trace, EAssignmentPosition assign_pos, Bytecode& bytecode, std::string& datatype, int& param_count, const Scope& scope);
-    RetVal postfix_expression(std::string const& s, CodeLocation& pos, ParseTrace& parse_trace, EAssignmentPosition assign_pos, Bytecode& bytecode, std::string& datatype, const Scope& scope);
-    RetVal unary_operator(std::string const& s, CodeLocation& pos, ParseTrace& parse_trace, std::string& datatype);
-    RetVal unary_expression(std::string const& s, CodeLocation& pos, ParseTrace& parse_trace, EAssignmentPosition assign_pos, Bytecode& bytecode, std::string& datatype, const Scope& scope);
-    RetVal mult_operator(std::string const& s, CodeLocation& pos, ParseTrace& parse_trace, EArithOperators& arith_operator);
-    RetVal mult_expression(std::string const& s, CodeLocation& pos, ParseTrace& parse_trace, EAssignmentPosition assign_pos, Bytecode& bytecode, std::string& datatype, const Scope& scope);
-    RetVal additive_operator(std::string const& s, CodeLocation& pos, ParseTrace& parse_trace, EArithOperators& arith_operator);
-    RetVal additive_expression(std::string const& s, CodeLocation& pos, ParseTrace& parse_trace, EAssignmentPosition assign_pos, Bytecode& bytecode, std::string& datatype, const Scope& scope);
-    RetVal relation_operator(std::string const& s, CodeLocation& pos, ParseTrace& parse_trace, Bytecode& bytecode);
-    RetVal relational_expression(std::string const& s, CodeLocation& pos, ParseTrace& parse_trace, EAssignmentPosition assign_pos, Bytecode& bytecode, std::string& datatype, const Scope& scope);
-    RetVal logical_and_expression(std::string const& s, CodeLocation& pos, ParseTrace& parse_trace, EAssignmentPosition assign_pos, Bytecode& bytecode, std::string& datatype, const Scope& scope);
-    RetVal logical_or_expression(std::string const& s, CodeLocation& pos, ParseTrace& parse_trace, EAssignmentPosition assign_pos, Bytecode& bytecode, std::string& datatype, const Scope& scope);
-    RetVal conditional_expression(std::string const& s, CodeLocation& pos, ParseTrace& parse_trace, EAssignmentPosition assign_pos, Bytecode& bytecode, std::string& datatype, const Scope& scope);
-    RetVal assignment_operator(std::string const& s, CodeLocation& pos, ParseTrace& parse_trace, Bytecode& bytecode, EExtendedAssignOperation& extendedOperation);
-    RetVal assignment_expression(std::string const& s, CodeLocation& pos, ParseTrace& parse_trace, Bytecode& bytecode, const Scope& scope);
-    RetVal index_type_declaration(std::string const& s, CodeLocation& pos, ParseTrace& parse_trace, std::string& datatype);
-    RetVal type_declaration(std::string const& s, CodeLocation& pos, ParseTrace& parse_trace, std::string& datatype);
-    RetVal variable_declaration(std::string const& s, CodeLocation& pos, ParseTrace& parse_trace, const Scope& scope, EDataMode data_mode, std::string& variable_datatype, unsigned int& variable_idx, std::vector<unsigned int>& function_variables);
-    RetVal function_parameters_declaration(std::string const& s, CodeLocation& pos, ParseTrace& parse_trace, std::vector<unsigned int>& parameter_idxs, const Scope& scope, std::string& parameter_types);
-    RetVal function_definition(std::string const& s, CodeLocation& pos, ParseTrace& parse_trace, Bytecode& bytecode, Bytecode& function_bytecode, const Scope& parent_scope);
-    RetVal block_statement(std::string const& s, CodeLocation& pos, ParseTrace& parse_trace, Bytecode& bytecode, Bytecode& function_bytecode, const Scope& scope, EDataMode data_mode, std::vector<unsigned int>& function_variables);
-    RetVal translation_unit(std::string const& s, CodeLocation& pos, ParseTrace& parse_trace, Bytecode& bytecode, Bytecode& function_bytecode, const Scope& scope, EDataMode data_mode, std::vector<unsigned int>& function_variables);
+    RetVal unsigned_float(unsigned int& pos, ParseTrace& parse_trace, std::string& value);
+    RetVal unsigned_integer(unsigned int& pos, ParseTrace& parse_trace, std::string& value);
+    RetVal string_expression(unsigned int& pos, ParseTrace& parse_trace, std::string& value);
+    RetVal boolean_value(unsigned int& pos, ParseTrace& parse_trace, std::string& value);
+    RetVal literals(unsigned int& pos, ParseTrace& parse_trace, EAssignmentPosition assign_pos, Bytecode& bytecode, std::string& datatype);
+    RetVal primary_expression(unsigned int& pos, ParseTrace& parse_trace, EAssignmentPosition assign_pos, Bytecode& bytecode, std::string& datatype, const Scope& scope);
+    RetVal identifier(unsigned int& pos, ParseTrace& parse_trace, Variable& variable, const Scope& scope, Variables::EScopeRange scopeRange);
+    RetVal argumentlist_expression(unsigned int& pos, ParseTrace& parse_trace, EAssignmentPosition assign_pos, Bytecode& bytecode, std::string& datatype, int& param_count, const Scope& scope);
+    RetVal postfix_expression(unsigned int& pos, ParseTrace& parse_trace, EAssignmentPosition assign_pos, Bytecode& bytecode, std::string& datatype, const Scope& scope);
+    RetVal unary_operator(unsigned int& pos, ParseTrace& parse_trace, std::string& datatype);
+    RetVal unary_expression(unsigned int& pos, ParseTrace& parse_trace, EAssignmentPosition assign_pos, Bytecode& bytecode, std::string& datatype, const Scope& scope);
+    RetVal mult_operator(unsigned int& pos, ParseTrace& parse_trace, EArithOperators& arith_operator);
+    RetVal mult_expression(unsigned int& pos, ParseTrace& parse_trace, EAssignmentPosition assign_pos, Bytecode& bytecode, std::string& datatype, const Scope& scope);
+    RetVal additive_operator(unsigned int& pos, ParseTrace& parse_trace, EArithOperators& arith_operator);
+    RetVal additive_expression(unsigned int& pos, ParseTrace& parse_trace, EAssignmentPosition assign_pos, Bytecode& bytecode, std::string& datatype, const Scope& scope);
+    RetVal relation_operator(unsigned int& pos, ParseTrace& parse_trace, Bytecode& bytecode);
+    RetVal relational_expression(unsigned int& pos, ParseTrace& parse_trace, EAssignmentPosition assign_pos, Bytecode& bytecode, std::string& datatype, const Scope& scope);
+    RetVal logical_and_expression(unsigned int& pos, ParseTrace& parse_trace, EAssignmentPosition assign_pos, Bytecode& bytecode, std::string& datatype, const Scope& scope);
+    RetVal logical_or_expression(unsigned int& pos, ParseTrace& parse_trace, EAssignmentPosition assign_pos, Bytecode& bytecode, std::string& datatype, const Scope& scope);
+    RetVal conditional_expression(unsigned int& pos, ParseTrace& parse_trace, EAssignmentPosition assign_pos, Bytecode& bytecode, std::string& datatype, const Scope& scope);
+    RetVal assignment_operator(unsigned int& pos, ParseTrace& parse_trace, Bytecode& bytecode, EExtendedAssignOperation& extendedOperation);
+    RetVal assignment_expression(unsigned int& pos, ParseTrace& parse_trace, Bytecode& bytecode, const Scope& scope);
+    RetVal index_type_declaration(unsigned int& pos, ParseTrace& parse_trace, std::string& datatype);
+    RetVal type_declaration(unsigned int& pos, ParseTrace& parse_trace, std::string& datatype);
+    RetVal variable_declaration(unsigned int& pos, ParseTrace& parse_trace, const Scope& scope, EDataMode data_mode, std::string& variable_datatype, unsigned int& variable_idx, std::vector<unsigned int>& function_variables);
+    RetVal function_parameters_declaration(unsigned int& pos, ParseTrace& parse_trace, std::vector<unsigned int>& parameter_idxs, const Scope& scope, std::string& parameter_types);
+    RetVal function_definition(unsigned int& pos, ParseTrace& parse_trace, Bytecode& bytecode, Bytecode& function_bytecode, const Scope& parent_scope);
+    RetVal function_body(unsigned int& pos, ParseTrace& parse_trace, Bytecode& function_bytecode, const Scope& function_scope, unsigned int fun_var_pos);
+    RetVal block_statement(unsigned int& pos, ParseTrace& parse_trace, Bytecode& bytecode, Bytecode& function_bytecode, const Scope& scope, EDataMode data_mode, std::vector<unsigned int>& function_variables);
+    RetVal translation_unit(unsigned int& pos, ParseTrace& parse_trace, Bytecode& bytecode, Bytecode& function_bytecode, const Scope& scope, EDataMode data_mode, std::vector<unsigned int>& function_variables);
     void initVars(Bytecode& bytecode, const Scope& scope);
+    RetVal parse_tokens(ParseTrace& parse_trace, Bytecode& bytecode);
+    unsigned int count_root_functions() const;
+    unsigned int skip_block(unsigned int pos) const;
+    void compile_deferred_function(DeferredFunction& function);
+    std::vector<size_t> symbol_hashes();
+    void apply_edit(const SourceEdit& edit, int pos_delta);
+    bool reuse_compiled_function(DeferredFunction& function);
+    EParseStatus compile(std::string const& s, ParseTrace& parse_trace, Bytecode& bytecode);
+    RetVal compile_deferred_functions(Bytecode& function_bytecode);
 
 public:
     static bool isDatatypeConsistent(const std::string& datatype_1, const std::string& datatype_2);
     static bool isDatatypeConsistentAssignment(const std::string& datatype_1, const std::string& datatype_2);
     static bool isDatatypeConsistentFunctionArguments(const std::string& datatype_1, const std::string& datatype_2);
     EParseStatus parse(std::string const& s, ParseTrace& parse_trace, Bytecode& bytecode);
+    EParseStatus parse(std::string const& s, const SourceEdit& edit, ParseTrace& parse_trace, Bytecode& bytecode);
     void clear();
+
+    // Frees the tokens and the symbol table of the last compilation, the next compilation builds them again.
+    // The function bodies kept for the incremental compilation stay.
+    void release();
+    // The approximate memory the parser holds between compilations (bytes)
+    size_t getMemoryEstimate() const;
+
+    // 0 - use all cores
+    void setThreads(unsigned int thread_count) { threads = thread_count; }
+
+    const ParseFailure& getFurthestFailure() const { return furthest_failure; }
 };
 
 #endif // PARSER_H
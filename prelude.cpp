@@ -0,0 +1,83 @@
+#include "prelude.h"
+
+/*******************************************
+ * class Prelude
+ *******************************************/
+
+Prelude::Prelude()
+{
+    // Predefined constants
+    addConstant("true", true);
+    addConstant("false", false);
+
+    // Predefined functions
+    addFunction("sin", "f", "f");
+    addFunction("cos", "f", "f");
+    addFunction("print", "b", "s");      // Writes a line to the program output, see OutputBuffer
+
+    // Link once, so the copies are single blocks of code
+    functions.getCode();
+    initialization.getCode();
+}
+
+const Prelude& Prelude::instance()
+{
+    static Prelude prelude;
+    return prelude;
+}
+
+unsigned int Prelude::declare(Variable::EVariableTypes entity_type, const std::string& function, const std::string& name, const std::string& type, const std::string& type_fun_params)
+{
+    declarations.push_back(Declaration{ entity_type, function, name, type, type_fun_params });
+
+    return declarations.size() - 1;
+}
+
+void Prelude::addConstant(const std::string& name, bool value)
+{
+    unsigned int var_pos = declare(Variable::EVariableTypes::BUILTIN_VARIABLE, "", name, "b", "");
+
+    initialization.PUTADDR(var_pos);
+    initialization.PUTBOOLEAN(value);
+    initialization.MOVE();
+}
+
+void Prelude::addFunction(const std::string& name, const std::string& type, const std::string& param_type)
+{
+    unsigned int fun_idx = declare(Variable::EVariableTypes::BUILTIN_FUNCTION, "", name, type, param_type);
+    unsigned int par_idx = declare(Variable::EVariableTypes::DYNAMIC_VARIABLE, name, "x", param_type, "");
+    unsigned int fun_pos = functions.ALLOCVAR(fun_idx);
+
+    functions.ALLOCVARS(par_idx);
+    functions.PUTDADDR(fun_idx);
+    functions.SYSCALL(par_idx, name.data());     // SYSCALL puts the result to the stack
+    functions.MOVE();
+    functions.RETURN(fun_idx);
+    functions.addFunction(fun_idx, fun_pos);
+}
+
+// The symbols are declared per compilation, because the parser looks them up by its own scope tree
+void Prelude::declare(Variables& variables, const Scope& root) const
+{
+    unsigned int pos;
+
+    for (const Declaration& d: declarations) {
+        Scope scope = d.function.empty() ? root : Scope(root, d.function);
+
+        variables.add(Variable(d.entity_type, scope, d.name, d.type, d.type_fun_params, CodeLocation()), pos);
+    }
+}
+
+void Prelude::appendFunctions(Bytecode& function_bytecode) const
+{
+    Bytecode code(functions);   // += moves the code out of its operand
+
+    function_bytecode += code;
+}
+
+void Prelude::appendInitialization(Bytecode& bytecode) const
+{
+    Bytecode code(initialization);
+
+    bytecode += code;
+}
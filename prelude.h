@@ -0,0 +1,51 @@
+#ifndef PRELUDE_H
+#define PRELUDE_H
+
+#include <string>
+#include <vector>
+#include "parser.h"
+#include "bytecode.h"
+
+// The builtin constants and functions every program is linked against.
+// The prelude is assembled once per process on the first use and doesn't change afterwards, so the parsers of all
+// sessions share it. Its symbols are declared before any other symbol of a program, so they get the variable
+// indexes 0..n-1 the prelude code has been assembled with.
+class Prelude
+{
+private:
+    struct Declaration
+    {
+        Variable::EVariableTypes entity_type;
+        std::string function;       // The builtin function the variable is a parameter of, empty on the root level
+        std::string name;
+        std::string type;
+        std::string type_fun_params;
+    };
+
+    std::vector<Declaration> declarations;
+    Bytecode functions;         // Linked, goes to the start of the function section
+    Bytecode initialization;    // Linked, sets the builtin constants before the program runs
+
+    Prelude();
+
+    // Returns the variable index of the declaration
+    unsigned int declare(Variable::EVariableTypes entity_type, const std::string& function, const std::string& name, const std::string& type, const std::string& type_fun_params);
+    void addConstant(const std::string& name, bool value);
+    // A function of one parameter computed by the system call 'name'
+    void addFunction(const std::string& name, const std::string& type, const std::string& param_type);
+
+public:
+    Prelude(const Prelude&) = delete;
+    Prelude& operator=(const Prelude&) = delete;
+
+    static const Prelude& instance();
+
+    // Declares the prelude symbols in the 'root' scope of the 'variables', which don't hold other symbols yet
+    void declare(Variables& variables, const Scope& root) const;
+
+    // Append copies of the prelude code
+    void appendFunctions(Bytecode& function_bytecode) const;
+    void appendInitialization(Bytecode& bytecode) const;
+};
+
+#endif // PRELUDE_H
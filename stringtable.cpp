@@ -0,0 +1,60 @@
+#include "stringtable.h"
+
+/*******************************************
+ * class StringTable
+ *******************************************/
+
+StringTable& StringTable::instance()
+{
+    static StringTable table;
+    return table;
+}
+
+const std::string* StringTable::intern(const std::string& s)
+{
+    Shard& sh = shard(s);
+    std::lock_guard<std::mutex> lock(sh.strings_mutex);
+
+    auto it = sh.strings.emplace(s, 0).first;
+    it->second++;
+
+    return &(it->first);
+}
+
+const std::string* StringTable::find(const std::string& s)
+{
+    Shard& sh = shard(s);
+    std::lock_guard<std::mutex> lock(sh.strings_mutex);
+
+    auto it = sh.strings.find(s);
+
+    return it == sh.strings.end() ? NULL : &(it->first);
+}
+
+void StringTable::release(const std::string* s)
+{
+    if (s == NULL) {
+        return;
+    }
+
+    Shard& sh = shard(*s);
+    std::lock_guard<std::mutex> lock(sh.strings_mutex);
+
+    auto it = sh.strings.find(*s);
+
+    if (it != sh.strings.end() && --(it->second) == 0) {
+        sh.strings.erase(it);
+    }
+}
+
+size_t StringTable::size()
+{
+    size_t count = 0;
+
+    for (Shard& sh: shards) {
+        std::lock_guard<std::mutex> lock(sh.strings_mutex);
+        count += sh.strings.size();
+    }
+
+    return count;
+}
@@ -0,0 +1,49 @@
+#ifndef STRINGTABLE_H
+#define STRINGTABLE_H
+
+#include <string>
+#include <unordered_map>
+#include <mutex>
+
+// The process-wide string intern table.
+// Every distinct string value is stored once. The returned pointer identifies the value:
+// two interned strings are equal if and only if their pointers are equal.
+// Entries are reference counted - each 'intern' call must be balanced with 'release'.
+// The table is split into shards by the hash of the string, each with its own lock, so threads interning
+// and releasing different strings rarely wait for each other.
+class StringTable
+{
+private:
+    static constexpr size_t SHARDS = 64;
+
+    struct alignas(64) Shard
+    {
+        std::unordered_map<std::string, unsigned int> strings; // <value, reference count>; node based, so key addresses are stable
+        std::mutex strings_mutex;
+    };
+
+    Shard shards[SHARDS];
+
+    StringTable() {}
+
+    Shard& shard(const std::string& s) { return shards[std::hash<std::string>()(s) % SHARDS]; }
+
+public:
+    StringTable(const StringTable&) = delete;
+    StringTable& operator=(const StringTable&) = delete;
+
+    static StringTable& instance();
+
+    // Returns the interned copy of 's' and takes a reference to it
+    const std::string* intern(const std::string& s);
+
+    // Returns the interned copy of 's' or NULL if 's' has never been interned. No reference is taken.
+    const std::string* find(const std::string& s);
+
+    // Drops the reference taken by 'intern'. The entry is removed when nobody uses it anymore.
+    void release(const std::string* s);
+
+    size_t size();
+};
+
+#endif // STRINGTABLE_H
@@ -0,0 +1,438 @@
+#include "textbuffer.h"
+#include <algorithm>
+#include <cstring>
+
+static bool isContinuation(char c)
+{
+    return (c & 0xC0) == 0x80;
+}
+
+/*******************************************
+ * class TextBuffer
+ *******************************************/
+
+TextBuffer::TextBuffer(const std::string& text) :
+    original(text)
+{
+    if (!original.empty()) {
+        findNewlines(original, 0, original_newlines);
+        length = original.size();
+        newlines = original_newlines.size();
+        pieces.push_back({ false, 0, length, newlines });
+        styles.push_back({ length, EForegroundStyle::NORMAL, EBackgroundStyle::NORMAL });
+        is_indexed = false;
+    }
+
+    countRowLengths(0, newlines, true);
+}
+
+// Appends the positions of the '\n' in the 's', which starts at the 'start' of its buffer
+void TextBuffer::findNewlines(const std::string& s, size_t start, std::vector<size_t>& positions)
+{
+    for (const char* p = s.data(); (p = (const char*)memchr(p, '\n', s.data() + s.size() - p)) != NULL; p++) {
+        positions.push_back(start + (p - s.data()));
+    }
+}
+
+// The '\n' in the first 'count' bytes of the 'piece'
+size_t TextBuffer::countNewlines(const Piece& piece, size_t count) const
+{
+    const std::vector<size_t>& positions = bufferNewlines(piece);
+
+    return std::lower_bound(positions.begin(), positions.end(), piece.start + count)
+        - std::lower_bound(positions.begin(), positions.end(), piece.start);
+}
+
+void TextBuffer::index() const
+{
+    if (is_indexed) {
+        return;
+    }
+
+    size_t offset = 0, rows = 0;
+
+    piece_offsets.resize(pieces.size());
+    piece_rows.resize(pieces.size());
+
+    for (size_t i=0; i<pieces.size(); i++) {
+        piece_offsets[i] = offset;
+        piece_rows[i] = rows;
+        offset += pieces[i].length;
+        rows += pieces[i].newlines;
+    }
+
+    is_indexed = true;
+}
+
+// The piece containing the byte at the 'offset', the number of the pieces at the end of the text
+size_t TextBuffer::findPiece(size_t offset) const
+{
+    if (offset >= length) {
+        return pieces.size();
+    }
+
+    index();
+    return std::upper_bound(piece_offsets.begin(), piece_offsets.end(), offset) - piece_offsets.begin() - 1;
+}
+
+// The offset of the first byte of the 'row'. The rows after the last one start at its start.
+size_t TextBuffer::rowStart(size_t row) const
+{
+    row = std::min(row, newlines);
+
+    if (row == 0) {
+        return 0;
+    }
+
+    // The piece with the newline ending the previous row, then the newline in its buffer
+    index();
+    size_t i = std::lower_bound(piece_rows.begin(), piece_rows.end(), row) - piece_rows.begin() - 1;
+    const Piece& piece = pieces[i];
+    const std::vector<size_t>& positions = bufferNewlines(piece);
+    size_t k = std::lower_bound(positions.begin(), positions.end(), piece.start) - positions.begin() + (row - piece_rows[i]) - 1;
+
+    return piece_offsets[i] + (positions[k] - piece.start) + 1;
+}
+
+// The offset 'chars' characters after the 'offset', but not beyond the end of its row
+size_t TextBuffer::advance(size_t offset, size_t chars) const
+{
+    for (size_t i = findPiece(offset); i<pieces.size(); i++) {
+        const char* p = data(pieces[i]);
+        size_t pos = offset - piece_offsets[i];
+
+        for (; pos<pieces[i].length; pos++, offset++) {
+            if (isContinuation(p[pos])) {
+                continue;
+            }
+            if (chars == 0 || p[pos] == '\n') {
+                return offset;
+            }
+            chars--;
+        }
+    }
+
+    return offset;
+}
+
+void TextBuffer::copy(size_t from, size_t to, std::string& s) const
+{
+    s.reserve(s.size() + (to - from));
+
+    for (size_t i = findPiece(from); i<pieces.size() && from<to; i++) {
+        size_t pos = from - piece_offsets[i];
+        size_t count = std::min(pieces[i].length - pos, to - from);
+
+        s.append(data(pieces[i]) + pos, count);
+        from += count;
+    }
+}
+
+size_t TextBuffer::rowLength(size_t row) const
+{
+    size_t start = rowStart(row);
+    size_t chars = 0;
+
+    for (size_t i = findPiece(start); i<pieces.size(); i++) {
+        const char* p = data(pieces[i]);
+
+        for (size_t pos = start - piece_offsets[i]; pos<pieces[i].length; pos++) {
+            if (p[pos] == '\n') {
+                return chars;
+            }
+            if (!isContinuation(p[pos])) {
+                chars++;
+            }
+        }
+
+        start = piece_offsets[i] + pieces[i].length;
+    }
+
+    return chars;
+}
+
+size_t TextBuffer::maxRowLength() const
+{
+    return row_lengths.rbegin()->first;
+}
+
+// Adds the lengths of the rows 'first_row'..'last_row' to 'row_lengths' or removes them. One pass over the rows.
+void TextBuffer::countRowLengths(size_t first_row, size_t last_row, bool add)
+{
+    auto count = [this, add](size_t chars) {
+        if (add) {
+            row_lengths[chars]++;
+        } else {
+            auto it = row_lengths.find(chars);
+
+            if (it != row_lengths.end() && --(it->second) == 0) {
+                row_lengths.erase(it);
+            }
+        }
+    };
+
+    size_t offset = rowStart(first_row);
+    size_t row = first_row;
+    size_t chars = 0;
+
+    for (size_t i = findPiece(offset); i<pieces.size(); i++) {
+        const char* p = data(pieces[i]);
+
+        for (size_t pos = offset - piece_offsets[i]; pos<pieces[i].length; pos++) {
+            if (p[pos] == '\n') {
+                count(chars);
+                chars = 0;
+
+                if (++row > last_row) {
+                    return;
+                }
+            } else if (!isContinuation(p[pos])) {
+                chars++;
+            }
+        }
+
+        offset = piece_offsets[i] + pieces[i].length;
+    }
+
+    // The last row ends with the text
+    count(chars);
+}
+
+std::string TextBuffer::getText(size_t row_start, size_t col_start, size_t row_end, size_t col_end) const
+{
+    std::string s;
+
+    copy(offsetOf(row_start, col_start), offsetOf(row_end, col_end), s);
+    return s;
+}
+
+std::string TextBuffer::text() const
+{
+    std::string s;
+
+    copy(0, length, s);
+    return s;
+}
+
+void TextBuffer::getRowRuns(size_t row, size_t first_col, std::vector<TextRun>& runs) const
+{
+    size_t from = offsetOf(row, first_col);
+    size_t to = advance(from, std::string::npos);
+
+    runs.clear();
+
+    // The style run containing 'from'
+    size_t style = 0, style_end = 0;
+
+    for (; style<styles.size(); style++) {
+        style_end += styles[style].length;
+        if (style_end > from) {
+            break;
+        }
+    }
+
+    while (from < to) {
+        size_t end = std::min(to, style_end);
+
+        runs.push_back(TextRun());
+        runs.back().foreground = styles[style].foreground;
+        runs.back().background = styles[style].background;
+        copy(from, end, runs.back().utf8);
+
+        from = end;
+        if (++style < styles.size()) {
+            style_end += styles[style].length;
+        }
+    }
+}
+
+EBackgroundStyle TextBuffer::backgroundAt(size_t row, size_t col) const
+{
+    size_t offset = offsetOf(row, col);
+    size_t end = 0;
+
+    for (const StyleRun& style: styles) {
+        end += style.length;
+        if (end > offset) {
+            return style.background;
+        }
+    }
+
+    return EBackgroundStyle::NORMAL;
+}
+
+// Makes a piece start at the 'offset' and returns its index
+size_t TextBuffer::split(size_t offset)
+{
+    size_t i = findPiece(offset);
+
+    if (i == pieces.size() || piece_offsets[i] == offset) {
+        return i;
+    }
+
+    Piece& piece = pieces[i];
+    size_t head = offset - piece_offsets[i];
+    size_t head_newlines = countNewlines(piece, head);
+    Piece tail = { piece.is_added, piece.start + head, piece.length - head, piece.newlines - head_newlines };
+
+    piece.length = head;
+    piece.newlines = head_newlines;
+    pieces.insert(pieces.begin() + i + 1, tail);
+    is_indexed = false;
+
+    return i + 1;
+}
+
+void TextBuffer::insertBytes(size_t offset, const std::string& s)
+{
+    size_t count = added_newlines.size();
+    size_t i = split(offset);
+
+    findNewlines(s, added.size(), added_newlines);
+    count = added_newlines.size() - count;
+
+    // Typing appends to the piece which ends with the last added text
+    if (i > 0 && pieces[i - 1].is_added && pieces[i - 1].start + pieces[i - 1].length == added.size()) {
+        pieces[i - 1].length += s.size();
+        pieces[i - 1].newlines += count;
+    } else {
+        pieces.insert(pieces.begin() + i, { true, added.size(), s.size(), count });
+    }
+
+    added += s;
+    length += s.size();
+    newlines += count;
+    is_indexed = false;
+
+    // The style
+    size_t j = splitStyle(offset);
+
+    styles.insert(styles.begin() + j, { s.size(), EForegroundStyle::NORMAL, EBackgroundStyle::NORMAL });
+    mergeStyles();
+}
+
+void TextBuffer::eraseBytes(size_t from, size_t to)
+{
+    size_t first = split(from);
+    size_t last = split(to);
+
+    for (size_t i=first; i<last; i++) {
+        length -= pieces[i].length;
+        newlines -= pieces[i].newlines;
+    }
+
+    pieces.erase(pieces.begin() + first, pieces.begin() + last);
+    is_indexed = false;
+
+    // The style
+    first = splitStyle(from);
+    last = splitStyle(to);
+    styles.erase(styles.begin() + first, styles.begin() + last);
+    mergeStyles();
+}
+
+void TextBuffer::insert(size_t row, size_t col, const std::string& utf8, size_t& end_row, size_t& end_col)
+{
+    // The row and the column may be past the end of the text
+    row = std::min(row, newlines);
+
+    size_t offset = offsetOf(row, col);
+    col = std::min(col, rowLength(row));
+
+    if (!utf8.empty()) {
+        countRowLengths(row, row, false);
+        insertBytes(offset, utf8);
+        countRowLengths(row, row + std::count(utf8.begin(), utf8.end(), '\n'), true);
+    }
+
+    // The position after the inserted text
+    size_t last_newline = utf8.rfind('\n');
+    size_t last_chars = 0;
+
+    for (size_t pos = last_newline == std::string::npos ? 0 : last_newline + 1; pos<utf8.size(); pos++) {
+        if (!isContinuation(utf8[pos])) {
+            last_chars++;
+        }
+    }
+
+    end_row = row + std::count(utf8.begin(), utf8.end(), '\n');
+    end_col = last_newline == std::string::npos ? col + last_chars : last_chars;
+}
+
+void TextBuffer::erase(size_t row_start, size_t col_start, size_t row_end, size_t col_end)
+{
+    size_t from = offsetOf(row_start, col_start);
+    size_t to = offsetOf(row_end, col_end);
+
+    if (from < to) {
+        row_start = std::min(row_start, newlines);
+        row_end = std::min(row_end, newlines);
+
+        countRowLengths(row_start, row_end, false);
+        eraseBytes(from, to);
+        countRowLengths(row_start, row_start, true);
+    }
+}
+
+// A style run starting at the 'offset', its index
+size_t TextBuffer::splitStyle(size_t offset)
+{
+    size_t i = 0, start = 0;
+
+    for (; i<styles.size(); i++) {
+        if (start == offset) {
+            return i;
+        }
+        if (start + styles[i].length > offset) {
+            StyleRun tail = styles[i];
+
+            tail.length = start + styles[i].length - offset;
+            styles[i].length = offset - start;
+            styles.insert(styles.begin() + i + 1, tail);
+
+            return i + 1;
+        }
+        start += styles[i].length;
+    }
+
+    return i;
+}
+
+void TextBuffer::mergeStyles()
+{
+    size_t last = 0;
+
+    for (size_t i=0; i<styles.size(); i++) {
+        if (styles[i].length == 0) {
+            continue;
+        }
+
+        if (last > 0 && styles[last - 1].foreground == styles[i].foreground && styles[last - 1].background == styles[i].background) {
+            styles[last - 1].length += styles[i].length;
+        } else {
+            styles[last++] = styles[i];
+        }
+    }
+
+    styles.resize(last);
+}
+
+void TextBuffer::applyBackground(size_t row_start, size_t col_start, size_t row_end, size_t col_end,
+    EBackgroundStyle style, EBackgroundStyle oper(EBackgroundStyle, EBackgroundStyle))
+{
+    size_t from = offsetOf(row_start, col_start);
+    size_t to = offsetOf(row_end, col_end);
+
+    if (from >= to) {
+        return;
+    }
+
+    size_t first = splitStyle(from);
+    size_t last = splitStyle(to);
+
+    for (size_t i=first; i<last; i++) {
+        styles[i].background = oper(styles[i].background, style);
+    }
+
+    mergeStyles();
+}
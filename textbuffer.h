@@ -0,0 +1,115 @@
+#ifndef TEXTBUFFER_H
+#define TEXTBUFFER_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <cstddef>
+
+enum class EBackgroundStyle : int {
+    NORMAL   = 1 << 0,
+    KEYWORD  = 1 << 1,
+    SELECTED = 1 << 2
+};
+enum class EForegroundStyle : int {
+    NORMAL  = 1 << 0,
+    KEYWORD = 1 << 1
+};
+
+// Characters of one style in a row, see TextBuffer::getRowRuns
+struct TextRun
+{
+    std::string utf8;
+    EForegroundStyle foreground{ EForegroundStyle::NORMAL };
+    EBackgroundStyle background{ EBackgroundStyle::NORMAL };
+};
+
+// The text of the CodeEditor. A piece table over UTF-8 bytes: the loaded text and the text added since are kept
+// in two buffers which are never changed, only appended to, and the text is the sequence of pieces of them.
+// Inserting or erasing splits a piece or two, whatever the amount of text, and typing extends the last piece.
+// The positions of the newlines in both buffers are kept too, so a row is found by binary searches.
+// The styles are a separate run-length layer over the same bytes.
+// The lengths of the rows are counted by an edit only for the rows it changes, so the longest row is known without a scan.
+// Positions are (row, col), the column counts UTF-8 characters. Rows are separated by '\n'.
+class TextBuffer
+{
+private:
+    struct Piece
+    {
+        bool is_added;          // In 'added', else in 'original'
+        size_t start;
+        size_t length;
+        size_t newlines;
+    };
+
+    struct StyleRun
+    {
+        size_t length;
+        EForegroundStyle foreground;
+        EBackgroundStyle background;
+    };
+
+    std::string original;
+    std::string added;
+    std::vector<size_t> original_newlines;  // The positions of the '\n' in the buffers, ascending
+    std::vector<size_t> added_newlines;
+    std::vector<Piece> pieces;
+    std::vector<StyleRun> styles;   // Cover the text exactly
+    size_t length{ 0 };
+    size_t newlines{ 0 };
+    std::map<size_t, size_t> row_lengths;   // <length of a row, rows of the length>
+
+    // The bytes and the rows before each piece. Rebuilt by the first lookup after an edit.
+    mutable std::vector<size_t> piece_offsets;
+    mutable std::vector<size_t> piece_rows;
+    mutable bool is_indexed{ true };
+
+    const char* data(const Piece& piece) const {
+        return (piece.is_added ? added.data() : original.data()) + piece.start;
+    }
+    const std::vector<size_t>& bufferNewlines(const Piece& piece) const {
+        return piece.is_added ? added_newlines : original_newlines;
+    }
+
+    static void findNewlines(const std::string& s, size_t start, std::vector<size_t>& positions);
+    size_t countNewlines(const Piece& piece, size_t count) const;
+
+    void index() const;
+    size_t findPiece(size_t offset) const;
+    size_t rowStart(size_t row) const;
+    size_t advance(size_t offset, size_t chars) const;
+    size_t offsetOf(size_t row, size_t col) const { return advance(rowStart(row), col); }
+    void copy(size_t from, size_t to, std::string& s) const;
+
+    size_t split(size_t offset);
+    void insertBytes(size_t offset, const std::string& s);
+    void eraseBytes(size_t from, size_t to);
+    void countRowLengths(size_t first_row, size_t last_row, bool add);
+
+    size_t splitStyle(size_t offset);
+    void mergeStyles();
+
+public:
+    TextBuffer() : row_lengths{ { 0, 1 } } {}
+    explicit TextBuffer(const std::string& text);
+
+    size_t rowCount() const { return newlines + 1; }
+    size_t rowLength(size_t row) const;
+    size_t maxRowLength() const;
+
+    std::string getText(size_t row_start, size_t col_start, size_t row_end, size_t col_end) const;
+    std::string text() const;
+
+    // The characters of the 'row' from the column 'first_col' on, split where the style changes
+    void getRowRuns(size_t row, size_t first_col, std::vector<TextRun>& runs) const;
+    EBackgroundStyle backgroundAt(size_t row, size_t col) const;
+
+    // The inserted text has the normal style. 'end_row' and 'end_col' are set to the position after it.
+    void insert(size_t row, size_t col, const std::string& utf8, size_t& end_row, size_t& end_col);
+    void erase(size_t row_start, size_t col_start, size_t row_end, size_t col_end);
+
+    void applyBackground(size_t row_start, size_t col_start, size_t row_end, size_t col_end,
+        EBackgroundStyle style, EBackgroundStyle oper(EBackgroundStyle, EBackgroundStyle));
+};
+
+#endif // TEXTBUFFER_H
@@ -0,0 +1,303 @@
+#include "tokenizer.h"
+#include <cstring>
+#include <array>
+
+// Symbols which may be followed by '=' to form a two-character operator
+const char two_char_symbol_prefixes[] = "=!<>+-*/";
+const char one_char_symbols[] = ",+-*/()[]{}.<>!=?:";
+
+struct KeywordEntry
+{
+    const char* text;
+    EKeyword keyword;
+};
+
+constexpr KeywordEntry keywords[] = {
+    { "and", EKeyword::AND },
+    { "or", EKeyword::OR },
+    { "not", EKeyword::NOT },
+    { "int", EKeyword::INT },
+    { "float", EKeyword::FLOAT },
+    { "string", EKeyword::STRING },
+    { "boolean", EKeyword::BOOLEAN },
+    { "array", EKeyword::ARRAY },
+    { "of", EKeyword::OF },
+    { "function", EKeyword::FUNCTION },
+    { "true", EKeyword::TRUE_VALUE },
+    { "false", EKeyword::FALSE_VALUE }
+};
+
+const unsigned int KEYWORD_COUNT = sizeof(keywords) / sizeof(keywords[0]);
+const unsigned int KEYWORD_TABLE_SIZE = 32;     // A power of 2
+const size_t MIN_KEYWORD_LENGTH = 2;
+const size_t MAX_KEYWORD_LENGTH = 8;
+
+// Keywords are case insensitive. Setting the bit 0x20 turns upper case letters to lower case
+// and doesn't turn any other identifier character into a letter.
+static constexpr char lowerCase(char c)
+{
+    return c | 0x20;
+}
+
+// The hash of the length and the first and the last character. It has no collisions for the keywords.
+static constexpr unsigned int keywordHash(const char* s, size_t len)
+{
+    return (len + lowerCase(s[0]) * 11 + lowerCase(s[len - 1])) & (KEYWORD_TABLE_SIZE - 1);
+}
+
+static constexpr size_t textLength(const char* s)
+{
+    size_t len = 0;
+
+    while (s[len]) len++;
+
+    return len;
+}
+
+// <keyword hash, index in 'keywords'>; -1 - no keyword has the hash
+static constexpr std::array<signed char, KEYWORD_TABLE_SIZE> keywordSlots()
+{
+    std::array<signed char, KEYWORD_TABLE_SIZE> slots{};
+
+    for (unsigned int i=0; i<KEYWORD_TABLE_SIZE; i++) {
+        slots[i] = -1;
+    }
+    for (unsigned int i=0; i<KEYWORD_COUNT; i++) {
+        slots[keywordHash(keywords[i].text, textLength(keywords[i].text))] = i;
+    }
+
+    return slots;
+}
+
+static constexpr bool isKeywordHashPerfect()
+{
+    std::array<signed char, KEYWORD_TABLE_SIZE> slots = keywordSlots();
+    unsigned int used = 0;
+
+    for (unsigned int i=0; i<KEYWORD_TABLE_SIZE; i++) {
+        if (slots[i] != -1) used++;
+    }
+    for (unsigned int i=0; i<KEYWORD_COUNT; i++) {
+        size_t len = textLength(keywords[i].text);
+
+        if (len < MIN_KEYWORD_LENGTH || len > MAX_KEYWORD_LENGTH) return false;
+    }
+
+    return used == KEYWORD_COUNT;
+}
+
+static_assert(isKeywordHashPerfect(), "The keyword hash has collisions. Change the multiplier in 'keywordHash'.");
+
+constexpr std::array<signed char, KEYWORD_TABLE_SIZE> keyword_slots = keywordSlots();
+
+static bool isIdentifierFirstChar(char c)
+{
+    return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || c == '_';
+}
+
+static bool isIdentifierChar(char c)
+{
+    return isIdentifierFirstChar(c) || (c >= '0' && c <= '9');
+}
+
+static bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+/*******************************************
+ * class Tokenizer
+ *******************************************/
+
+// One probe of the perfect hash table and one comparison. 's' is an identifier.
+EKeyword Tokenizer::keyword(const std::string& s)
+{
+    size_t len = s.length();
+
+    if (len < MIN_KEYWORD_LENGTH || len > MAX_KEYWORD_LENGTH) {
+        return EKeyword::NONE;
+    }
+
+    int slot = keyword_slots[keywordHash(s.data(), len)];
+
+    if (slot == -1) {
+        return EKeyword::NONE;
+    }
+
+    // A shorter keyword ends with a mismatch on its terminating zero, lowerCase is never 0
+    const char* text = keywords[slot].text;
+    size_t i;
+
+    for (i=0; i<len; i++) {
+        if (lowerCase(s[i]) != text[i]) {
+            return EKeyword::NONE;
+        }
+    }
+
+    return text[len] == '\0' ? keywords[slot].keyword : EKeyword::NONE;
+}
+
+EKeyword Tokenizer::keywordByScan(const std::string& s)
+{
+    for (const KeywordEntry& entry : keywords) {
+        size_t len = strlen(entry.text);
+
+        if (s.length() != len) continue;
+
+        size_t i;
+        for (i=0; i<len; i++) {
+            if (lowerCase(s[i]) != entry.text[i]) break;
+        }
+
+        if (i == len) {
+            return entry.keyword;
+        }
+    }
+
+    return EKeyword::NONE;
+}
+
+unsigned int Tokenizer::addText(const std::string& text)
+{
+    auto it = text_ids.find(text);
+
+    if (it != text_ids.end()) {
+        return it->second;
+    }
+
+    unsigned int id = texts.size();
+    texts.push_back(text);
+    text_ids[text] = id;
+
+    return id;
+}
+
+void Tokenizer::addToken(ETokenType type, const std::string& s, const CodeLocation& start, int end)
+{
+    Token token;
+
+    token.type = type;
+    token.keyword = EKeyword::NONE;
+    token.symbol = 0;
+    token.pos = start;
+
+    switch (type) {
+        case ETokenType::STRING:
+            token.text_id = addText(s.substr(start.pos + 1, end - start.pos - 2)); // Skip quotation marks
+            break;
+        case ETokenType::SYMBOL:
+            token.text_id = addText(s.substr(start.pos, end - start.pos));
+            token.symbol = symbolCode(texts[token.text_id].c_str());
+            break;
+        case ETokenType::IDENTIFIER:
+            token.text_id = addText(s.substr(start.pos, end - start.pos));
+            token.keyword = keyword(texts[token.text_id]);
+            break;
+        default:
+            token.text_id = addText(s.substr(start.pos, end - start.pos));
+            break;
+    }
+
+    tokens.push_back(token);
+}
+
+void Tokenizer::clear()
+{
+    tokens.clear();
+    texts.clear();
+    text_ids.clear();
+}
+
+// Only whitespaces start a new line. Like the parser always did, line breaks inside strings just advance the column.
+void Tokenizer::tokenize(const std::string& s)
+{
+    int s_len = s.length();
+    CodeLocation pos(0, 0, 0);
+
+    clear();
+    tokens.reserve(s_len / 3 + 1);
+
+    while (pos.pos < s_len) {
+        char c = s[pos.pos];
+
+        // Whitespaces
+        if (c == ' ' || c == '\t' || c == '\n') {
+            if (c == '\n') {
+                pos.col = 0;
+                pos.row++;
+            } else {
+                pos.col++;
+            }
+
+            pos.pos++;
+            continue;
+        }
+
+        CodeLocation start = pos;
+        int end = pos.pos;
+        ETokenType type;
+
+        if (isIdentifierFirstChar(c)) {
+            while (end < s_len && isIdentifierChar(s[end])) end++;
+            type = ETokenType::IDENTIFIER;
+        } else if (isDigit(c)) {
+            while (end < s_len && isDigit(s[end])) end++;
+            type = ETokenType::INTEGER;
+
+            if (end < s_len && s[end] == '.') {
+                end++;
+                type = ETokenType::INVALID; // A float needs digits after the dot
+
+                while (end < s_len && isDigit(s[end])) {
+                    end++;
+                    type = ETokenType::FLOAT;
+                }
+            }
+
+            // A number glued to an identifier, e.g. "12ab"
+            if (end < s_len && isIdentifierChar(s[end])) {
+                while (end < s_len && isIdentifierChar(s[end])) end++;
+                type = ETokenType::INVALID;
+            }
+        } else if (c == '"') {
+            end++;
+            type = ETokenType::INVALID;
+
+            while (end < s_len) {
+                if (s[end] == '"') {
+                    end++;
+                    type = ETokenType::STRING;
+                    break;
+                }
+
+                if (end + 1 < s_len && s[end] == '\\' && (s[end + 1] == '"' || s[end + 1] == '\\')) {
+                    end += 2;
+                } else {
+                    end++;
+                }
+            }
+        } else if (c != '\0' && strchr(two_char_symbol_prefixes, c) != NULL && pos.pos + 1 < s_len && s[pos.pos + 1] == '=') {
+            end += 2;
+            type = ETokenType::SYMBOL;
+        } else if (c != '\0' && strchr(one_char_symbols, c) != NULL) {
+            end++;
+            type = ETokenType::SYMBOL;
+        } else {
+            end++;
+            type = ETokenType::INVALID;
+        }
+
+        addToken(type, s, start, end);
+
+        pos.col += end - pos.pos;
+        pos.pos = end;
+    }
+
+    Token eof;
+    eof.type = ETokenType::END_OF_FILE;
+    eof.keyword = EKeyword::NONE;
+    eof.symbol = 0;
+    eof.text_id = addText(std::string());
+    eof.pos = pos;
+    tokens.push_back(eof);
+}
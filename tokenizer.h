@@ -0,0 +1,86 @@
+#ifndef TOKENIZER_H
+#define TOKENIZER_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+class CodeLocation {
+public:
+    CodeLocation() {}
+    CodeLocation(int pos, int row, int col) : pos(pos), row(row), col(col) {}
+    int pos{ -1 };
+    int row{ -1 };
+    int col{ -1 };
+
+    void set(int pos, int row, int col) {
+        this->pos = pos;
+        this->row = row;
+        this->col = col;
+    }
+
+    CodeLocation operator+(int inc) {
+        return CodeLocation(pos + inc, col + inc, row);
+    }
+};
+
+enum class ETokenType : unsigned char {
+    END_OF_FILE,
+    IDENTIFIER,     // Identifiers and keywords
+    INTEGER,
+    FLOAT,
+    STRING,         // The text is the string without quotation marks
+    SYMBOL,         // Operators and punctuation
+    INVALID         // Anything else, including an unterminated string
+};
+
+enum class EKeyword : unsigned char {
+    NONE, AND, OR, NOT, INT, FLOAT, STRING, BOOLEAN, ARRAY, OF, FUNCTION, TRUE_VALUE, FALSE_VALUE
+};
+
+struct Token
+{
+    ETokenType type;
+    EKeyword keyword;       // IDENTIFIER only. Keywords are case insensitive.
+    unsigned short symbol;  // SYMBOL only. See Tokenizer::symbolCode
+    unsigned int text_id;   // Index of the token text in the tokenizer's text table
+    CodeLocation pos;
+};
+
+// Splits the source into tokens in one pass.
+// Equal token texts are stored once and referenced by 'text_id'.
+// The token array always ends with an END_OF_FILE token.
+class Tokenizer
+{
+private:
+    std::vector<Token> tokens;
+    std::vector<std::string> texts;
+    std::unordered_map<std::string, unsigned int> text_ids;
+
+    unsigned int addText(const std::string& text);
+    void addToken(ETokenType type, const std::string& s, const CodeLocation& start, int end);
+
+public:
+    void tokenize(const std::string& s);
+    void clear();
+
+    const std::vector<Token>& getTokens() const { return tokens; }
+    const std::string& getText(unsigned int text_id) const { return texts[text_id]; }
+    const std::string& getText(const Token& token) const { return texts[token.text_id]; }
+
+    // Packs one or two symbol characters into the value stored in Token::symbol
+    static unsigned short symbolCode(const char* symbol) {
+        return (unsigned char)symbol[0] | (symbol[0] ? (unsigned char)symbol[1] << 8 : 0);
+    }
+
+    static EKeyword keyword(const std::string& s);
+    // The same classification by a linear scan of the keywords. The reference for the keyword benchmark.
+    static EKeyword keywordByScan(const std::string& s);
+
+    // Reserved words can't be used as identifiers
+    static bool isReserved(EKeyword keyword) {
+        return keyword != EKeyword::NONE && keyword != EKeyword::TRUE_VALUE && keyword != EKeyword::FALSE_VALUE;
+    }
+};
+
+#endif // TOKENIZER_H
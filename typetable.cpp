@@ -0,0 +1,103 @@
+#include "typetable.h"
+
+/*******************************************
+ * class TypeTable
+ *******************************************/
+
+TypeTable::TypeTable() : count(0)
+{
+    for (unsigned int i=0; i<MAX_CHUNKS; i++) {
+        chunks[i].store(NULL, std::memory_order_relaxed);
+    }
+
+    // Register predefined datatypes in the order of ETypeIds
+    std::lock_guard<std::mutex> lock(types_mutex);
+
+    addType("");
+    addType("i");
+    addType("f");
+    addType("s");
+    addType("b");
+}
+
+TypeTable::~TypeTable()
+{
+    for (unsigned int i=0; i<MAX_CHUNKS; i++) {
+        delete[] chunks[i].load(std::memory_order_relaxed);
+    }
+}
+
+TypeTable& TypeTable::instance()
+{
+    static TypeTable table;
+    return table;
+}
+
+TypeId TypeTable::getTypeId(const std::string& signature)
+{
+    std::lock_guard<std::mutex> lock(types_mutex);
+
+    return addType(signature);
+}
+
+// Must be called with 'types_mutex' locked
+TypeId TypeTable::addType(const std::string& signature)
+{
+    auto it = ids.find(signature);
+
+    if (it != ids.end()) {
+        return it->second;
+    }
+
+    TypeDescriptor descriptor;
+    descriptor.signature = signature;
+    descriptor.kind = signature.empty() ? 0 : signature[0];
+
+    if (descriptor.kind == 'a') {
+        // "a [i,s] <element datatype>"
+        unsigned int i;
+
+        for (i=3; i<signature.size(); i++) {
+            char c = signature[i];
+
+            if (c == ']') {
+                i+=2; // Skip ']' and following ' '
+                break;
+            }
+            if (c == ',') continue;
+            descriptor.index_datatypes.push_back(c);
+        }
+
+        descriptor.element_type = addType(i < signature.size() ? signature.substr(i) : std::string());
+    }
+
+    if (count >= CHUNK_SIZE * MAX_CHUNKS) {
+        return TYPE_UNDEFINED; // The table is full
+    }
+
+    TypeId id = (TypeId)count;
+    TypeDescriptor* chunk = chunks[id / CHUNK_SIZE].load(std::memory_order_relaxed);
+
+    if (chunk == NULL) {
+        chunk = new TypeDescriptor[CHUNK_SIZE];
+        chunks[id / CHUNK_SIZE].store(chunk, std::memory_order_release);
+    }
+
+    chunk[id % CHUNK_SIZE] = descriptor;
+    count++;
+    ids[signature] = id;
+
+    return id;
+}
+
+TypeId TypeTable::scalarTypeId(char kind)
+{
+    switch (kind) {
+        case 'i': return TYPE_INT;
+        case 'f': return TYPE_FLOAT;
+        case 's': return TYPE_STRING;
+        case 'b': return TYPE_BOOLEAN;
+    }
+
+    return TYPE_UNDEFINED;
+}
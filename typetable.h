@@ -0,0 +1,80 @@
+#ifndef TYPETABLE_H
+#define TYPETABLE_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+
+// The compact datatype identifier - an index into the TypeTable
+typedef unsigned short TypeId;
+
+// Predefined type ids. Composite (array) types get ids starting from TYPE_FIRST_COMPOSITE.
+enum ETypeIds : TypeId {
+    TYPE_UNDEFINED      = 0,
+    TYPE_INT            = 1,
+    TYPE_FLOAT          = 2,
+    TYPE_STRING         = 3,
+    TYPE_BOOLEAN        = 4,
+    TYPE_FIRST_COMPOSITE = 5
+};
+
+struct TypeDescriptor
+{
+    std::string signature;              // The datatype string as produced by the parser, e.g. "i", "a [i,s] f"
+    char kind;                          // 'i', 'f', 's', 'b', 'a'; 0 - undefined
+    std::vector<char> index_datatypes;  // Arrays only: datatypes of indexes
+    TypeId element_type;                // Arrays only: datatype of elements
+
+    TypeDescriptor() : kind(0), element_type(TYPE_UNDEFINED) {}
+};
+
+// The process-wide table of interned datatypes.
+// Every distinct datatype signature is parsed once and gets a small integer id,
+// so datatype checks become integer compares.
+// Descriptors are never removed, so ids and descriptor references stay valid for the process lifetime.
+class TypeTable
+{
+private:
+    static const unsigned int CHUNK_SIZE = 256;
+    static const unsigned int MAX_CHUNKS = 256;    // TypeId is 16-bit
+
+    // Descriptors are stored in fixed size chunks which never move, so 'get' doesn't need a lock
+    std::atomic<TypeDescriptor*> chunks[MAX_CHUNKS];
+    unsigned int count;
+    std::unordered_map<std::string, TypeId> ids;    // <signature, id>
+    std::mutex types_mutex;
+
+    TypeTable();
+    ~TypeTable();
+
+    TypeId addType(const std::string& signature);
+
+public:
+    TypeTable(const TypeTable&) = delete;
+    TypeTable& operator=(const TypeTable&) = delete;
+
+    static TypeTable& instance();
+
+    // Returns the id of the datatype given by its signature. Registers the datatype if needed.
+    TypeId getTypeId(const std::string& signature);
+
+    const TypeDescriptor& get(TypeId id) const {
+        return chunks[id / CHUNK_SIZE].load(std::memory_order_acquire)[id % CHUNK_SIZE];
+    }
+
+    const std::string& getSignature(TypeId id) const {
+        return get(id).signature;
+    }
+
+    // Returns the datatype kind: 'i', 'f', 's', 'b', 'a' or 0 for undefined
+    static char kind(TypeId id) {
+        return (id < TYPE_FIRST_COMPOSITE) ? "\0ifsb"[id] : instance().get(id).kind;
+    }
+
+    // Returns the id of the scalar datatype 'i', 'f', 's', 'b'
+    static TypeId scalarTypeId(char kind);
+};
+
+#endif // TYPETABLE_H
@@ -1,6 +1,12 @@
 #include "vm.h"
 #include "parser.h"
+#include "stringtable.h"
+#include "diagnostics.h"
 #include <cmath>
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+#include <climits>
 #include <boost/algorithm/string/erase.hpp>
 
 char datatypes_string[] = {
@@ -27,6 +33,10 @@ Element::Element(const std::string& val) : datatype(EDataTypes::STRING), value(v
 {
 }
 
+Element::Element(std::string&& val) : datatype(EDataTypes::STRING), value(std::move(val))
+{
+}
+
 Element::Element(bool val) : datatype(EDataTypes::BOOLEAN), value(val)
 {
 }
@@ -35,7 +45,11 @@ Element::Element(const Array& val) : datatype(EDataTypes::ARRAY), value(val)
 {
 }
 
-Element::Element(EDataTypes datatype, void* val) : datatype(EDataTypes::ADDRESS), value(datatype, val)
+Element::Element(EDataTypes datatype, void* val) : datatype(EDataTypes::ADDRESS), value(datatype, val, false)
+{
+}
+
+Element::Element(const std::string* interned_val) : datatype(EDataTypes::ADDRESS), value(EDataTypes::STRING, (void*)interned_val, true)
 {
 }
 
@@ -53,17 +67,38 @@ Element::Element(const Element& other)
     }
 }
 
-Element& Element::operator=(const Element& other) {
+Element::Element(Element&& other) noexcept
+{
     datatype = other.datatype;
     switch(datatype) {
         case EDataTypes::UNKNOWN: break;
         case EDataTypes::INT: value.intVal = other.value.intVal; break;
         case EDataTypes::FLOAT: value.floatVal = other.value.floatVal; break;
-        case EDataTypes::STRING: new (&value.stringVal) std::string(other.value.stringVal); break;
+        case EDataTypes::STRING: new (&value.stringVal) std::string(std::move(other.value.stringVal)); break;
         case EDataTypes::BOOLEAN: value.booleanVal = other.value.booleanVal; break;
         case EDataTypes::ADDRESS: value.addrVal = other.value.addrVal; break;
         case EDataTypes::ARRAY: new (&value.arrayVal) Array(other.value.arrayVal); break;
     }
+}
+
+Element& Element::operator=(const Element& other) {
+    if (this == &other) {
+        return *this;
+    }
+
+    this->~Element();
+    new (this) Element(other);
+
+    return *this;
+}
+
+Element& Element::operator=(Element&& other) noexcept {
+    if (this == &other) {
+        return *this;
+    }
+
+    this->~Element();
+    new (this) Element(std::move(other));
 
     return *this;
 }
@@ -127,10 +162,69 @@ bool Element::isDatatypeMatch(unsigned char d) {
         || (d == 'a' && final_datatype == EDataTypes::ARRAY);
 }
 
+bool Element::isInterned() const {
+    return datatype == EDataTypes::ADDRESS && value.addrVal.interned;
+}
+
 /***********************************************
  * VM implementation
  ***********************************************/
 
+// Appends 'tail' to 'str' in place.
+// The capacity grows geometrically so building a string with repeated appends ('s += t', 's = s + t')
+// stays linear in the final length instead of reallocating on every step.
+// The growth of an 'owned' string (a variable or an array value) is charged to the memory account, a temporary
+// is only checked against the quota. Returns false, leaving the string unchanged, if the quota doesn't allow the growth.
+static bool appendString(std::string& str, const std::string& tail, bool owned)
+{
+    size_t required = str.size() + tail.size();
+
+    if (required > str.capacity()) {
+        size_t capacity = std::max(required, 2 * str.capacity());
+        size_t old_size = owned ? MemoryAccount::stringSize(str) : 0;
+
+        if (!MemoryAccount::canAllocate(capacity + 1 - old_size)) {
+            return false;
+        }
+
+        str.reserve(capacity);
+
+        if (owned) {
+            MemoryAccount::recharge(old_size, MemoryAccount::stringSize(str));
+        }
+    }
+
+    str.append(tail);
+
+    return true;
+}
+
+// Assigns a value to a string owned by a variable or an array value and charges the change of its buffer
+template<class T>
+static void assignString(std::string& str, T&& value)
+{
+    size_t old_size = MemoryAccount::stringSize(str);
+
+    str = std::forward<T>(value);
+    MemoryAccount::recharge(old_size, MemoryAccount::stringSize(str));
+}
+
+// Whether the quota allows copying the array 'source' over the array 'target' (NULL for a new array).
+// The target's values are freed first and its arena is reused, so its memory is taken off the estimate.
+static bool canCopyArray(const Array& source, const Array* target)
+{
+    size_t required = source.memorySize();
+    size_t freed = target != NULL ? target->memorySize() : 0;
+
+    return required <= freed || MemoryAccount::canAllocate(required - freed);
+}
+
+// Whether the quota allows merging the array 'source' into another one. At most every element of it is added.
+static bool canMergeArray(const Array& source)
+{
+    return MemoryAccount::canAllocate(source.memorySize());
+}
+
 const char* exec_status_descriptions[] = {
     "OK_RUN", 
     "OK_STOP", 
@@ -174,6 +268,7 @@ const char* exec_status_descriptions[] = {
     "EXEC_ERROR_SYSCALL_COS_STRING_NOT_SUPPORTED",
     "EXEC_ERROR_SYSCALL_COS_BOOLEAN_NOT_SUPPORTED",
     "EXEC_ERROR_SYSCALL_COS_INCONSISTENT_DATATYPES",
+    "EXEC_ERROR_SYSCALL_PRINT_INCONSISTENT_DATATYPES",
     "EXEC_ERROR_SYSCALL_UNKNOWN_FUNCTION",
     "EXEC_ERROR_RETURN_NO_RETURN_POINT",
     "EXEC_ERROR_PUTINDADDR_EXPECTED_ADDRESS",
@@ -192,7 +287,10 @@ const char* exec_status_descriptions[] = {
     "EXEC_ERROR_MOVEMUL_ARRAY_NOT_SUPPORTED",
     "EXEC_ERROR_ADD_ARRAY_NOT_SUPPORTED",
     "EXEC_ERROR_SUB_ARRAY_NOT_SUPPORTED",
-    "EXEC_ERROR_NEG_ARRAY_NOT_SUPPORTED"
+    "EXEC_ERROR_NEG_ARRAY_NOT_SUPPORTED",
+    "EXEC_ERROR_MEMORY_QUOTA_EXCEEDED",
+    "EXEC_CANCELLED",
+    "EXEC_YIELDED"
 };
 
 VM::VM()
@@ -201,9 +299,26 @@ VM::VM()
 }
 
 VM::~VM() {
+    releaseCallStack();
+    releaseStringLiterals();
+}
+
+void VM::releaseCallStack()
+{
     for(int i=0; i<callstack.size(); i++) {
         delete callstack[i];
     }
+
+    std::vector<CallStackEntry*>().swap(callstack);
+}
+
+void VM::releaseStringLiterals()
+{
+    for (auto& literal: string_literals) {
+        StringTable::instance().release(literal.second.value);
+    }
+
+    string_literals.clear();
 }
 
 EDataTypes VM::decodeDatatype(const Datatype& variable) {
@@ -245,23 +360,100 @@ bool VM::isDatatypeConsistentAssignment(EDataTypes datatype_1, EDataTypes dataty
 void VM::init()
 {
     stack.clear();
+    cancel_requested = false;
+    memory.reset();
 }
 
 
 void VM::execute(Bytecode& bytecode, EExecStatus& status)
 {
+    start(bytecode);
+    resume(bytecode, status, 0, 0);
+}
+
+void VM::start(Bytecode& bytecode)
+{
+    MemoryAccount::Scope memory_scope(memory);
+
+    // Link the code here, so that the first time slice doesn't pay for it
+    bytecode.getCode();
+
     // Create variables
     bytecode.makeAddresses();
 
+    started = true;
+    idx = 0;
+    executed_instructions = 0;
+    peak_call_depth = 0;
+}
+
+void VM::resume(Bytecode& bytecode, EExecStatus& status, unsigned long long max_instructions, unsigned long long max_us)
+{
+    MemoryAccount::Scope memory_scope(memory);
+
+    if (cancel_requested) {
+        status = EExecStatus::EXEC_CANCELLED;
+        finish(bytecode, status);
+        return;
+    }
+
+    std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+    unsigned long long last_instruction = max_instructions ? executed_instructions + max_instructions : ULLONG_MAX;
+
     // Execute the code
-    unsigned int i = 0;
-    while(interpret(bytecode, i, status));
+    while(interpret(bytecode, idx, status)) {
+        if (memory.isExceeded()) {
+            status = EExecStatus::EXEC_ERROR_MEMORY_QUOTA_EXCEEDED;
+            break;
+        }
 
-    printf("Program execution finished: %s\n", exec_status_descriptions[static_cast<int>(status)]);
-    bytecode.printVariables();
+        if (++executed_instructions == last_instruction) {
+            status = EExecStatus::EXEC_YIELDED;
+            return;
+        }
+
+        if (executed_instructions % CHECK_INTERVAL == 0) {
+            if (cancel_requested) {
+                status = EExecStatus::EXEC_CANCELLED;
+                break;
+            }
+            if (progress_handler) {
+                progress_handler(executed_instructions);
+            }
+            if (max_us && std::chrono::steady_clock::now() - start_time >= std::chrono::microseconds(max_us)) {
+                status = EExecStatus::EXEC_YIELDED;
+                return;
+            }
+        }
+    }
+
+    finish(bytecode, status);
+}
+
+void VM::finish(Bytecode& bytecode, EExecStatus status)
+{
+    started = false;
+
+    if (Diagnostics::isEnabled(EDiagnosticLevel::LEVEL_DEBUG)) {
+        std::ostringstream s;
+
+        s << "Program execution finished: " << exec_status_descriptions[static_cast<int>(status)] << "\n";
+        bytecode.printVariables(s);
+        Diagnostics::write(EDiagnosticLevel::LEVEL_DEBUG, s.str());
+    }
 
     // Dispose variables
     bytecode.disposeAddresses();
+    releaseStringLiterals();
+
+    // A finished program leaves nothing in the VM. An error may have left calls which haven't returned.
+    releaseCallStack();
+    std::vector<Element>().swap(stack);
+
+    // Everything charged to the program has been freed now, what's left is a leak or a missing credit
+    if (memory.getUsed() != 0 && Diagnostics::isEnabled(EDiagnosticLevel::LEVEL_ERROR)) {
+        Diagnostics::write(EDiagnosticLevel::LEVEL_ERROR, "Program memory not released: " + std::to_string(memory.getUsed()) + " bytes\n");
+    }
 }
 
 bool VM::moveValue(void* lvar, EDataTypes ldatatype, Element& rval, EDataTypes rdatatype, EDataTypes rfinal_datatype, EExecStatus& status) {
@@ -294,7 +486,7 @@ bool VM::moveValue(void* lvar, EDataTypes ldatatype, Element& rval, EDataTypes r
                 break;
             case EDataTypes::STRING:
                 if (ldatatype == EDataTypes::STRING) {
-                    *(std::string*)lvar = *(std::string*)r_val;
+                    assignString(*(std::string*)lvar, *(std::string*)r_val);
                 } else { // We shouldn't be here. Dataypes are inconsistent
                     status = EExecStatus::EXEC_ERROR_MOVE_INCONSISTEND_DATATYPES;
                     return false;
@@ -315,6 +507,11 @@ bool VM::moveValue(void* lvar, EDataTypes ldatatype, Element& rval, EDataTypes r
                         return false;
                     }
 
+                    if (!canCopyArray(*(Array*)r_val, (Array*)lvar)) {
+                        status = EExecStatus::EXEC_ERROR_MEMORY_QUOTA_EXCEEDED;
+                        return false;
+                    }
+
                     *(Array*)lvar = *(Array*)r_val;
                 } else { // We shouldn't be here. Dataypes are inconsistent
                     status = EExecStatus::EXEC_ERROR_MOVE_INCONSISTEND_DATATYPES;
@@ -344,7 +541,7 @@ bool VM::moveValue(void* lvar, EDataTypes ldatatype, Element& rval, EDataTypes r
                 break;
             case EDataTypes::STRING:
                 if (ldatatype == EDataTypes::STRING) {
-                    *(std::string*)lvar = rval.getValue().stringVal;
+                    assignString(*(std::string*)lvar, std::move(*(std::string*)rval.getVariablePhysicalAddress())); // rval is a temporary popped off the stack
                 } else { // We shouldn't be here. Dataypes are inconsistent
                     status = EExecStatus::EXEC_ERROR_MOVE_INCONSISTEND_DATATYPES;
                     return false;
@@ -365,6 +562,11 @@ bool VM::moveValue(void* lvar, EDataTypes ldatatype, Element& rval, EDataTypes r
                         return false;
                     }
 
+                    if (!canCopyArray(rval.getValue().arrayVal, (Array*)lvar)) {
+                        status = EExecStatus::EXEC_ERROR_MEMORY_QUOTA_EXCEEDED;
+                        return false;
+                    }
+
                     *(Array*)lvar = rval.getValue().arrayVal;
                 } else { // We shouldn't be here. Dataypes are inconsistent
                     status = EExecStatus::EXEC_ERROR_MOVE_INCONSISTEND_DATATYPES;
@@ -427,13 +629,13 @@ bool VM::interpret(Bytecode& bytecode, unsigned int& idx, EExecStatus& status)
             // Take indexes from the stack
             std::vector<Element> indexes;
             for(int i=0; i<n_idx; i++) {
-                Element idx_val = stack.back();
-                indexes.push_back(idx_val);
+                Element idx_val = std::move(stack.back());
+                indexes.push_back(std::move(idx_val));
                 stack.pop_back();
             }
 
             // Get Array variable
-            Element array_variable = stack.back();
+            Element array_variable = std::move(stack.back());
             stack.pop_back();
 
             EDataTypes array_var_datatype = array_variable.getDatatype();
@@ -459,10 +661,10 @@ bool VM::interpret(Bytecode& bytecode, unsigned int& idx, EExecStatus& status)
                     return false;
                 }
 
-                index_values.push_back(ValuePointer(std::string() + indexes[i].getFinalDatatypeString(), indexes[i].getVariablePhysicalAddress()));
+                index_values.push_back(ValuePointer(TypeTable::scalarTypeId(indexes[i].getFinalDatatypeString()), indexes[i].getVariablePhysicalAddress()));
             }
             
-            char arr_el_datatype = addr->getElementDatatype()[0];
+            char arr_el_datatype = TypeTable::kind(addr->getElementDatatype());
             EDataTypes stack_datatype = (arr_el_datatype == 'i') ? EDataTypes::INT :
                                         (arr_el_datatype == 'f') ? EDataTypes::FLOAT :
                                         (arr_el_datatype == 's') ? EDataTypes::STRING :
@@ -509,19 +711,29 @@ bool VM::interpret(Bytecode& bytecode, unsigned int& idx, EExecStatus& status)
             break;
         }
         case EInstrCodes::PUTSTRING: {
-            unsigned short c;
-            std::string str;
+            auto literal = string_literals.find(idx);
 
-            do {
-                c = code[idx++];
+            if (literal == string_literals.end()) {
+                // First execution - decode the literal and intern it
+                unsigned int literal_pos = idx;
+                unsigned short c;
+                std::string str;
 
-                if (c == 0) {
-                    break;
-                }
-                str += c;
-            } while(true);
+                do {
+                    c = code[idx++];
+
+                    if (c == 0) {
+                        break;
+                    }
+                    str += c;
+                } while(true);
+
+                literal = string_literals.emplace(literal_pos, StringLiteral(StringTable::instance().intern(str), idx - literal_pos)).first;
+            } else {
+                idx += literal->second.code_size;
+            }
 
-            stack.push_back(Element(str));
+            stack.push_back(Element(literal->second.value));
             break;
         }
         case EInstrCodes::PUTBOOLEAN: {
@@ -531,9 +743,9 @@ bool VM::interpret(Bytecode& bytecode, unsigned int& idx, EExecStatus& status)
             break;
         }
         case EInstrCodes::MOVE: { 
-            Element e_val = stack.back();
+            Element e_val = std::move(stack.back());
             stack.pop_back();
-            Element e_var = stack.back();
+            Element e_var = std::move(stack.back());
             stack.pop_back();
 
             EDataTypes e_var_datatype = e_var.getDatatype();
@@ -557,9 +769,9 @@ bool VM::interpret(Bytecode& bytecode, unsigned int& idx, EExecStatus& status)
             break;
         }
         case EInstrCodes::MOVEADD: {
-            Element e_val = stack.back();
+            Element e_val = std::move(stack.back());
             stack.pop_back();
-            Element e_var = stack.back();
+            Element e_var = std::move(stack.back());
             stack.pop_back();
 
             EDataTypes e_var_datatype = e_var.getDatatype();
@@ -605,7 +817,10 @@ bool VM::interpret(Bytecode& bytecode, unsigned int& idx, EExecStatus& status)
                         break;
                     case EDataTypes::STRING:
                         if (e_var_final_datatype == EDataTypes::STRING) {
-                            *(std::string*)l_var += *(std::string*)r_val;
+                            if (!appendString(*(std::string*)l_var, *(std::string*)r_val, true)) {
+                                status = EExecStatus::EXEC_ERROR_MEMORY_QUOTA_EXCEEDED;
+                                return false;
+                            }
                         } else { // We shouldn't be here. Dataypes are inconsistent
                             status = EExecStatus::EXEC_ERROR_MOVEADD_INCONSISTEND_DATATYPES;
                             return false;
@@ -621,6 +836,10 @@ bool VM::interpret(Bytecode& bytecode, unsigned int& idx, EExecStatus& status)
                         break;
                     case EDataTypes::ARRAY:
                         if (e_var_final_datatype == EDataTypes::ARRAY) {
+                            if (!canMergeArray(*(Array*)r_val)) {
+                                status = EExecStatus::EXEC_ERROR_MEMORY_QUOTA_EXCEEDED;
+                                return false;
+                            }
                             *(Array*)l_var += *(Array*)r_val;
                         } else { // We shouldn't be here. Dataypes are inconsistent
                             status = EExecStatus::EXEC_ERROR_MOVEADD_INCONSISTEND_DATATYPES;
@@ -654,7 +873,10 @@ bool VM::interpret(Bytecode& bytecode, unsigned int& idx, EExecStatus& status)
                         break;
                     case EDataTypes::STRING:
                         if (e_var_final_datatype == EDataTypes::STRING) {
-                            *(std::string*)l_var += e_val.getValue().stringVal;
+                            if (!appendString(*(std::string*)l_var, e_val.getValue().stringVal, true)) {
+                                status = EExecStatus::EXEC_ERROR_MEMORY_QUOTA_EXCEEDED;
+                                return false;
+                            }
                         } else { // We shouldn't be here. Dataypes are inconsistent
                             status = EExecStatus::EXEC_ERROR_MOVEADD_INCONSISTEND_DATATYPES;
                             return false;
@@ -670,6 +892,10 @@ bool VM::interpret(Bytecode& bytecode, unsigned int& idx, EExecStatus& status)
                         break;
                     case EDataTypes::ARRAY:
                         if (e_var_final_datatype == EDataTypes::ARRAY) {
+                            if (!canMergeArray(e_val.getValue().arrayVal)) {
+                                status = EExecStatus::EXEC_ERROR_MEMORY_QUOTA_EXCEEDED;
+                                return false;
+                            }
                             *(Array*)l_var += e_val.getValue().arrayVal;
                         } else { // We shouldn't be here. Dataypes are inconsistent
                             status = EExecStatus::EXEC_ERROR_MOVEADD_INCONSISTEND_DATATYPES;
@@ -686,9 +912,9 @@ bool VM::interpret(Bytecode& bytecode, unsigned int& idx, EExecStatus& status)
             break;
         }
         case EInstrCodes::MOVESUBTR: {
-            Element e_val = stack.back();
+            Element e_val = std::move(stack.back());
             stack.pop_back();
-            Element e_var = stack.back();
+            Element e_var = std::move(stack.back());
             stack.pop_back();
 
             EDataTypes e_var_datatype = e_var.getDatatype();
@@ -792,9 +1018,9 @@ bool VM::interpret(Bytecode& bytecode, unsigned int& idx, EExecStatus& status)
             break;
         }
         case EInstrCodes::MOVEMUL: {
-            Element e_val = stack.back();
+            Element e_val = std::move(stack.back());
             stack.pop_back();
-            Element e_var = stack.back();
+            Element e_var = std::move(stack.back());
             stack.pop_back();
 
             EDataTypes e_var_datatype = e_var.getDatatype();
@@ -893,9 +1119,9 @@ bool VM::interpret(Bytecode& bytecode, unsigned int& idx, EExecStatus& status)
             break;
         }
         case EInstrCodes::MOVEDIV: {
-            Element e_val = stack.back();
+            Element e_val = std::move(stack.back());
             stack.pop_back();
-            Element e_var = stack.back();
+            Element e_var = std::move(stack.back());
             stack.pop_back();
 
             EDataTypes e_var_datatype = e_var.getDatatype();
@@ -1006,9 +1232,9 @@ bool VM::interpret(Bytecode& bytecode, unsigned int& idx, EExecStatus& status)
             break;
         }
         case EInstrCodes::EQUAL: {
-            Element e_rval = stack.back();
+            Element e_rval = std::move(stack.back());
             stack.pop_back();
-            Element e_lval = stack.back();
+            Element e_lval = std::move(stack.back());
             stack.pop_back();
 
             EDataTypes e_lval_datatype = e_lval.getDatatype();
@@ -1035,7 +1261,11 @@ bool VM::interpret(Bytecode& bytecode, unsigned int& idx, EExecStatus& status)
             } else if (e_lval_final_datatype == EDataTypes::FLOAT && e_rval_final_datatype == EDataTypes::INT) {
                 stack.push_back(Element(*(long double*)p_l_val == *(long long int*)p_r_val));
             } else if (e_lval_final_datatype == EDataTypes::STRING && e_rval_final_datatype == EDataTypes::STRING) {
-                stack.push_back(Element(*(std::string*)p_l_val == *(std::string*)p_r_val));
+                if (e_lval.isInterned() && e_rval.isInterned()) {
+                    stack.push_back(Element(p_l_val == p_r_val));
+                } else {
+                    stack.push_back(Element(*(std::string*)p_l_val == *(std::string*)p_r_val));
+                }
             } else if (e_lval_final_datatype == EDataTypes::BOOLEAN && e_rval_final_datatype == EDataTypes::BOOLEAN) {
                 stack.push_back(Element(*(bool*)p_l_val == *(bool*)p_r_val));
             } else if (e_lval_final_datatype == EDataTypes::ARRAY && e_rval_final_datatype == EDataTypes::ARRAY) {
@@ -1048,9 +1278,9 @@ bool VM::interpret(Bytecode& bytecode, unsigned int& idx, EExecStatus& status)
             break;
         }
         case EInstrCodes::NOTEQUAL: {
-            Element e_rval = stack.back();
+            Element e_rval = std::move(stack.back());
             stack.pop_back();
-            Element e_lval = stack.back();
+            Element e_lval = std::move(stack.back());
             stack.pop_back();
 
             EDataTypes e_lval_datatype = e_lval.getDatatype();
@@ -1077,7 +1307,11 @@ bool VM::interpret(Bytecode& bytecode, unsigned int& idx, EExecStatus& status)
             } else if (e_lval_final_datatype == EDataTypes::FLOAT && e_rval_final_datatype == EDataTypes::INT) {
                 stack.push_back(Element(*(long double*)p_l_val != *(long long int*)p_r_val));
             } else if (e_lval_final_datatype == EDataTypes::STRING && e_rval_final_datatype == EDataTypes::STRING) {
-                stack.push_back(Element(*(std::string*)p_l_val != *(std::string*)p_r_val));
+                if (e_lval.isInterned() && e_rval.isInterned()) {
+                    stack.push_back(Element(p_l_val != p_r_val));
+                } else {
+                    stack.push_back(Element(*(std::string*)p_l_val != *(std::string*)p_r_val));
+                }
             } else if (e_lval_final_datatype == EDataTypes::BOOLEAN && e_rval_final_datatype == EDataTypes::BOOLEAN) {
                 stack.push_back(Element(*(bool*)p_l_val != *(bool*)p_r_val));
             } else if (e_lval_final_datatype == EDataTypes::ARRAY && e_rval_final_datatype == EDataTypes::ARRAY) {
@@ -1090,9 +1324,9 @@ bool VM::interpret(Bytecode& bytecode, unsigned int& idx, EExecStatus& status)
             break;
         }
         case EInstrCodes::LESSEQUAL: {
-            Element e_rval = stack.back();
+            Element e_rval = std::move(stack.back());
             stack.pop_back();
-            Element e_lval = stack.back();
+            Element e_lval = std::move(stack.back());
             stack.pop_back();
 
             EDataTypes e_lval_datatype = e_lval.getDatatype();
@@ -1133,9 +1367,9 @@ bool VM::interpret(Bytecode& bytecode, unsigned int& idx, EExecStatus& status)
             break;
         }
         case EInstrCodes::GREATEREQUAL: {
-            Element e_rval = stack.back();
+            Element e_rval = std::move(stack.back());
             stack.pop_back();
-            Element e_lval = stack.back();
+            Element e_lval = std::move(stack.back());
             stack.pop_back();
 
             EDataTypes e_lval_datatype = e_lval.getDatatype();
@@ -1176,9 +1410,9 @@ bool VM::interpret(Bytecode& bytecode, unsigned int& idx, EExecStatus& status)
             break;
         }
         case EInstrCodes::LESS: {
-            Element e_rval = stack.back();
+            Element e_rval = std::move(stack.back());
             stack.pop_back();
-            Element e_lval = stack.back();
+            Element e_lval = std::move(stack.back());
             stack.pop_back();
 
             EDataTypes e_lval_datatype = e_lval.getDatatype();
@@ -1219,9 +1453,9 @@ bool VM::interpret(Bytecode& bytecode, unsigned int& idx, EExecStatus& status)
             break;
         }
         case EInstrCodes::GREATER: {
-            Element e_rval = stack.back();
+            Element e_rval = std::move(stack.back());
             stack.pop_back();
-            Element e_lval = stack.back();
+            Element e_lval = std::move(stack.back());
             stack.pop_back();
 
             EDataTypes e_lval_datatype = e_lval.getDatatype();
@@ -1262,7 +1496,7 @@ bool VM::interpret(Bytecode& bytecode, unsigned int& idx, EExecStatus& status)
             break;
         }
         case EInstrCodes::JUMPIFFALSE: {
-            Element e_val = stack.back(); // Pop the boolean value from the stack
+            Element e_val = std::move(stack.back()); // Pop the boolean value from the stack
             stack.pop_back();
 
             EDataTypes e_val_datatype = e_val.getDatatype();
@@ -1309,9 +1543,9 @@ bool VM::interpret(Bytecode& bytecode, unsigned int& idx, EExecStatus& status)
             break;
         }
         case EInstrCodes::MUL: {
-            Element e_rval = stack.back();
+            Element e_rval = std::move(stack.back());
             stack.pop_back();
-            Element e_lval = stack.back();
+            Element e_lval = std::move(stack.back());
             stack.pop_back();
 
             EDataTypes e_lval_datatype = e_lval.getDatatype();
@@ -1353,9 +1587,9 @@ bool VM::interpret(Bytecode& bytecode, unsigned int& idx, EExecStatus& status)
             break;
         }
         case EInstrCodes::DIV: {
-            Element e_rval = stack.back();
+            Element e_rval = std::move(stack.back());
             stack.pop_back();
-            Element e_lval = stack.back();
+            Element e_lval = std::move(stack.back());
             stack.pop_back();
 
             EDataTypes e_lval_datatype = e_lval.getDatatype();
@@ -1418,9 +1652,9 @@ bool VM::interpret(Bytecode& bytecode, unsigned int& idx, EExecStatus& status)
             break;
         }
         case EInstrCodes::ADD: {
-            Element e_rval = stack.back();
+            Element e_rval = std::move(stack.back());
             stack.pop_back();
-            Element e_lval = stack.back();
+            Element e_lval = std::move(stack.back());
             stack.pop_back();
 
             EDataTypes e_lval_datatype = e_lval.getDatatype();
@@ -1447,10 +1681,48 @@ bool VM::interpret(Bytecode& bytecode, unsigned int& idx, EExecStatus& status)
             } else if (e_lval_final_datatype == EDataTypes::FLOAT && e_rval_final_datatype == EDataTypes::INT) {
                 stack.push_back(Element(*(long double*)p_l_val + *(long long int*)p_r_val));
             } else if (e_lval_final_datatype == EDataTypes::STRING && e_rval_final_datatype == EDataTypes::STRING) {
-                stack.push_back(Element(*(std::string*)p_l_val + *(std::string*)p_r_val));
+                if (e_lval_datatype != EDataTypes::ADDRESS) {
+                    // The left operand is a temporary (e.g. 'a + b + c'). Append to it in place.
+                    if (!appendString(*(std::string*)e_lval.getVariablePhysicalAddress(), *(const std::string*)p_r_val, false)) {
+                        status = EExecStatus::EXEC_ERROR_MEMORY_QUOTA_EXCEEDED;
+                        return false;
+                    }
+                    stack.push_back(std::move(e_lval));
+                } else if (idx < code.size() && code[idx] == EInstrCodes::MOVE
+                    && !stack.empty()
+                    && stack.back().getDatatype() == EDataTypes::ADDRESS
+                    && stack.back().getVariablePhysicalAddress() == p_l_val)
+                {
+                    // 's = s + t': append directly to the target variable and skip the following MOVE
+                    if (!appendString(*(std::string*)p_l_val, *(const std::string*)p_r_val, true)) {
+                        status = EExecStatus::EXEC_ERROR_MEMORY_QUOTA_EXCEEDED;
+                        return false;
+                    }
+                    stack.pop_back();
+                    idx++;
+                } else {
+                    const std::string& l_str = *(const std::string*)p_l_val;
+                    const std::string& r_str = *(const std::string*)p_r_val;
+                    std::string result;
+
+                    if (!MemoryAccount::canAllocate(l_str.size() + r_str.size() + 1)) {
+                        status = EExecStatus::EXEC_ERROR_MEMORY_QUOTA_EXCEEDED;
+                        return false;
+                    }
+
+                    result.reserve(l_str.size() + r_str.size());
+                    result.append(l_str);
+                    result.append(r_str);
+                    stack.push_back(Element(std::move(result)));
+                }
             } else if (e_lval_final_datatype == EDataTypes::BOOLEAN && e_rval_final_datatype == EDataTypes::BOOLEAN) {
                 stack.push_back(Element(*(bool*)p_l_val || *(bool*)p_r_val));
             } else if (e_lval_final_datatype == EDataTypes::ARRAY && e_rval_final_datatype == EDataTypes::ARRAY) {
+                // The result is a copy of the left array with the right one merged into it
+                if (!MemoryAccount::canAllocate(((const Array*)p_l_val)->memorySize() + ((const Array*)p_r_val)->memorySize())) {
+                    status = EExecStatus::EXEC_ERROR_MEMORY_QUOTA_EXCEEDED;
+                    return false;
+                }
                 stack.push_back(Element(*(Array*)p_l_val + *(Array*)p_r_val));
 //                status = EExecStatus::EXEC_ERROR_ADD_ARRAY_NOT_SUPPORTED;
 //                return false; // Inconsistent datatypes
@@ -1462,9 +1734,9 @@ bool VM::interpret(Bytecode& bytecode, unsigned int& idx, EExecStatus& status)
             break;
         }
         case EInstrCodes::SUB: {
-            Element e_rval = stack.back();
+            Element e_rval = std::move(stack.back());
             stack.pop_back();
-            Element e_lval = stack.back();
+            Element e_lval = std::move(stack.back());
             stack.pop_back();
 
             EDataTypes e_lval_datatype = e_lval.getDatatype();
@@ -1506,7 +1778,7 @@ bool VM::interpret(Bytecode& bytecode, unsigned int& idx, EExecStatus& status)
             break;
         }
         case EInstrCodes::NEG: {
-            Element e_lval = stack.back();
+            Element e_lval = std::move(stack.back());
             stack.pop_back();
 
             EDataTypes e_lval_datatype = e_lval.getDatatype();
@@ -1551,6 +1823,10 @@ bool VM::interpret(Bytecode& bytecode, unsigned int& idx, EExecStatus& status)
             callstack.push_back(new CallStackEntry(idx));
             idx = variable.getFunRef();
 
+            if (callstack.size() > peak_call_depth) {
+                peak_call_depth = callstack.size();
+            }
+
             break;
         }
         case EInstrCodes::SYSCALL: { // The system sunction name: String literal (the array of ushort (2 bytes) wide character string (utf-16) + ending 0)
@@ -1629,6 +1905,23 @@ bool VM::interpret(Bytecode& bytecode, unsigned int& idx, EExecStatus& status)
                 }
 
                 stack.push_back(Element(ret_val));
+            } else if (sys_fun_name == "print") {
+                bool written = true;
+
+                if (variable_datatype != EDataTypes::STRING) {
+                    status = EExecStatus::EXEC_ERROR_SYSCALL_PRINT_INCONSISTENT_DATATYPES;
+                    return false; // print takes a STRING
+                }
+
+                const std::string& text = *(std::string*)par_variable;
+
+                if (output) {
+                    written = output->writeLine(text);
+                } else {
+                    printf("%s\n", text.c_str());
+                }
+
+                stack.push_back(Element(written));
             } else {
                 status = EExecStatus::EXEC_ERROR_SYSCALL_UNKNOWN_FUNCTION;
                 return false;   // Unknown system function
@@ -1748,7 +2041,7 @@ bool VM::interpret(Bytecode& bytecode, unsigned int& idx, EExecStatus& status)
             variable.setCallStackPos(var_pos_on_callstack); // register the dynamic variable position in the DATA section reference variable
 
             // take the value from the stack and put to the variable
-            Element e_val = stack.back();
+            Element e_val = std::move(stack.back());
             stack.pop_back();
 
             EDataTypes e_val_datatype = e_val.getDatatype();
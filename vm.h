@@ -2,7 +2,12 @@
 #define VM_H
 
 #include <stack>
+#include <unordered_map>
+#include <atomic>
+#include <functional>
 #include "bytecode.h"
+#include "memoryaccount.h"
+#include "outputbuffer.h"
 
 enum class EDataTypes {
     UNKNOWN = 0, INT, FLOAT, STRING, BOOLEAN, ADDRESS, ARRAY
@@ -23,17 +28,19 @@ private:
         struct SAddr {
             EDataTypes datatype;
             void* addr;
+            bool interned;  // addr points to a string from the StringTable (read-only)
 
-            SAddr(EDataTypes datatype, void* addr) : datatype(datatype), addr(addr) {}
+            SAddr(EDataTypes datatype, void* addr, bool interned) : datatype(datatype), addr(addr), interned(interned) {}
         } addrVal;
 
         UValues() {}
         UValues(long long int v) : intVal(v) {}
         UValues(long double v) : floatVal(v) {}
         UValues(const std::string& v) : stringVal(v) {}
+        UValues(std::string&& v) : stringVal(std::move(v)) {}
         UValues(bool v) : booleanVal(v) {}
         UValues(const Array& v) : arrayVal(v) {}
-        UValues(EDataTypes datatype, void* v) : addrVal(datatype, v) {}
+        UValues(EDataTypes datatype, void* v, bool interned) : addrVal(datatype, v, interned) {}
         ~UValues() {}
     } value;
 
@@ -42,12 +49,16 @@ public:
     Element(long long int val);
     Element(long double val);
     Element(const std::string& val);
+    Element(std::string&& val);
     Element(bool val);
     Element(const Array& v);
     Element(EDataTypes datatype, void* val);
+    Element(const std::string* interned_val);
     Element(const Element& other);
+    Element(Element&& other) noexcept;
 
     Element& operator=(const Element& other);
+    Element& operator=(Element&& other) noexcept;
 
     ~Element();
 
@@ -60,6 +71,7 @@ public:
     const union UValues& getValue();
     void* getVariablePhysicalAddress();
     bool isDatatypeMatch(unsigned char d);
+    bool isInterned() const;
 };
 
 enum class EExecStatus {
@@ -105,6 +117,7 @@ enum class EExecStatus {
     EXEC_ERROR_SYSCALL_COS_STRING_NOT_SUPPORTED,
     EXEC_ERROR_SYSCALL_COS_BOOLEAN_NOT_SUPPORTED,
     EXEC_ERROR_SYSCALL_COS_INCONSISTENT_DATATYPES,
+    EXEC_ERROR_SYSCALL_PRINT_INCONSISTENT_DATATYPES,
     EXEC_ERROR_SYSCALL_UNKNOWN_FUNCTION,
     EXEC_ERROR_RETURN_NO_RETURN_POINT,
     EXEC_ERROR_PUTINDADDR_EXPECTED_ADDRESS,
@@ -123,7 +136,10 @@ enum class EExecStatus {
     EXEC_ERROR_MOVEMUL_ARRAY_NOT_SUPPORTED,
     EXEC_ERROR_ADD_ARRAY_NOT_SUPPORTED,
     EXEC_ERROR_SUB_ARRAY_NOT_SUPPORTED,
-    EXEC_ERROR_NEG_ARRAY_NOT_SUPPORTED
+    EXEC_ERROR_NEG_ARRAY_NOT_SUPPORTED,
+    EXEC_ERROR_MEMORY_QUOTA_EXCEEDED,  // The program owns more memory than VM::setMemoryQuota allows
+    EXEC_CANCELLED,
+    EXEC_YIELDED        // The budget of 'VM::resume' has been used up. The program continues with the next 'resume'.
 };
 
 extern const char* exec_status_descriptions[];
@@ -135,6 +151,18 @@ struct CallStackValuePointer
 
     CallStackValuePointer() : datatype(EDataTypes::UNKNOWN), value(NULL) {}
     CallStackValuePointer(EDataTypes datatype, void* value) : datatype(datatype), value(value) {}
+
+    // The size of the value object, as charged by Datatype::makeDynamicAddress
+    size_t size() const {
+        switch (datatype) {
+            case EDataTypes::INT: return sizeof(long long int);
+            case EDataTypes::FLOAT: return sizeof(long double);
+            case EDataTypes::BOOLEAN: return sizeof(unsigned char);
+            case EDataTypes::STRING: return sizeof(std::string);
+            case EDataTypes::ARRAY: return sizeof(Array);
+            default: return 0;
+        }
+    }
     ~CallStackValuePointer() {
         if (value != NULL) {
             switch (datatype) {
@@ -148,12 +176,14 @@ struct CallStackValuePointer
                     delete static_cast<bool*>(value);
                     break;
                 case EDataTypes::STRING:
+                    MemoryAccount::credit(MemoryAccount::stringSize(*static_cast<std::string*>(value)));
                     delete static_cast<std::string*>(value);
                     break;
                 case EDataTypes::ARRAY:
                     delete static_cast<Array*>(value);
                     break;
             } // ~switch
+            MemoryAccount::credit(size());
         } // ~if
     }
 };
@@ -193,11 +223,42 @@ class CallStackEntry
         }
 };
 
+// A string literal interned on its first execution
+struct StringLiteral
+{
+    const std::string* value;   // The interned value
+    unsigned int code_size;     // The size of the literal in the code (including the ending 0)
+
+    StringLiteral(const std::string* value, unsigned int code_size) : value(value), code_size(code_size) {}
+};
+
 class VM
 {
+public:
+    // Called on the executing thread every CHECK_INTERVAL instructions
+    typedef std::function<void(unsigned long long executed_instructions)> ProgressHandler;
+
 private:
+    static const unsigned int CHECK_INTERVAL = 4096;   // Instructions between checks of 'cancel', the time budget and progress reports
+
+    MemoryAccount memory;   // Declared first, the values below are credited to it when they're destroyed
     std::vector<Element> stack;
     std::vector<CallStackEntry*> callstack;
+    std::unordered_map<unsigned int, StringLiteral> string_literals; // <PUTSTRING attribute position in the code, literal>
+    std::atomic<bool> cancel_requested{ false };
+    ProgressHandler progress_handler;
+    OutputBuffer* output{ NULL };   // NULL - the program output goes to stdout
+
+    // The state of a started program between 'resume' calls. The values are in the stack, callstack and the bytecode.
+    bool started{ false };
+    unsigned int idx{ 0 };                          // The next instruction
+    unsigned long long executed_instructions{ 0 };
+    unsigned int peak_call_depth{ 0 };
+
+    void finish(Bytecode& bytecode, EExecStatus status);
+
+    void releaseCallStack();
+    void releaseStringLiterals();
 
 public:
     VM();
@@ -209,6 +270,28 @@ public:
     void init();
     bool moveValue(void* lvar, EDataTypes ldatatype, Element& rval, EDataTypes rdatatype, EDataTypes rfinal_datatype, EExecStatus& status);
     void execute(Bytecode& bytecode, EExecStatus& status);
+
+    // Resumable execution: 'start' prepares the program, each 'resume' runs it until it ends or until it uses up
+    // 'max_instructions' or 'max_us' microseconds (0 - no limit). Then the status is EXEC_YIELDED and the next
+    // 'resume' continues where it stopped. The bytecode must stay the same between the calls.
+    void start(Bytecode& bytecode);
+    void resume(Bytecode& bytecode, EExecStatus& status, unsigned long long max_instructions, unsigned long long max_us);
+    bool isStarted() const { return started; }
+    unsigned long long getExecutedInstructions() const { return executed_instructions; }
+    unsigned int getPeakCallDepth() const { return peak_call_depth; }
+
+    // May be called from any thread. The execution stops with EXEC_CANCELLED, also when it's been yielded. 'init' clears the request.
+    void cancel() { cancel_requested = true; }
+    void setProgressHandler(const ProgressHandler& handler) { progress_handler = handler; }
+    // Where 'print' writes the program output. The buffer must outlive the execution.
+    void setOutput(OutputBuffer* output_buffer) { output = output_buffer; }
+
+    // The memory owned by the program: variables, arrays and strings, without the stack temporaries.
+    // The quota (bytes, 0 - no limit) stops the program with EXEC_ERROR_MEMORY_QUOTA_EXCEEDED.
+    // The usage may be read from any thread while the program runs.
+    void setMemoryQuota(size_t quota) { memory.setQuota(quota); }
+    size_t getMemoryUsed() const { return memory.getUsed(); }
+    size_t getMemoryPeak() const { return memory.getPeak(); }
     bool interpret(Bytecode& bytecode, unsigned int& idx, EExecStatus& status);
 };
 